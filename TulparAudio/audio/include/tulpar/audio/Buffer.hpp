@@ -11,6 +11,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
 
@@ -32,6 +33,17 @@ public:
     //! Shortcut to buffer handle type
     using Handle = uint32_t;
 
+    //! Channel handling of bound data
+    enum class Downmix : uint8_t
+    {
+        //! Follows TulparConfigurator::isStereoDownmixed
+        Default
+        //! Keeps channels as decoded
+        , Keep
+        //! Averages stereo channels into mono so that buffer can be spatialized
+        , Mono
+    };
+
     /** @brief  Creates empty buffer object
      *
      *  Created empty object is invalid
@@ -66,13 +78,64 @@ public:
 
     /** @brief  Initializes buffer with given data
      *
-     *  Apart from initializing buffer with audio data, parses and sets metadata
+     *  Apart from initializing buffer with audio data, parses and sets metadata.
+     *  Ogg Vorbis and RIFF/WAVE content is supported, the latter is uploaded
+     *  without decoding.
+     *
+     *  OpenAL spatializes mono buffers only, so stereo data meant for
+     *  positional playback shall be down-mixed with @p downmix
      *
      *  @param  asset   asset handle to audio content
+     *  @param  downmix channel handling of decoded data
+     *
+     *  @return @c true if data was set successfully, @c false otherwise
+     */
+    bool BindData(mule::asset::Handler asset, Downmix downmix = Downmix::Default);
+
+    /** @brief  Initializes buffer with given data asynchronously
+     *
+     *  Data is decoded by worker threads and uploaded during
+     *  TulparAudio::Update()
+     *
+     *  @attention  waiting on returned future from the thread calling
+     *              TulparAudio::Update() blocks forever
+     *
+     *  @param  asset   asset handle to audio content
+     *  @param  downmix channel handling of decoded data
+     *
+     *  @return future holding @c true if data was set successfully
+     *
+     *  @sa BindData
+     */
+    std::future<bool> BindDataAsync(mule::asset::Handler asset, Downmix downmix = Downmix::Default);
+
+    /** @brief  Initializes buffer with content of given file
+     *
+     *  File is memory mapped and decoded in place without copying
+     *  compressed data to the heap
+     *
+     *  @param  path    path to Ogg Vorbis or RIFF/WAVE file
+     *  @param  downmix channel handling of decoded data
      *
      *  @return @c true if data was set successfully, @c false otherwise
+     *
+     *  @sa BindData
      */
-    bool BindData(mule::asset::Handler asset);
+    bool BindFile(std::string const& path, Downmix downmix = Downmix::Default);
+
+    /** @brief  Initializes buffer with content of given file asynchronously
+     *
+     *  @attention  waiting on returned future from the thread calling
+     *              TulparAudio::Update() blocks forever
+     *
+     *  @param  path    path to Ogg Vorbis or RIFF/WAVE file
+     *  @param  downmix channel handling of decoded data
+     *
+     *  @return future holding @c true if data was set successfully
+     *
+     *  @sa BindFile
+     */
+    std::future<bool> BindFileAsync(std::string const& path, Downmix downmix = Downmix::Default);
 
     //! Returns name associated
     std::string GetDataName() const;
@@ -92,6 +155,13 @@ public:
     //! Returns duration
     std::chrono::nanoseconds GetDuration() const;
 
+    /** @brief  Returns size of data stored in OpenAL in bytes
+     *
+     *  @return data size, @c 0 if data was evicted to meet
+     *          TulparConfigurator::bufferBudget
+     */
+    uint64_t GetResidentSize() const;
+
     //! Resets given buffer
     void Reset();
 
@@ -38,6 +38,18 @@ public:
         std::array<float, 3> up;
     };
 
+    //! Distance attenuation models applied to all sources
+    enum class DistanceModel : uint8_t
+    {
+        None
+        , Inverse
+        , InverseClamped
+        , Linear
+        , LinearClamped
+        , Exponent
+        , ExponentClamped
+    };
+
     /** @brief  Creates empty listener object
      *
      *  Created empty object is invalid
@@ -85,6 +97,12 @@ public:
     //! Sets orientation
     bool SetOrientation(Orientation orientation);
 
+    //! Returns distance model
+    DistanceModel GetDistanceModel() const;
+
+    //! Sets distance model, DistanceModel::InverseClamped by default
+    bool SetDistanceModel(DistanceModel model);
+
 private:
     friend class internal::ListenerController;
 
@@ -0,0 +1,69 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_AUDIO_REFERENCE_HPP
+#define TULPAR_AUDIO_REFERENCE_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+namespace tulpar
+{
+namespace audio
+{
+
+class Buffer;
+class Source;
+
+/** @brief  Lightweight reference to an object stored in a collection
+ *
+ *  Unlike controller objects, reference does not own any memory and
+ *  is validated by the owning collection. It stays valid after
+ *  TulparAudio::Reinitialize() as collections keep stable reference
+ *  indices while migrating objects.
+ *
+ *  Default constructed reference is invalid.
+ *
+ *  @tparam T   referenced object type
+ */
+template<typename T>
+    struct Reference
+{
+    //! Index in the reference table of the owning collection
+    uint32_t index = 0;
+
+    //! Generation of the reference table entry, @c 0 is never valid
+    uint32_t generation = 0;
+
+    //! Returns @c true if both references point to the same object
+    bool operator==(Reference const& other) const
+    {
+        return (index == other.index) && (generation == other.generation);
+    }
+
+    //! Returns @c true if references point to different objects
+    bool operator!=(Reference const& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+//! Lightweight buffer reference
+using BufferRef = Reference<Buffer>;
+
+//! Lightweight source reference
+using SourceRef = Reference<Source>;
+
+static_assert(std::is_trivially_copyable<BufferRef>::value && (8 == sizeof(BufferRef))
+    , "BufferRef shall be a trivially copyable 8-byte value");
+
+static_assert(std::is_trivially_copyable<SourceRef>::value && (8 == sizeof(SourceRef))
+    , "SourceRef shall be a trivially copyable 8-byte value");
+
+}
+}
+
+#endif // TULPAR_AUDIO_REFERENCE_HPP
@@ -12,6 +12,7 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
 
@@ -54,6 +55,28 @@ public:
         , Streaming     /**< Source has a queue of buffers */
     };
 
+    //! Sample format of data produced by StreamCallback
+    enum class SampleFormat : uint8_t
+    {
+        Int16           /**< Signed 16-bit samples */
+        , Float32       /**< Float samples in [-1, 1] range, requires AL_EXT_FLOAT32 */
+    };
+
+    /** @brief  Callback producing data of a procedural source
+     *
+     *  @attention  with AL_SOFT_callback_buffer the callback is called from
+     *              OpenAL mixing thread, otherwise from the thread running
+     *              TulparAudio::Update(). It shall not block or call
+     *              TulparAudio methods.
+     *
+     *  @param  pSamples    storage for interleaved samples
+     *  @param  frameCount  number of frames requested
+     *
+     *  @return number of frames written, fewer than @p frameCount marks the
+     *          end of data and the source stops once it is played
+     */
+    using StreamCallback = std::function<uint32_t(void* pSamples, uint32_t frameCount)>;
+
     /** @brief  Creates empty source object
      *
      *  Created empty object is invalid
@@ -121,6 +144,42 @@ public:
      */
     bool QueueBuffers(std::vector<Buffer> const& buffers);
 
+    /** @brief  Binds Ogg Vorbis stream to the source
+     *
+     *  Audio content is decoded incrementally into a small ring of buffers
+     *  instead of being decoded at once, see TulparAudio::Update()
+     *
+     *  @param  asset   asset handle to audio content
+     *
+     *  @return @c true if stream was bound successfully, @c false otherwise
+     */
+    bool BindStream(mule::asset::Handler asset);
+
+    //! Returns @c true if source is fed by a stream
+    bool IsStreamed() const;
+
+    /** @brief  Binds procedural data callback to the source
+     *
+     *  Data is pulled from @p callback while the source is playing instead
+     *  of being provided by buffers. Playing a stopped source pulls data
+     *  again. Looping has no effect on procedural sources.
+     *
+     *  @param  callback    data callback
+     *  @param  channels    number of interleaved channels
+     *  @param  frequencyHz sample rate
+     *  @param  format      sample format written by @p callback
+     *
+     *  @return @c true if callback was bound successfully, @c false otherwise
+     */
+    bool BindCallback(StreamCallback callback
+        , uint8_t channels
+        , uint32_t frequencyHz
+        , SampleFormat format = SampleFormat::Int16
+    );
+
+    //! Returns @c true if source is fed by a callback
+    bool IsProcedural() const;
+
     /** @brief  Resets source object
      *
      *  Stops any activities with the source, resets associated buffers and
@@ -189,6 +248,12 @@ public:
     //! Returns source state
     State GetState() const;
 
+    /** @brief  Returns source state known without querying OpenAL
+     *
+     *  Playback completion is detected by TulparAudio::Update()
+     */
+    State GetCachedState() const;
+
     //! Returns source type
     Type GetType() const;
 
@@ -252,6 +317,33 @@ public:
     //! Sets position
     bool SetPosition(std::array<float, 3> vec);
 
+    //! Returns velocity
+    std::array<float, 3> GetVelocity() const;
+
+    /** @brief  Sets velocity
+     *
+     *  Velocity does not move the source, it is used for doppler effect
+     */
+    bool SetVelocity(std::array<float, 3> vec);
+
+    //! Returns distance at which attenuation starts
+    float GetReferenceDistance() const;
+
+    //! Sets distance at which attenuation starts
+    bool SetReferenceDistance(float value);
+
+    //! Returns distance beyond which attenuation stops, or is clamped by clamped distance models
+    float GetMaxDistance() const;
+
+    //! Sets distance beyond which attenuation stops, or is clamped by clamped distance models
+    bool SetMaxDistance(float value);
+
+    //! Returns rolloff factor scaling distance attenuation
+    float GetRolloffFactor() const;
+
+    //! Sets rolloff factor scaling distance attenuation
+    bool SetRolloffFactor(float value);
+
 private:
     friend class internal::SourceCollection;
 
@@ -0,0 +1,46 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_AUDIO_SOURCE_EVENT_HPP
+#define TULPAR_AUDIO_SOURCE_EVENT_HPP
+
+#include <tulpar/audio/Reference.hpp>
+
+#include <cstdint>
+
+namespace tulpar
+{
+namespace audio
+{
+
+/** @brief  Notification about source playback
+ *
+ *  Events are collected during TulparAudio::Update() and consumed with
+ *  TulparAudio::PollSourceEvents()
+ */
+struct SourceEvent
+{
+    //! Event type enumeration
+    enum class Type : uint8_t
+    {
+        Stopped             /**< Playback reached the end of source data */
+        , BufferCompleted   /**< Queued buffers were played, requires AL_SOFT_events */
+    };
+
+    //! Event type
+    Type type = Type::Stopped;
+
+    //! Source the event refers to
+    SourceRef source = SourceRef();
+
+    //! Number of completed buffers for @c BufferCompleted events
+    uint32_t count = 0;
+};
+
+}
+}
+
+#endif // TULPAR_AUDIO_SOURCE_EVENT_HPP
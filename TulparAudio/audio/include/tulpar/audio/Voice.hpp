@@ -0,0 +1,196 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_AUDIO_VOICE_HPP
+#define TULPAR_AUDIO_VOICE_HPP
+
+#include <tulpar/audio/Buffer.hpp>
+#include <tulpar/audio/Source.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace tulpar
+{
+
+namespace internal
+{
+class VoiceCollection;
+}
+
+namespace audio
+{
+
+/** @brief  Proxy class for controlling virtual voice
+ *
+ *  Voice is a logical audio source that is not limited by the number of
+ *  sources OpenAL is able to mix. Only the most important playing voices
+ *  are bound to real sources, the rest are virtual and keep advancing their
+ *  playback clock, so they resume at correct offset once promoted.
+ *
+ *  @sa TulparAudio::Update
+ */
+class Voice
+{
+public:
+    //! Shortcut to voice handle type
+    using Handle = uint32_t;
+
+    /** @brief  Creates empty voice object
+     *
+     *  Created empty object is invalid
+     */
+    Voice();
+
+    //! Default copy constructor
+    Voice(Voice const& other) = default;
+
+    //! Default assignment operator
+    Voice& operator=(Voice const& other) = default;
+
+    //! Default move constructor
+    Voice(Voice&& other) = default;
+
+    //! Default assignment-move operator
+    Voice& operator=(Voice&& other) = default;
+
+    //! Default destructor
+    ~Voice() = default;
+
+    //! Returns shared pointer to underlying handle
+    std::shared_ptr<Handle> GetSharedHandle() const { return m_handle; }
+
+    /** @brief  Checks if object is valid and can be used
+     *
+     *  Validness is checked via Collection::IsValid() call on #m_pParent with #m_handle
+     *
+     *  @return @c true if object is valid, @c false otherwise
+     */
+    bool IsValid() const;
+
+    //! Returns associated buffer object
+    Buffer GetBuffer() const;
+
+    /** @brief  Sets buffer object
+     *
+     *  @note   Voice has to be in audio::Source::State::Initial or
+     *          audio::Source::State::Stopped state
+     *
+     *  @param  buffer  buffer object
+     *
+     *  @return @c true if buffer was set, @c false otherwise
+     */
+    bool SetBuffer(Buffer buffer);
+
+    /** @brief  Resets voice object
+     *
+     *  Stops the voice, releases real source if any and removes all stored
+     *  information
+     */
+    void Reset();
+
+    /** @brief  Starts playing associated buffer
+     *
+     *  Voice is bound to a real source right away if one is available,
+     *  otherwise it stays virtual until promoted by TulparAudio::Update()
+     *
+     *  @return @c true if voice is now playing, @c false otherwise
+     */
+    bool Play();
+
+    //! Stops playback
+    bool Stop();
+
+    //! Stops playback and rewinds voice back to start
+    bool Rewind();
+
+    //! Pauses playback releasing real source if any
+    bool Pause();
+
+    //! Returns voice state
+    Source::State GetState() const;
+
+    //! Returns playback duration
+    std::chrono::nanoseconds GetPlaybackDuration() const;
+
+    //! Returns current playback position
+    std::chrono::nanoseconds GetPlaybackPosition() const;
+
+    //! Sets playback position
+    bool SetPlaybackPosition(std::chrono::nanoseconds offset);
+
+    //! Returns voice priority
+    int32_t GetPriority() const;
+
+    /** @brief  Sets voice priority
+     *
+     *  Voices with higher priority are bound to real sources first,
+     *  voices with equal priority are ordered by audibility
+     *
+     *  @param  value   priority value
+     */
+    void SetPriority(int32_t value);
+
+    //! Returns audibility estimate based on gain and distance to listener
+    float GetAudibility() const;
+
+    //! Returns @c true if voice is not bound to a real source
+    bool IsVirtual() const;
+
+    //! Returns relativeness flag
+    bool IsRelative() const;
+
+    //! Sets relativeness flag
+    bool SetRelative(bool flag);
+
+    //! Returns looping flag
+    bool IsLooping() const;
+
+    //! Sets looping flag
+    bool SetLooping(bool flag);
+
+    //! Returns pitch value
+    float GetPitch() const;
+
+    //! Sets pitch value
+    bool SetPitch(float value);
+
+    //! Returns gain value
+    float GetGain() const;
+
+    //! Sets gain value
+    bool SetGain(float value);
+
+    //! Returns position
+    std::array<float, 3> GetPosition() const;
+
+    //! Sets position
+    bool SetPosition(std::array<float, 3> vec);
+
+private:
+    friend class internal::VoiceCollection;
+
+    /** @brief  Creates voice object
+     *
+     *  @param  handle  handle indicating underlying voice
+     *  @param  parent  parent collection
+     */
+    Voice(std::shared_ptr<Handle> handle
+        , std::shared_ptr<internal::VoiceCollection*> parent);
+
+    //! Parent collection
+    std::shared_ptr<internal::VoiceCollection*> m_pParent;
+
+    //! Underlying handle identifying voice
+    std::shared_ptr<Handle> m_handle;
+};
+
+}
+}
+
+#endif // TULPAR_AUDIO_VOICE_HPP
@@ -27,11 +27,32 @@ bool Buffer::IsValid() const
         && (*m_pParent)->IsValid(*m_handle);
 }
 
-bool Buffer::BindData(mule::asset::Handler asset)
+bool Buffer::BindData(mule::asset::Handler asset, Downmix downmix)
 {
     assert(IsValid());
 
-    return (*m_pParent)->SetBufferData(*m_handle, asset);
+    return (*m_pParent)->SetBufferData(*m_handle, asset, downmix);
+}
+
+std::future<bool> Buffer::BindDataAsync(mule::asset::Handler asset, Downmix downmix)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetBufferDataAsync(*m_handle, asset, downmix);
+}
+
+bool Buffer::BindFile(std::string const& path, Downmix downmix)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetBufferFile(*m_handle, path, downmix);
+}
+
+std::future<bool> Buffer::BindFileAsync(std::string const& path, Downmix downmix)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetBufferFileAsync(*m_handle, path, downmix);
 }
 
 std::string Buffer::GetDataName() const
@@ -76,6 +97,13 @@ std::chrono::nanoseconds Buffer::GetDuration() const
     return (*m_pParent)->GetBufferDuration(*m_handle);
 }
 
+uint64_t Buffer::GetResidentSize() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetBufferResidentSize(*m_handle);
+}
+
 void Buffer::Reset()
 {
     assert(IsValid());
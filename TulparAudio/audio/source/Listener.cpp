@@ -68,6 +68,20 @@ bool Listener::SetOrientation(Listener::Orientation orientation)
     return m_parent.lock()->SetListenerOrientation(orientation);
 }
 
+Listener::DistanceModel Listener::GetDistanceModel() const
+{
+    assert(IsValid());
+
+    return m_parent.lock()->GetListenerDistanceModel();
+}
+
+bool Listener::SetDistanceModel(Listener::DistanceModel model)
+{
+    assert(IsValid());
+
+    return m_parent.lock()->SetListenerDistanceModel(model);
+}
+
 Listener::Listener(std::weak_ptr<internal::ListenerController> parent)
     : m_parent(parent)
 {
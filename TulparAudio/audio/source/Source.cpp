@@ -8,6 +8,8 @@
 
 #include <tulpar/internal/SourceCollection.hpp>
 
+#include <utility>
+
 namespace tulpar
 {
 namespace audio
@@ -84,6 +86,46 @@ bool Source::QueueBuffers(std::vector<Buffer> const& buffers)
     return (*m_pParent)->QueueSourceBuffers(*m_handle, buffers);
 }
 
+bool Source::BindStream(mule::asset::Handler asset)
+{
+    assert(IsValid());
+    assert(
+        (State::Initial == GetState()) ||
+        (State::Stopped == GetState())
+    );
+
+    return (*m_pParent)->SetSourceStream(*m_handle, asset);
+}
+
+bool Source::IsStreamed() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->IsSourceStreamed(*m_handle);
+}
+
+bool Source::BindCallback(StreamCallback callback
+    , uint8_t channels
+    , uint32_t frequencyHz
+    , SampleFormat format
+)
+{
+    assert(IsValid());
+    assert(
+        (State::Initial == GetState()) ||
+        (State::Stopped == GetState())
+    );
+
+    return (*m_pParent)->SetSourceCallback(*m_handle, std::move(callback), channels, frequencyHz, format);
+}
+
+bool Source::IsProcedural() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->IsSourceProcedural(*m_handle);
+}
+
 void Source::Reset()
 {
     assert(IsValid());
@@ -161,6 +203,13 @@ Source::State Source::GetState() const
     return (*m_pParent)->GetSourceState(*m_handle);
 }
 
+Source::State Source::GetCachedState() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetSourceCachedState(*m_handle);
+}
+
 Source::Type Source::GetType() const
 {
     assert(IsValid());
@@ -238,6 +287,62 @@ bool Source::SetPosition(std::array<float, 3> vec)
     return (*m_pParent)->SetSourcePosition(*m_handle, vec);
 }
 
+std::array<float, 3> Source::GetVelocity() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetSourceVelocity(*m_handle);
+}
+
+bool Source::SetVelocity(std::array<float, 3> vec)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetSourceVelocity(*m_handle, vec);
+}
+
+float Source::GetReferenceDistance() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetSourceReferenceDistance(*m_handle);
+}
+
+bool Source::SetReferenceDistance(float value)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetSourceReferenceDistance(*m_handle, value);
+}
+
+float Source::GetMaxDistance() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetSourceMaxDistance(*m_handle);
+}
+
+bool Source::SetMaxDistance(float value)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetSourceMaxDistance(*m_handle, value);
+}
+
+float Source::GetRolloffFactor() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetSourceRolloffFactor(*m_handle);
+}
+
+bool Source::SetRolloffFactor(float value)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetSourceRolloffFactor(*m_handle, value);
+}
+
 Source::Source(std::shared_ptr<Handle> handle
     , std::shared_ptr<internal::SourceCollection*> pParent
 )
@@ -0,0 +1,217 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/audio/Voice.hpp>
+
+#include <tulpar/internal/VoiceCollection.hpp>
+
+#include <cassert>
+
+namespace tulpar
+{
+namespace audio
+{
+
+Voice::Voice()
+    : m_pParent(nullptr)
+    , m_handle(std::make_shared<Handle>(0))
+{
+
+}
+
+bool Voice::IsValid() const
+{
+    return (nullptr != m_handle.get())
+        && (nullptr != m_pParent.get())
+        && (*m_pParent)->IsValid(*m_handle);
+}
+
+Buffer Voice::GetBuffer() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoiceBuffer(*m_handle);
+}
+
+bool Voice::SetBuffer(Buffer buffer)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetVoiceBuffer(*m_handle, buffer);
+}
+
+void Voice::Reset()
+{
+    assert(IsValid());
+
+    (*m_pParent)->ResetVoice(*m_handle);
+}
+
+bool Voice::Play()
+{
+    assert(IsValid());
+
+    return (*m_pParent)->PlayVoice(*m_handle);
+}
+
+bool Voice::Stop()
+{
+    assert(IsValid());
+
+    return (*m_pParent)->StopVoice(*m_handle);
+}
+
+bool Voice::Rewind()
+{
+    assert(IsValid());
+
+    return (*m_pParent)->RewindVoice(*m_handle);
+}
+
+bool Voice::Pause()
+{
+    assert(IsValid());
+
+    return (*m_pParent)->PauseVoice(*m_handle);
+}
+
+Source::State Voice::GetState() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoiceState(*m_handle);
+}
+
+std::chrono::nanoseconds Voice::GetPlaybackDuration() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoicePlaybackDuration(*m_handle);
+}
+
+std::chrono::nanoseconds Voice::GetPlaybackPosition() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoicePlaybackPosition(*m_handle);
+}
+
+bool Voice::SetPlaybackPosition(std::chrono::nanoseconds offset)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetVoicePlaybackPosition(*m_handle, offset);
+}
+
+int32_t Voice::GetPriority() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoicePriority(*m_handle);
+}
+
+void Voice::SetPriority(int32_t value)
+{
+    assert(IsValid());
+
+    (*m_pParent)->SetVoicePriority(*m_handle, value);
+}
+
+float Voice::GetAudibility() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoiceAudibility(*m_handle);
+}
+
+bool Voice::IsVirtual() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->IsVoiceVirtual(*m_handle);
+}
+
+bool Voice::IsRelative() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->IsVoiceRelative(*m_handle);
+}
+
+bool Voice::SetRelative(bool flag)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetVoiceRelative(*m_handle, flag);
+}
+
+bool Voice::IsLooping() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->IsVoiceLooping(*m_handle);
+}
+
+bool Voice::SetLooping(bool flag)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetVoiceLooping(*m_handle, flag);
+}
+
+float Voice::GetPitch() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoicePitch(*m_handle);
+}
+
+bool Voice::SetPitch(float value)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetVoicePitch(*m_handle, value);
+}
+
+float Voice::GetGain() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoiceGain(*m_handle);
+}
+
+bool Voice::SetGain(float value)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetVoiceGain(*m_handle, value);
+}
+
+std::array<float, 3> Voice::GetPosition() const
+{
+    assert(IsValid());
+
+    return (*m_pParent)->GetVoicePosition(*m_handle);
+}
+
+bool Voice::SetPosition(std::array<float, 3> vec)
+{
+    assert(IsValid());
+
+    return (*m_pParent)->SetVoicePosition(*m_handle, vec);
+}
+
+Voice::Voice(std::shared_ptr<Handle> handle
+    , std::shared_ptr<internal::VoiceCollection*> parent
+)
+    : m_pParent(parent)
+    , m_handle(handle)
+{
+
+}
+
+}
+}
@@ -0,0 +1,113 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_KERNELS_HPP
+#define TULPAR_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tulpar
+{
+
+/** @brief  Sample conversion kernels
+ *
+ *  Each kernel has a scalar implementation and SIMD ones that are picked at
+ *  runtime based on the best instruction set supported by the CPU. Kernels
+ *  are used by the library when preparing buffer data and can be used by
+ *  custom loaders.
+ *
+ *  Float samples are normalized to [-1, 1] range, 16-bit samples are mapped
+ *  to it by 32767 so that conversion round trip is exact. Input and output
+ *  ranges shall not overlap unless stated otherwise.
+ */
+namespace kernels
+{
+
+//! Instruction sets kernels can be dispatched to
+enum class InstructionSet : uint8_t
+{
+    Scalar
+    , Sse2
+    , Avx2
+    , Neon
+};
+
+//! Returns instruction set kernels are dispatched to
+InstructionSet GetInstructionSet();
+
+//! Checks if given instruction set is supported by the CPU
+bool IsInstructionSetSupported(InstructionSet set);
+
+/** @brief  Overrides instruction set kernels are dispatched to
+ *
+ *  @param  set instruction set
+ *
+ *  @return @c true if @p set is supported and was selected, @c false otherwise
+ */
+bool SetInstructionSet(InstructionSet set);
+
+/** @brief  Converts 16-bit samples to float ones
+ *
+ *  @param  pIn     input samples
+ *  @param  pOut    output samples
+ *  @param  count   number of samples
+ */
+void ConvertInt16ToFloat(int16_t const* pIn, float* pOut, size_t count);
+
+/** @brief  Converts float samples to 16-bit ones
+ *
+ *  Input is clamped to [-1, 1] range and rounded to nearest
+ *
+ *  @param  pIn     input samples
+ *  @param  pOut    output samples
+ *  @param  count   number of samples
+ */
+void ConvertFloatToInt16(float const* pIn, int16_t* pOut, size_t count);
+
+/** @brief  Averages channels of stereo frames into mono samples
+ *
+ *  @note   @p pOut may be equal to @p pIn
+ *
+ *  @param  pIn         interleaved stereo samples
+ *  @param  pOut        mono samples
+ *  @param  frameCount  number of frames
+ */
+void DownmixStereoToMono(float const* pIn, float* pOut, size_t frameCount);
+
+//! @copydoc DownmixStereoToMono(float const*, float*, size_t)
+void DownmixStereoToMono(int16_t const* pIn, int16_t* pOut, size_t frameCount);
+
+/** @brief  Multiplies samples by given gain in place
+ *
+ *  @param  pSamples    samples
+ *  @param  count       number of samples
+ *  @param  gain        gain multiplier
+ */
+void ScaleGain(float* pSamples, size_t count, float gain);
+
+/** @brief  Interleaves planar samples
+ *
+ *  @param  ppPlanes    per-channel samples
+ *  @param  channels    number of channels
+ *  @param  frameCount  number of frames
+ *  @param  pOut        interleaved samples
+ */
+void Interleave(float const* const* ppPlanes, uint32_t channels, size_t frameCount, float* pOut);
+
+/** @brief  Splits interleaved samples into planar ones
+ *
+ *  @param  pIn         interleaved samples
+ *  @param  channels    number of channels
+ *  @param  frameCount  number of frames
+ *  @param  ppPlanes    per-channel samples
+ */
+void Deinterleave(float const* pIn, uint32_t channels, size_t frameCount, float* const* ppPlanes);
+
+}
+}
+
+#endif // TULPAR_KERNELS_HPP
@@ -11,12 +11,22 @@
 
 #include <tulpar/audio/Buffer.hpp>
 #include <tulpar/audio/Listener.hpp>
+#include <tulpar/audio/Reference.hpp>
 #include <tulpar/audio/Source.hpp>
+#include <tulpar/audio/SourceEvent.hpp>
+#include <tulpar/audio/Voice.hpp>
 
 #include <mule/asset/Handler.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
@@ -26,16 +36,59 @@ namespace tulpar
 namespace internal
 {
 class BufferCollection;
+class CommandQueue;
+class ConsumerLock;
 class Context;
 class Device;
 class ListenerController;
+class PcmCache;
 class SourceCollection;
+class VoiceCollection;
+class WorkerPool;
+struct Command;
 }
 
-/** @brief  Tulpar library entry point */
+/** @brief  Tulpar library entry point
+ *
+ *  If initialized with TulparConfigurator::isThreaded set, library owns
+ *  an audio thread that makes the context current and periodically
+ *  performs Update(). Mutating calls on Source, Listener, Buffer and
+ *  Voice objects made from any other thread are pushed to a lock-free
+ *  queue and applied by the audio thread, so callers never wait on OpenAL.
+ *  Getters, spawning and getting objects wait for the audio thread to
+ *  finish its current update, so getters return the values applied so
+ *  far. Calls queued for an object that is reset before they are applied
+ *  are dropped. Reinitialize() shall not be made concurrently with other
+ *  calls.
+ */
 class TulparAudio
 {
 public:
+    /** @brief  Scoped frame of deferred updates
+     *
+     *  Calls TulparAudio::BeginFrame() on construction and
+     *  TulparAudio::EndFrame() on destruction
+     */
+    class UpdateBatch
+    {
+    public:
+        //! Begins frame on given library instance
+        explicit UpdateBatch(TulparAudio& audio);
+
+        //! Disable copy constructor
+        UpdateBatch(UpdateBatch const& other) = delete;
+
+        //! Disable assignment operator
+        UpdateBatch& operator=(UpdateBatch const& other) = delete;
+
+        //! Ends frame on associated library instance
+        ~UpdateBatch();
+
+    private:
+        //! Associated library instance
+        TulparAudio& m_audio;
+    };
+
     /** @brief Creates library instance
      *
      *  Initializes #m_listener
@@ -78,6 +131,67 @@ public:
      */
     void Deinitialize();
 
+    /** @brief  Updates library instance
+     *
+     *  Uploads asynchronously decoded buffer data, refills buffers of
+     *  streamed sources and rebinds voices to sources, shall be called
+     *  periodically (e.g. once per frame) while there are pending requests,
+     *  streamed sources or voices are playing
+     *
+     *  @note   Does nothing in threaded mode as the audio thread updates
+     *          library instance
+     */
+    void Update();
+
+    /** @brief  Begins frame of deferred updates
+     *
+     *  Source and listener changes made until matching EndFrame() call are
+     *  applied by the mixer at once. Frames can be nested, changes are
+     *  applied when the outermost frame ends.
+     *
+     *  @note   If AL_SOFT_deferred_updates is not supported, changes are
+     *          applied immediately
+     *
+     *  @sa UpdateBatch
+     */
+    void BeginFrame();
+
+    /** @brief  Ends frame of deferred updates
+     *
+     *  @sa BeginFrame
+     */
+    void EndFrame();
+
+    /** @brief  Renders samples using loopback device
+     *
+     *  Mixes next @p frameCount sample frames as fast as possible,
+     *  Update() measures elapsed time in rendered frames when loopback
+     *  device is used
+     *
+     *  @param  pSamples    storage for interleaved 16-bit samples of at least
+     *                      @p frameCount * TulparConfigurator::Device::loopbackChannelCount
+     *                      elements
+     *  @param  frameCount  number of sample frames to render
+     *
+     *  @return @c true if samples were rendered, @c false otherwise
+     *
+     *  @sa TulparConfigurator::Device::Loopback
+     */
+    bool RenderSamples(int16_t* pSamples, uint32_t frameCount);
+
+    /** @brief  Renders samples using loopback device into WAV file
+     *
+     *  Renders in chunks calling Update() after each chunk
+     *
+     *  @param  path        output file path
+     *  @param  duration    duration of rendered audio
+     *
+     *  @return @c true if file was written, @c false otherwise
+     *
+     *  @sa RenderSamples
+     */
+    bool RenderToFile(std::string const& path, std::chrono::nanoseconds duration);
+
     //! Returns listener controller object
     audio::Listener GetListener() const;
 
@@ -87,16 +201,320 @@ public:
     //! Spawns new source controller object
     audio::Source SpawnSource();
 
+    //! Returns lightweight reference to given valid source
+    audio::SourceRef GetSourceRef(audio::Source const& source) const;
+
+    //! Returns @c true if given reference points to an existing source
+    bool IsValid(audio::SourceRef reference) const;
+
+    /** @brief  Returns source controller object pointed by given reference
+     *
+     *  Controller object is copied while the audio thread is held, so it
+     *  stays usable after sources are spawned or reset. Batch calls such as
+     *  SetSourcesPosition() take references directly and copy nothing.
+     *
+     *  @param  reference   valid source reference
+     *
+     *  @return source controller object
+     */
+    audio::Source GetSource(audio::SourceRef reference) const;
+
+    /** @brief  Plays source pointed by given reference
+     *
+     *  Per-source calls taking a reference resolve it without copying
+     *  a controller object, see GetSource()
+     *
+     *  @param  reference   source reference
+     *
+     *  @return @c true if source is now playing, @c false if reference is
+     *          invalid or the call failed
+     *
+     *  @sa audio::Source::Play
+     */
+    bool PlaySource(audio::SourceRef reference);
+
+    /** @brief  Stops source pointed by given reference
+     *
+     *  @sa PlaySource, audio::Source::Stop
+     */
+    bool StopSource(audio::SourceRef reference);
+
+    /** @brief  Returns state of source pointed by given reference
+     *
+     *  @param  reference   valid source reference
+     *
+     *  @sa audio::Source::GetState
+     */
+    audio::Source::State GetSourceState(audio::SourceRef reference) const;
+
+    /** @brief  Returns gain of source pointed by given reference
+     *
+     *  @param  reference   valid source reference
+     *
+     *  @sa audio::Source::GetGain
+     */
+    float GetSourceGain(audio::SourceRef reference) const;
+
+    /** @brief  Sets gain of source pointed by given reference
+     *
+     *  @sa PlaySource, audio::Source::SetGain
+     */
+    bool SetSourceGain(audio::SourceRef reference, float value);
+
+    /** @brief  Returns position of source pointed by given reference
+     *
+     *  @param  reference   valid source reference
+     *
+     *  @sa audio::Source::GetPosition
+     */
+    std::array<float, 3> GetSourcePosition(audio::SourceRef reference) const;
+
+    /** @brief  Sets position of source pointed by given reference
+     *
+     *  @sa PlaySource, audio::Source::SetPosition
+     */
+    bool SetSourcePosition(audio::SourceRef reference, std::array<float, 3> vec);
+
+    /** @brief  Returns source events collected since last call
+     *
+     *  Events are collected during Update(). With AL_SOFT_events source
+     *  completion is delivered by OpenAL, otherwise sources known to be
+     *  playing are polled. Events referring to sources that were reset
+     *  since are left in the result and fail IsValid() check.
+     *
+     *  @return source events in order of detection
+     */
+    std::vector<audio::SourceEvent> PollSourceEvents();
+
+    /** @brief  Plays given sources with a single OpenAL call
+     *
+     *  @param  sources valid source objects
+     *
+     *  @return @c true if sources are now playing, @c false otherwise
+     *
+     *  @sa audio::Source::Play
+     */
+    bool PlaySources(std::vector<audio::Source> const& sources);
+
+    /** @brief  Stops given sources with a single OpenAL call
+     *
+     *  @param  sources valid source objects
+     *
+     *  @return @c true if sources were stopped, @c false otherwise
+     *
+     *  @sa audio::Source::Stop
+     */
+    bool StopSources(std::vector<audio::Source> const& sources);
+
+    /** @brief  Rewinds given sources with a single OpenAL call
+     *
+     *  @param  sources valid source objects
+     *
+     *  @return @c true if sources were rewound, @c false otherwise
+     *
+     *  @sa audio::Source::Rewind
+     */
+    bool RewindSources(std::vector<audio::Source> const& sources);
+
+    /** @brief  Pauses given sources with a single OpenAL call
+     *
+     *  @param  sources valid source objects
+     *
+     *  @return @c true if sources are now paused, @c false otherwise
+     *
+     *  @sa audio::Source::Pause
+     */
+    bool PauseSources(std::vector<audio::Source> const& sources);
+
+    /** @brief  Sets positions of given sources from structure-of-arrays input
+     *
+     *  References are resolved and components are validated for the whole
+     *  batch before any source is changed, changes are applied in a single
+     *  UpdateBatch scope
+     *
+     *  @param  pSources    source references
+     *  @param  count       number of sources
+     *  @param  pX          x components, one per source
+     *  @param  pY          y components, one per source
+     *  @param  pZ          z components, one per source
+     *
+     *  @return @c true if positions were set, @c false if any reference is
+     *          invalid or any component is not finite
+     *
+     *  @sa audio::Source::SetPosition
+     */
+    bool SetSourcesPosition(audio::SourceRef const* pSources
+        , uint32_t count
+        , float const* pX
+        , float const* pY
+        , float const* pZ
+    );
+
+    /** @brief  Sets velocities of given sources from structure-of-arrays input
+     *
+     *  @sa SetSourcesPosition, audio::Source::SetVelocity
+     */
+    bool SetSourcesVelocity(audio::SourceRef const* pSources
+        , uint32_t count
+        , float const* pX
+        , float const* pY
+        , float const* pZ
+    );
+
+    /** @brief  Returns references to sources positioned within given sphere
+     *
+     *  Sources are looked up in a uniform grid with cells of
+     *  TulparConfigurator::gridCellSize, relative sources are not reported
+     *
+     *  @param  center  sphere center
+     *  @param  radius  sphere radius
+     *
+     *  @return references to found sources
+     */
+    std::vector<audio::SourceRef> GetSourcesInRadius(std::array<float, 3> const& center, float radius) const;
+
+    /** @brief  Estimates gain of given sources as heard by the listener
+     *
+     *  Listener distance model is evaluated only for given sources over
+     *  cached properties without querying OpenAL, which makes the
+     *  estimate a cheap score for prioritization and culling. Cones and
+     *  listener gain are not applied.
+     *
+     *  @param  pSources    source references
+     *  @param  count       number of sources
+     *  @param  pResult     estimated gain, one per source
+     *
+     *  @return @c true if estimates were computed, @c false if any
+     *          reference is invalid
+     *
+     *  @sa audio::Source::SetReferenceDistance, audio::Listener::SetDistanceModel
+     */
+    bool ComputeAudibility(audio::SourceRef const* pSources, uint32_t count, float* pResult) const;
+
+    //! Returns voice controller object identified by @p handle
+    audio::Voice GetVoice(audio::Voice::Handle handle) const;
+
+    /** @brief  Spawns new voice controller object
+     *
+     *  Voices are not limited by the number of sources supported by
+     *  the device, only up to TulparConfigurator::voiceLimit voices with
+     *  highest priority and audibility are played by real sources
+     *
+     *  @sa audio::Voice
+     */
+    audio::Voice SpawnVoice();
+
     //! Returns buffer controller object identified by @p handle
     audio::Buffer GetBuffer(audio::Buffer::Handle handle) const;
 
     //! Spawns new buffer controller object
     audio::Buffer SpawnBuffer();
 
+    //! Returns lightweight reference to given valid buffer
+    audio::BufferRef GetBufferRef(audio::Buffer const& buffer) const;
+
+    //! Returns @c true if given reference points to an existing buffer
+    bool IsValid(audio::BufferRef reference) const;
+
+    /** @brief  Returns buffer controller object pointed by given reference
+     *
+     *  Controller object is copied while the audio thread is held, so it
+     *  stays usable after buffers are spawned or reset.
+     *
+     *  @param  reference   valid buffer reference
+     *
+     *  @return buffer controller object
+     */
+    audio::Buffer GetBuffer(audio::BufferRef reference) const;
+
+    /** @brief  Returns total size of buffer data stored in OpenAL in bytes
+     *
+     *  @sa TulparConfigurator::bufferBudget, audio::Buffer::GetResidentSize
+     */
+    uint64_t GetResidentBufferSize() const;
+
+    /** @brief  Initializes given buffers with given data asynchronously
+     *
+     *  Assets are decoded in parallel by worker threads and uploaded
+     *  during Update()
+     *
+     *  @attention  unless in threaded mode, waiting on returned future
+     *              from the thread calling Update() blocks forever
+     *
+     *  @param  buffers valid buffer objects
+     *  @param  assets  asset handles to audio content, one per buffer
+     *  @param  downmix channel handling of decoded data for all buffers
+     *
+     *  @return future holding @c true if all data was set successfully
+     *
+     *  @sa audio::Buffer::BindDataAsync
+     */
+    std::future<bool> BindBuffersDataAsync(
+        std::vector<audio::Buffer> const& buffers
+        , std::vector<mule::asset::Handler> const& assets
+        , audio::Buffer::Downmix downmix = audio::Buffer::Downmix::Default
+    );
+
 private:
+    //! Returns @c true if calls shall be pushed to the audio thread
+    bool IsDeferringCommands() const;
+
+    //! Returns lock synchronizing with the audio thread, no-op lock if thread is not running
+    internal::ConsumerLock LockThread() const;
+
+    /** @brief  Resolves given source reference into a handle
+     *
+     *  @param  reference   source reference
+     *  @param  action      action name used for logging
+     *  @param  handle      resolved handle
+     *
+     *  @return @c true if reference is valid, @c false otherwise
+     */
+    bool ResolveSourceRef(audio::SourceRef reference, char const* action, uint32_t& handle) const;
+
+    /** @brief  Resolves given source references into handles
+     *
+     *  @param  pSources    source references
+     *  @param  count       number of references
+     *  @param  handles     resolved handles
+     *
+     *  @return @c true if all references are valid, @c false otherwise
+     */
+    bool ResolveSourceRefs(audio::SourceRef const* pSources
+        , uint32_t count
+        , std::vector<uint32_t>& handles
+    ) const;
+
+    //! Updates collections, see Update()
+    void UpdateCollections();
+
+    //! Returns time passed since previous call
+    std::chrono::nanoseconds ConsumeElapsedTime();
+
+    //! Starts audio thread and routes mutating calls to #m_commands
+    void StartThread();
+
+    /** @brief  Stops audio thread
+     *
+     *  Applies remaining commands and makes context current on calling thread
+     */
+    void StopThread();
+
+    //! Audio thread routine
+    void RunThread();
+
+    //! Applies all queued commands as a single deferred update
+    void ProcessCommands();
+
+    //! Applies given command
+    void ApplyCommand(internal::Command const& command);
+
     //! Flag indicating if object was initialized successfully
     bool m_isInitialized;
 
+    //! Number of frames begun and not yet ended
+    uint32_t m_frameDepth;
+
     //! Device associated with library instance
     std::shared_ptr<internal::Device> m_device;
 
@@ -106,11 +524,44 @@ private:
     //! Listener controller
     std::shared_ptr<internal::ListenerController> m_listener;
 
+    //! Worker threads decoding buffer data
+    std::shared_ptr<internal::WorkerPool> m_workers;
+
+    //! Decoded buffer data cache shared across reinitializations
+    std::shared_ptr<internal::PcmCache> m_pcmCache;
+
     //! Audio buffer collection
     std::shared_ptr<internal::BufferCollection> m_buffers;
 
     //! Audio source collection
     std::shared_ptr<internal::SourceCollection> m_sources;
+
+    //! Audio voice collection
+    std::shared_ptr<internal::VoiceCollection> m_voices;
+
+    //! Minimum audibility of playing sources, see TulparConfigurator::cullThreshold
+    float m_cullThreshold;
+
+    //! Time of the last update
+    std::chrono::steady_clock::time_point m_lastUpdate;
+
+    //! Duration of samples rendered by loopback device since the last update
+    std::chrono::nanoseconds m_renderedTime;
+
+    //! Calls queued for the audio thread
+    std::shared_ptr<internal::CommandQueue> m_commands;
+
+    //! Audio thread
+    std::thread m_thread;
+
+    //! Mutex held by the audio thread while it applies commands and updates collections
+    mutable std::mutex m_threadMutex;
+
+    //! Flag indicating if audio thread shall keep running
+    std::atomic<bool> m_isThreadRunning;
+
+    //! Period between audio thread updates
+    std::chrono::milliseconds m_threadPeriod;
 };
 
 }
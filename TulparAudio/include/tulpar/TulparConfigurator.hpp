@@ -27,6 +27,7 @@ public:
          *  Initializes device with given values. Default values:
          *  - name is empty
          *  - default flag is set to @c true
+         *  - loopback flag is set to @c false
          *
          *  @param  name        device name
          *  @param  isDefault   indicates if device is considered default by the system
@@ -34,14 +35,46 @@ public:
         Device(std::string const& name = std::string(), bool isDefault = true)
             : name(name)
             , isDefault(isDefault)
+            , isLoopback(false)
+            , loopbackFrequencyHz(44100)
+            , loopbackChannelCount(2)
         {
         }
 
+        /** @brief  Creates loopback device description
+         *
+         *  Loopback device does not output audio, rendered samples are
+         *  pulled with TulparAudio::RenderSamples() or TulparAudio::RenderToFile()
+         *
+         *  @param  frequencyHz     rendering frequency
+         *  @param  channelCount    number of rendered channels, 1 or 2
+         *
+         *  @return loopback device description
+         */
+        static Device Loopback(uint32_t frequencyHz = 44100, uint8_t channelCount = 2)
+        {
+            Device result(std::string(), false);
+            result.isLoopback = true;
+            result.loopbackFrequencyHz = frequencyHz;
+            result.loopbackChannelCount = channelCount;
+
+            return result;
+        }
+
         //! Device name
         std::string name;
 
         //! Flag indicating if device is default
         bool isDefault;
+
+        //! Flag indicating if device is opened via ALC_SOFT_loopback
+        bool isLoopback;
+
+        //! Frequency of samples rendered by loopback device
+        uint32_t loopbackFrequencyHz;
+
+        //! Number of channels rendered by loopback device
+        uint8_t loopbackChannelCount;
     };
 
     //! Creates configuration object
@@ -65,6 +98,58 @@ public:
     //! Source generation batch size
     uint32_t sourceBatch;
 
+    //! Number of buffers queued per streamed source
+    uint32_t streamBufferCount;
+
+    //! Number of frames decoded into each stream buffer
+    uint32_t streamBufferFrames;
+
+    //! Number of threads decoding buffer data asynchronously, @c 0 for hardware thread count
+    uint32_t decoderThreads;
+
+    //! Memory budget in bytes for decoded buffer data cache, @c 0 disables caching
+    uint64_t pcmCacheBudget;
+
+    /** @brief  Memory budget in bytes for buffer data stored in OpenAL, @c 0 disables eviction
+     *
+     *  Least recently used buffers not attached to any source are evicted
+     *  once the budget is exceeded and decoded again when attached
+     */
+    uint64_t bufferBudget;
+
+    /** @brief  Flag indicating if stereo buffer data is down-mixed to mono by default
+     *
+     *  OpenAL spatializes mono buffers only. Down-mixing halves memory and
+     *  upload bandwidth of stereo assets used for positional audio.
+     *
+     *  @sa audio::Buffer::Downmix
+     */
+    bool isStereoDownmixed;
+
+    //! Maximum number of sources used to play voices
+    uint32_t voiceLimit;
+
+    /** @brief  Minimum audibility of playing sources, @c 0 disables culling
+     *
+     *  Audibility is source gain attenuated by the listener distance model,
+     *  see TulparAudio::ComputeAudibility(). Sources falling below the
+     *  threshold are paused during Update() and resumed at their expected
+     *  offset once audible again.
+     */
+    float cullThreshold;
+
+    //! Edge length of spatial grid cells used by TulparAudio::GetSourcesInRadius()
+    float gridCellSize;
+
+    //! Flag indicating if calls shall be applied by a dedicated audio thread
+    bool isThreaded;
+
+    //! Maximum number of calls queued for the audio thread
+    uint32_t commandQueueSize;
+
+    //! Period in milliseconds between audio thread updates
+    uint32_t threadPeriodMs;
+
     //! Device to be used
     Device device;
 };
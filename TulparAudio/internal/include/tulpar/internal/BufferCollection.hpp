@@ -8,6 +8,11 @@
 #define TULPAR_INTERNAL_BUFFER_COLLECTION_HPP
 
 #include <tulpar/internal/Collection.hpp>
+#include <tulpar/internal/CommandQueue.hpp>
+#include <tulpar/internal/MappedFile.hpp>
+#include <tulpar/internal/PcmCache.hpp>
+#include <tulpar/internal/PcmData.hpp>
+#include <tulpar/internal/WorkerPool.hpp>
 
 #include <tulpar/audio/Buffer.hpp>
 
@@ -15,10 +20,19 @@
 
 #include <mule/asset/Handler.hpp>
 
+#include <AL/al.h>
+
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace tulpar
 {
@@ -80,14 +94,93 @@ public:
         , Collection<audio::Buffer>::HandleDeleter deleter = OpenAVBufferHandler::Delete
     );
 
-    /** @brief  Destructs buffer collection */
+    /** @brief  Destructs buffer collection
+     *
+     *  Waits for in-flight decoding jobs, pending requests are completed
+     *  with @c false
+     */
     virtual ~BufferCollection();
 
+    /** @brief  Sets worker pool used for asynchronous decoding
+     *
+     *  @param  pool    worker pool, if @c nullptr then asynchronous requests
+     *                  are decoded on the calling thread
+     */
+    void SetWorkerPool(std::shared_ptr<WorkerPool> pool) { m_workerPool = pool; }
+
+    /** @brief  Sets cache of decoded data
+     *
+     *  When set, binding an asset that is already cached skips decoding
+     *  and newly decoded data is stored in the cache
+     *
+     *  @param  cache   decoded data cache, if @c nullptr then caching is disabled
+     */
+    void SetPcmCache(std::shared_ptr<PcmCache> cache) { m_pcmCache = cache; }
+
+    /** @brief  Sets channel handling used by requests with audio::Buffer::Downmix::Default
+     *
+     *  @param  isDownmixed flag indicating if stereo data is down-mixed to mono by default
+     */
+    void SetStereoDownmix(bool isDownmixed) { m_isStereoDownmixed = isDownmixed; }
+
+    /** @brief  Sets memory budget for buffer data resident in OpenAL
+     *
+     *  Once resident data exceeds the budget, buffers not attached to any
+     *  source are evicted in least recently used order. Evicted buffers
+     *  keep their metadata and are decoded again from retained asset or
+     *  file when attached with AcquireBuffer().
+     *
+     *  @param  budget  maximum size of resident data in bytes, @c 0 disables eviction
+     */
+    void SetBudget(uint64_t budget);
+
+    //! Returns size of buffer data resident in OpenAL in bytes
+    uint64_t GetResidentSize() const { return m_residentSize; }
+
+    /** @brief  Marks buffer as attached to a source
+     *
+     *  Attached buffers are never evicted. Evicted data is decoded and
+     *  uploaded again before returning.
+     *
+     *  @param  handle  buffer handle, @c 0 is ignored
+     *
+     *  @return @c false if evicted data could not be reloaded, in which
+     *          case the buffer is not marked, @c true otherwise
+     */
+    bool AcquireBuffer(Handle handle);
+
+    /** @brief  Marks buffer as detached from a source
+     *
+     *  @param  handle  buffer handle previously passed to AcquireBuffer()
+     */
+    void ReleaseBuffer(Handle handle);
+
+    /** @brief  Checks buffer formats supported by current context
+     *
+     *  Looks up AL_EXT_FLOAT32 and AL_EXT_MCFORMATS extensions. Without them
+     *  only 8-bit and 16-bit mono and stereo data is accepted.
+     *
+     *  @note   Has to be called after Context::MakeCurrent()
+     */
+    void QueryFormatSupport();
+
+    /** @brief  Returns OpenAL buffer format for given data layout
+     *
+     *  @param  format      sample format
+     *  @param  channels    number of audio channels
+     *
+     *  @return OpenAL format, @c AL_NONE if layout is not supported
+     */
+    ALenum GetFormat(PcmData::Format format, uint8_t channels) const;
+
     /** @brief  Migrates buffers from given collection
      *
      *  @note   Context::MakeCurrent() has to be called on new context prior to
      *          calling this method in order to migrate buffers
      *
+     *  @note   FinishPendingData() has to be called on @p other prior to
+     *          switching contexts so that asynchronous requests are not lost
+     *
      *  @attention  all Buffer objects from @p other are updated to point to
      *              this collection with new handles
      *
@@ -106,6 +199,9 @@ public:
     //! Returns buffer channel count
     uint8_t GetBufferChannelCount(Handle handle) const;
 
+    //! Returns buffer sample format
+    PcmData::Format GetBufferSampleFormat(Handle handle) const;
+
     //! Returns buffer frequency
     uint32_t GetBufferFrequencyHz(Handle handle) const;
 
@@ -115,17 +211,126 @@ public:
     //! Returns buffer duration
     std::chrono::nanoseconds GetBufferDuration(Handle handle) const;
 
+    //! Returns size of buffer data resident in OpenAL in bytes, @c 0 if evicted
+    uint64_t GetBufferResidentSize(Handle handle) const;
+
     /** @brief  Initializes buffer with given data
      *
      *  Apart from initializing buffer with audio data, parses and sets
-     *  metadata, see @ref BufferInfo for more details.
+     *  metadata, see @ref BufferInfo for more details. Decoding is skipped
+     *  if @p asset is found in the cache set via SetPcmCache(). Format is
+     *  sniffed from content, RIFF/WAVE samples are uploaded directly from
+     *  @p asset while anything else is decoded as Ogg Vorbis.
+     *
+     *  If called outside of the command queue consumer thread, data is
+     *  set asynchronously as with SetBufferDataAsync()
+     *
+     *  Stereo data is down-mixed to mono as requested by @p downmix, in
+     *  which case RIFF/WAVE samples are copied. Cached stereo data is
+     *  down-mixed on every use so that it serves both kinds of requests.
      *
      *  @param  handle  valid buffer handle
      *  @param  asset   asset handle to audio content
+     *  @param  downmix channel handling of decoded data
      *
      *  @return @c true if data was set successfully, @c false otherwise
      */
-    bool SetBufferData(Handle handle, mule::asset::Handler asset);
+    bool SetBufferData(Handle handle
+        , mule::asset::Handler asset
+        , audio::Buffer::Downmix downmix = audio::Buffer::Downmix::Default
+    );
+
+    /** @brief  Initializes buffer with content of given file
+     *
+     *  File is memory mapped and decoded in place, so compressed data is not
+     *  copied to the heap and its pages are shared with other processes
+     *  mapping the same file. Mapping is released once data is uploaded.
+     *  Decoded data is not cached.
+     *
+     *  If called outside of the command queue consumer thread, data is
+     *  set asynchronously as with SetBufferFileAsync()
+     *
+     *  @param  handle  valid buffer handle
+     *  @param  path    path to Ogg Vorbis or RIFF/WAVE file
+     *  @param  downmix channel handling of decoded data
+     *
+     *  @return @c true if data was set successfully, @c false otherwise
+     *
+     *  @sa SetBufferData
+     */
+    bool SetBufferFile(Handle handle
+        , std::string const& path
+        , audio::Buffer::Downmix downmix = audio::Buffer::Downmix::Default
+    );
+
+    /** @brief  Initializes buffer with content of given file asynchronously
+     *
+     *  File is mapped on the calling thread and decoded by worker pool
+     *
+     *  @param  handle  valid buffer handle
+     *  @param  path    path to Ogg Vorbis or RIFF/WAVE file
+     *  @param  downmix channel handling of decoded data
+     *
+     *  @return future holding @c true if data was set successfully
+     *
+     *  @sa SetBufferFile, SetBufferDataAsync
+     */
+    std::future<bool> SetBufferFileAsync(Handle handle
+        , std::string const& path
+        , audio::Buffer::Downmix downmix = audio::Buffer::Downmix::Default
+    );
+
+    /** @brief  Initializes buffer with given data asynchronously
+     *
+     *  Decoding is performed by worker pool, while uploading to OpenAL is
+     *  performed by UploadPendingData() on the thread owning the context.
+     *  If buffer is reset before upload, request completes with @c false.
+     *
+     *  @attention  waiting on returned future from the thread that calls
+     *              UploadPendingData() blocks forever
+     *
+     *  @param  handle  valid buffer handle
+     *  @param  asset   asset handle to audio content
+     *  @param  downmix channel handling of decoded data
+     *
+     *  @return future holding @c true if data was set successfully
+     *
+     *  @sa SetBufferData
+     */
+    std::future<bool> SetBufferDataAsync(Handle handle
+        , mule::asset::Handler asset
+        , audio::Buffer::Downmix downmix = audio::Buffer::Downmix::Default
+    );
+
+    /** @brief  Initializes buffers with given data asynchronously
+     *
+     *  Assets are decoded in parallel, returned future is ready once
+     *  all buffers are processed
+     *
+     *  @param  handles valid buffer handles
+     *  @param  assets  asset handles to audio content, one per buffer
+     *  @param  downmix channel handling of decoded data for all buffers
+     *
+     *  @return future holding @c true if all data was set successfully
+     *
+     *  @sa SetBufferDataAsync
+     */
+    std::future<bool> SetBuffersDataAsync(Handles const& handles
+        , std::vector<mule::asset::Handler> const& assets
+        , audio::Buffer::Downmix downmix = audio::Buffer::Downmix::Default
+    );
+
+    /** @brief  Uploads data decoded by asynchronous requests
+     *
+     *  @note   Has to be called on the thread owning current context
+     */
+    void UploadPendingData();
+
+    /** @brief  Waits for all asynchronous requests and uploads their data
+     *
+     *  @note   Has to be called on the thread owning current context
+     */
+    void FinishPendingData();
 
     //! Resets given buffer
     void ResetBuffer(Handle handle);
@@ -135,18 +340,201 @@ protected:
     virtual audio::Buffer CreateObject(Handle handle) override final;
 
 private:
+    //! Shared completion state of asynchronous request
+    struct PendingBatch
+    {
+        //! Promise fulfilled once all buffers are processed
+        std::promise<bool> promise;
+
+        //! Number of buffers that are not processed yet
+        uint32_t remaining  = 0;
+
+        //! Accumulated result
+        bool result         = true;
+    };
+
+    //! Asynchronous request for a single buffer
+    struct PendingData
+    {
+        //! Target buffer handle
+        Handle handle                       = Handle();
+
+        //! Generation of @p handle at the moment of request
+        Generation generation               = 0;
+
+        //! Handle to audio content
+        mule::asset::Handler asset          = mule::asset::Handler();
+
+        //! Mapped audio content, used instead of @p asset if set
+        std::shared_ptr<MappedFile> file    = nullptr;
+
+        //! Decoded data
+        std::shared_ptr<PcmData const> pcm  = nullptr;
+
+        //! Flag indicating if stereo data shall be down-mixed to mono
+        bool isMono                         = false;
+
+        //! Flag indicating if data was decoded successfully
+        bool isDecoded                      = false;
+
+        //! Flag indicating if data was taken from cache
+        bool isCached                       = false;
+
+        //! Completion state shared by the whole request
+        std::shared_ptr<PendingBatch> batch = nullptr;
+    };
+
+    /** @brief  Decodes given request on worker pool
+     *
+     *  @param  pending request that is not cached
+     */
+    void SubmitData(std::shared_ptr<PendingData> pending);
+
+    //! Returns @c true if stereo data shall be down-mixed to mono for given request
+    bool IsMono(audio::Buffer::Downmix downmix) const;
+
+    /** @brief  Looks up cached data usable for given request
+     *
+     *  @param  asset   asset handle to audio content
+     *  @param  isMono  flag indicating if stereo data shall be down-mixed to mono
+     *
+     *  @return decoded data, @c nullptr if cache is disabled or has no usable entry
+     */
+    std::shared_ptr<PcmData const> FindCachedData(mule::asset::Handler const& asset, bool isMono);
+
+    /** @brief  Decodes given audio content
+     *
+     *  RIFF/WAVE data is not decoded, @p pcm borrows it from @p pData
+     *  unless it is down-mixed
+     *
+     *  @note   Thread safe, does not call OpenAL
+     *
+     *  @param  pData       audio content
+     *  @param  size        size of @p pData in bytes
+     *  @param  name        content name used for logging
+     *  @param  isFloat     flag indicating if compressed data shall be decoded
+     *                      to 32-bit float samples instead of 16-bit ones
+     *  @param  isMono      flag indicating if stereo data shall be down-mixed to mono
+     *  @param  pcm         decoded data
+     *
+     *  @return @c true if data was decoded successfully, @c false otherwise
+     */
+    static bool DecodeData(uint8_t const* pData
+        , size_t size
+        , std::string const& name
+        , bool isFloat
+        , bool isMono
+        , PcmData& pcm
+    );
+
+    /** @brief  Decodes Ogg Vorbis content
+     *
+     *  @param  pData       audio content
+     *  @param  size        size of @p pData in bytes
+     *  @param  name        content name used for logging
+     *  @param  isFloat     flag indicating if data shall be decoded to 32-bit float samples
+     *  @param  pcm         decoded data
+     *
+     *  @return @c true if data was decoded successfully, @c false otherwise
+     */
+    static bool DecodeVorbis(uint8_t const* pData, size_t size, std::string const& name, bool isFloat, PcmData& pcm);
+
+    /** @brief  Uploads decoded data to given buffer and updates its metadata
+     *
+     *  @param  handle  valid buffer handle
+     *  @param  asset   asset handle that @p pcm was decoded from
+     *  @param  path    path to file that @p pcm was decoded from, empty if
+     *                  @p asset was used
+     *  @param  isMono  flag indicating if down-mix to mono was requested
+     *  @param  pcm     decoded data
+     *
+     *  @return @c true if data was set successfully, @c false otherwise
+     */
+    bool UploadData(Handle handle
+        , mule::asset::Handler const& asset
+        , std::string const& path
+        , bool isMono
+        , PcmData const& pcm
+    );
+
+    //! Completes given request with given result
+    static void CompleteData(PendingData& pending, bool result);
+
+    //! Decodes and uploads data of evicted buffer again
+    bool ReloadBuffer(Handle handle);
+
+    /** @brief  Releases OpenAL storage of given buffer
+     *
+     *  @param  handle  resident buffer handle not attached to any source
+     *
+     *  @return @c true if buffer was evicted, @c false otherwise
+     */
+    bool EvictBuffer(Handle handle);
+
+    /** @brief  Evicts least recently used buffers until budget is met
+     *
+     *  The most recently used buffer is kept so that freshly bound data
+     *  is not dropped right away
+     */
+    void EvictBuffers();
+
+    //! Worker pool used for asynchronous decoding
+    std::shared_ptr<WorkerPool> m_workerPool;
+
+    //! Cache of decoded data
+    std::shared_ptr<PcmCache> m_pcmCache;
+
+    //! Mutex guarding @p m_decoded and @p m_inFlightCount
+    std::mutex m_pendingMutex;
+
+    //! Condition signaled when in-flight request is decoded
+    std::condition_variable m_pendingCondition;
+
+    //! Decoded requests waiting for upload
+    std::vector<std::shared_ptr<PendingData>> m_decoded;
+
+    //! Number of requests being decoded
+    uint32_t m_inFlightCount;
+
+    //! Flag indicating if AL_EXT_FLOAT32 is supported
+    bool m_isFloatSupported;
+
+    //! Flag indicating if AL_EXT_MCFORMATS is supported
+    bool m_isMultiChannelSupported;
+
+    //! Flag indicating if stereo data is down-mixed to mono by default
+    bool m_isStereoDownmixed;
+
+    //! Maximum size of resident buffer data in bytes, @c 0 if unlimited
+    uint64_t m_budget;
+
+    //! Size of resident buffer data in bytes
+    uint64_t m_residentSize;
+
+    //! Resident buffers ordered from the most to the least recently used
+    std::list<Handle> m_residentBuffers;
+
     //! Meta information for initialized buffer handles
     struct BufferInfo
     {
         //! Handle to associated audio content
         mule::asset::Handler asset          = mule::asset::Handler();
 
+        //! Path to associated file, empty if @p asset is used
+        std::string path                    = std::string();
+
         //! Buffer name
         std::string name                    = std::string();
 
         //! Number of audio channels
         uint8_t channels                    = 0;
 
+        //! Flag indicating if stereo data was requested to be down-mixed to mono
+        bool isMono                         = false;
+
+        //! Sample format
+        PcmData::Format format              = PcmData::Format::Int16;
+
         //! Buffer frequency in hz
         uint32_t frequencyHz                = 0;
 
@@ -155,6 +543,21 @@ private:
 
         //! Total duration
         std::chrono::nanoseconds duration   = std::chrono::nanoseconds{0};
+
+        //! Size of uploaded data in bytes
+        uint64_t size                       = 0;
+
+        //! Number of sources buffer is attached to
+        uint32_t useCount                   = 0;
+
+        //! Flag indicating if data is stored in OpenAL
+        bool isResident                     = false;
+
+        //! Flag indicating if data was evicted and has to be reloaded
+        bool isEvicted                      = false;
+
+        //! Position in @p m_residentBuffers, valid if @p isResident is set
+        std::list<Handle>::iterator residentIt = std::list<Handle>::iterator();
     };
 
     //! Collection of meta information for buffers
@@ -7,9 +7,13 @@
 #ifndef TULPAR_INTERNAL_COLLECTION_HPP
 #define TULPAR_INTERNAL_COLLECTION_HPP
 
+#include <tulpar/internal/CommandQueue.hpp>
+
+#include <tulpar/audio/Reference.hpp>
+
 #include <cstdint>
-#include <queue>
-#include <unordered_map>
+#include <limits>
+#include <mutex>
 #include <vector>
 
 namespace tulpar
@@ -18,6 +22,20 @@ namespace internal
 {
 
 /** @brief  Base collection template
+ *
+ *  Objects are stored in a generational slot map. Handles produced by
+ *  @p m_generator are used as indices into @p m_slots which point to densely
+ *  packed @p m_objects and @p m_used, so that spawning, reclaiming and looking
+ *  up an object are constant time operations.
+ *
+ *  @note   handles are expected to be small unsigned integers (which is the
+ *          case for OpenAL names), since @p m_slots grows up to the biggest
+ *          generated handle
+ *
+ *  If command queue is set, collection is modified by its consumer thread
+ *  and by producer threads holding ConsumerLock. Handle validity checks
+ *  take the lock, while generations are guarded separately so that
+ *  commands can be stamped without waiting for the consumer.
  *
  *  @tparam T   object type that has nested Handle type
  */
@@ -31,6 +49,12 @@ public:
     //! Shortcut to a collection of handles
     using Handles = std::vector<Handle>;
 
+    //! Generation counter type used to detect stale handles
+    using Generation = uint32_t;
+
+    //! Shortcut to lightweight object reference type
+    using Reference = audio::Reference<T>;
+
     /** @brief  Shortcut to generator functor
      *
      *  Method shall generate a collection of handles of given size
@@ -84,13 +108,19 @@ public:
 
     /** @brief  Initializes collection settings
      *
-     *  If size of @p m_available is smaller than @p batchSize, calls
+     *  If number of available handles is smaller than @p batchSize, calls
      *  @p m_generator and PushHandles()
      *
      *  @param  batchSize   increment buffer size
      */
     void Initialize(uint32_t batchSize);
 
+    /** @brief  Sets queue receiving mutating calls made outside of its consumer thread
+     *
+     *  @param  pCommands   command queue, @c nullptr to apply all calls immediately
+     */
+    void SetCommandQueue(CommandQueue* pCommands) { m_pCommands = pCommands; }
+
     /** @brief  Returns an object associated with given handle
      *
      *  Creates a copy of an object stored in @p m_objects associated with
@@ -110,9 +140,71 @@ public:
      */
     bool IsValid(Handle handle) const;
 
+    /** @brief  Checks if given @p handle is registered within Collection
+     *          and was not reclaimed since @p generation was obtained
+     *
+     *  @param  handle      handle to check
+     *  @param  generation  generation obtained via GetGeneration()
+     *
+     *  @return @c true if handle is valid, @c false otherwise
+     */
+    bool IsValid(Handle handle, Generation generation) const;
+
+    /** @brief  Returns generation counter for given handle
+     *
+     *  Generation counter is incremented every time a handle is reclaimed.
+     *  May be called from any thread.
+     *
+     *  @param  handle  handle generated by this collection
+     *
+     *  @return current generation of @p handle
+     */
+    Generation GetGeneration(Handle handle) const;
+
+    /** @brief  Returns lightweight reference to an object with given handle
+     *
+     *  Reference index stays the same until the object is reclaimed, even
+     *  if the object is migrated via InheritReferences()
+     *
+     *  @param  handle  valid and used handle
+     *
+     *  @return reference to an object associated with @p handle
+     */
+    Reference GetReference(Handle handle) const;
+
+    /** @brief  Checks if given @p reference points to a used object
+     *
+     *  @param  reference   reference to check
+     *
+     *  @return @c true if reference is valid, @c false otherwise
+     */
+    bool IsValid(Reference reference) const;
+
+    /** @brief  Returns handle of an object pointed by given reference
+     *
+     *  @param  reference   valid reference
+     *
+     *  @return handle associated with @p reference
+     */
+    Handle GetHandle(Reference reference) const;
+
+    /** @brief  Returns an object pointed by given reference
+     *
+     *  @attention  returned reference to the stored object is invalidated
+     *              when objects are spawned or reclaimed
+     *
+     *  @param  reference   valid reference
+     *
+     *  @return object associated with @p reference
+     */
+    T const& Resolve(Reference reference) const;
+
+    //! Returns number of used handles
+    uint32_t GetSize() const { return static_cast<uint32_t>(m_used.size()); }
+
     /** @brief  Spawns new object
      *
-     *  Takes a handle from @p m_available
+     *  Takes a handle from the front of the free list
      *  Generates a batch of handles if needed
      *
      *  @return object associated with newly used handle
@@ -123,12 +215,19 @@ protected:
     /** @brief  Reclaims given handle
      *
      *  Calls @p m_reclaimer
-     *  Removes the handle from @p m_used and returns it to @p m_available
+     *  Removes the handle from @p m_used by swapping it with the last used
+     *  handle, bumps its generation and returns it to the free list
      *
      *  @param  handle  handle to be reclaimed
      */
     void Reclaim(Handle handle);
 
+    //! Returns an object associated with given used handle
+    T& GetObject(Handle handle);
+
+    //! Returns an object associated with given used handle
+    T const& GetObject(Handle handle) const;
+
     /** @brief  Generate and initialize a batch of handles
      *
      *  Generates handle batches if needed
@@ -141,9 +240,44 @@ protected:
      */
     Handles PrepareBatch(uint32_t size);
 
+    /** @brief  Takes over reference table of given collection
+     *
+     *  Used during migration so that references obtained from @p other
+     *  point to migrated objects. Collection shall not contain any
+     *  objects apart from the migrated ones.
+     *
+     *  @param  other       collection objects were migrated from
+     *  @param  oldHandles  handles of migrated objects in @p other
+     *  @param  newHandles  handles of migrated objects in this collection
+     */
+    void InheritReferences(Collection const& other, Handles const& oldHandles, Handles const& newHandles);
+
+    //! Returns @c true if mutating calls shall be pushed to the command queue
+    bool IsDeferringCommands() const { return (nullptr != m_pCommands) && m_pCommands->IsProducerThread(); }
+
+    /** @brief  Pushes given command to the command queue
+     *
+     *  Command is stamped with the current generation of its handle, so
+     *  that it is dropped if the handle is reclaimed before it is applied
+     *
+     *  @param  command call on an object of this collection
+     */
+    void PushCommand(Command command) const;
+
+    /** @brief  Generates a collection of new handles
+     *
+     *  Calls @p m_generator unless overridden
+     *
+     *  @param  batchSize   number of handles to generate
+     *
+     *  @return a collection of newly generated handles
+     */
+    virtual Handles GenerateHandles(uint32_t batchSize);
+
     /** @brief  Initializes an object for given handle
      *
-     *  Initializes an object for given @p handle and stores it in @p m_objects
+     *  Initializes an object for given @p handle, result is stored in
+     *  @p m_objects by the caller
      *
      *  @return generated object
      */
@@ -161,18 +295,77 @@ protected:
     //! A functor used to deinitialize given handles
     HandleDeleter m_deleter;
 
-    //! An underlying collection of objects associated with handles
-    std::unordered_map<Handle, T> m_objects;
+    //! Densely packed objects associated with handles from @p m_used
+    std::vector<T> m_objects;
 
-    //! A collection of used handles
+    //! Densely packed used handles, @p m_used[i] owns @p m_objects[i]
     Handles m_used;
 
-    //! A queue of generated and unused handles
-    std::queue<Handle> m_available;
+    //! Queue receiving mutating calls made outside of the audio thread
+    CommandQueue* m_pCommands;
 
 private:
-    //! Pushes provided handles to @p m_available
+    //! Index value marking a slot without an object
+    static constexpr uint32_t s_invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    //! Slot map entry describing a single generated handle
+    struct Slot
+    {
+        //! Index in @p m_objects and @p m_used or @p s_invalidIndex
+        uint32_t dense          = s_invalidIndex;
+
+        //! Number of times the handle was reclaimed
+        Generation generation   = 0;
+
+        //! Next handle in the free list
+        Handle nextFree         = Handle();
+
+        //! Index in @p m_references or @p s_invalidIndex
+        uint32_t reference      = s_invalidIndex;
+    };
+
+    //! Reference table entry
+    struct ReferenceEntry
+    {
+        //! Handle of referenced object
+        Handle handle;
+
+        //! Number of times the entry was released plus one
+        Generation generation;
+    };
+
+    //! Registers provided handles and pushes them to the back of the free list
     void PushHandles(Handles const& handles);
+
+    //! Pushes registered handle to the back of the free list
+    void PushHandle(Handle handle);
+
+    //! Pops a handle from the front of the free list
+    Handle PopHandle();
+
+    //! Moves @p handle from the free list to @p m_used creating its object
+    void UseHandle(Handle handle);
+
+    //! Slot map indexed by handle values
+    std::vector<Slot> m_slots;
+
+    //! Guards growth of @p m_slots and generation updates against GetGeneration()
+    mutable std::mutex m_generationMutex;
+
+    //! First handle in the free list
+    Handle m_freeHead;
+
+    //! Last handle in the free list
+    Handle m_freeTail;
+
+    //! Number of generated and unused handles
+    uint32_t m_availableCount;
+
+    //! Stable reference table
+    std::vector<ReferenceEntry> m_references;
+
+    //! Released entries of @p m_references
+    std::vector<uint32_t> m_freeReferences;
 };
 
 }
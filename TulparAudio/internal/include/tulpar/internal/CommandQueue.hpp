@@ -0,0 +1,252 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_COMMAND_QUEUE_HPP
+#define TULPAR_INTERNAL_COMMAND_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Compact deferred call to one of the object controllers */
+struct Command
+{
+    //! Type of deferred call
+    enum class Type : uint8_t
+    {
+        SourceReset
+        , SourcePlay
+        , SourceStop
+        , SourceRewind
+        , SourcePause
+        , SourcesPlay
+        , SourcesStop
+        , SourcesRewind
+        , SourcesPause
+        , SourceStaticBuffer
+        , SourceQueueBuffers
+        , SourceStream
+        , SourceCallback
+        , SourcePlaybackPosition
+        , SourcePlaybackProgress
+        , SourceRelative
+        , SourceLooping
+        , SourcePitch
+        , SourceGain
+        , SourcePosition
+        , SourceVelocity
+        , SourceReferenceDistance
+        , SourceMaxDistance
+        , SourceRolloffFactor
+        , ListenerGain
+        , ListenerPosition
+        , ListenerOrientation
+        , ListenerDistanceModel
+        , BufferReset
+        , VoiceReset
+        , VoiceBuffer
+        , VoicePlay
+        , VoiceStop
+        , VoiceRewind
+        , VoicePause
+        , VoicePlaybackPosition
+        , VoicePriority
+        , VoiceRelative
+        , VoiceLooping
+        , VoicePitch
+        , VoiceGain
+        , VoicePosition
+        , FrameBegin
+        , FrameEnd
+    };
+
+    //! Argument of deferred call
+    union Payload
+    {
+        bool flag;
+        int32_t integer;
+        uint32_t handle;
+        float scalar;
+        int64_t nanoseconds;
+        float vector[6];
+    };
+
+    //! Creates command without arguments
+    static Command Make(Type type, uint32_t handle = 0);
+
+    //! Creates command with flag argument
+    static Command MakeFlag(Type type, uint32_t handle, bool flag);
+
+    //! Creates command with integer argument
+    static Command MakeInteger(Type type, uint32_t handle, int32_t value);
+
+    //! Creates command with handle argument
+    static Command MakeHandle(Type type, uint32_t handle, uint32_t value);
+
+    //! Creates command with scalar argument
+    static Command MakeScalar(Type type, uint32_t handle, float value);
+
+    //! Creates command with time argument
+    static Command MakeTime(Type type, uint32_t handle, std::chrono::nanoseconds value);
+
+    //! Creates command with vector argument of up to 6 components
+    static Command MakeVector(Type type, uint32_t handle, float const* pData, uint32_t size);
+
+    //! Type of deferred call
+    Type type;
+
+    //! Handle of object the call is made on
+    uint32_t handle;
+
+    //! Generation of @p handle at the time of the call, see Collection::GetGeneration()
+    uint32_t generation;
+
+    //! Argument of deferred call
+    Payload payload;
+};
+
+/** @brief  Bounded lock-free multi-producer single-consumer command queue
+ *
+ *  Any number of threads may push commands, only the consumer thread
+ *  may pop them
+ */
+class CommandQueue
+{
+public:
+    /** @brief  Creates empty queue
+     *
+     *  @param  capacity    maximum number of queued commands,
+     *                      rounded up to the power of two
+     */
+    explicit CommandQueue(uint32_t capacity);
+
+    //! Disable copy constructor
+    CommandQueue(CommandQueue const& other) = delete;
+
+    //! Disable assignment operator
+    CommandQueue& operator=(CommandQueue const& other) = delete;
+
+    //! Default destructor
+    ~CommandQueue() = default;
+
+    //! Returns maximum number of queued commands
+    uint32_t GetCapacity() const { return static_cast<uint32_t>(m_mask + 1); }
+
+    /** @brief  Pushes command to the queue
+     *
+     *  @return @c true if command was pushed, @c false if queue is full
+     */
+    bool TryPush(Command const& command);
+
+    /** @brief  Pushes command to the queue
+     *
+     *  Yields until consumer frees a slot if queue is full
+     */
+    void Push(Command const& command);
+
+    /** @brief  Pops oldest command from the queue
+     *
+     *  @attention  shall only be called from consumer thread
+     *
+     *  @return @c true if command was popped, @c false if queue is empty
+     */
+    bool Pop(Command& command);
+
+    //! Sets thread popping commands from the queue
+    void SetConsumerThread(std::thread::id id) { m_consumer = id; }
+
+    //! Returns @c true if calling thread is not the consumer thread
+    bool IsProducerThread() const { return std::this_thread::get_id() != m_consumer; }
+
+    /** @brief  Sets mutex held by the consumer thread while it pops commands
+     *
+     *  @param  pMutex  consumer mutex, @c nullptr if there is none
+     *
+     *  @sa ConsumerLock
+     */
+    void SetConsumerMutex(std::mutex* pMutex) { m_pConsumerMutex = pMutex; }
+
+    //! Returns mutex held by the consumer thread while it pops commands
+    std::mutex* GetConsumerMutex() const { return m_pConsumerMutex; }
+
+private:
+    //! Queue slot
+    struct Cell
+    {
+        //! Position the slot is ready for
+        std::atomic<uint64_t> sequence;
+
+        //! Stored command
+        Command command;
+    };
+
+    //! Queue slots
+    std::unique_ptr<Cell[]> m_cells;
+
+    //! Mask wrapping positions to slot indices
+    uint64_t m_mask;
+
+    //! Consumer thread
+    std::thread::id m_consumer;
+
+    //! Mutex held by consumer thread while it pops commands
+    std::mutex* m_pConsumerMutex;
+
+    //! Position of the next pushed command
+    alignas(64) std::atomic<uint64_t> m_enqueuePosition;
+
+    //! Position of the next popped command
+    alignas(64) uint64_t m_dequeuePosition;
+};
+
+/** @brief  Scoped lock of command queue consumer mutex
+ *
+ *  Lets producer threads read state that the consumer thread modifies
+ *  while applying commands. Lock is not taken on the consumer thread,
+ *  if queue has no consumer mutex, or if calling thread already holds it
+ *  via another ConsumerLock, so nested locks are allowed.
+ *
+ *  @attention  commands shall not be pushed while the lock is held,
+ *              pushing to a full queue would wait for the consumer forever
+ */
+class ConsumerLock
+{
+public:
+    /** @brief  Locks consumer mutex of given queue if needed
+     *
+     *  @param  pQueue  command queue, @c nullptr makes the lock a no-op
+     */
+    explicit ConsumerLock(CommandQueue const* pQueue);
+
+    //! Takes over the lock of @p other
+    ConsumerLock(ConsumerLock&& other) = default;
+
+    //! Disable copy constructor
+    ConsumerLock(ConsumerLock const& other) = delete;
+
+    //! Disable assignment operator
+    ConsumerLock& operator=(ConsumerLock const& other) = delete;
+
+    //! Unlocks consumer mutex if it was locked by this object
+    ~ConsumerLock();
+
+private:
+    //! Lock of consumer mutex, does not own a mutex if locking was not needed
+    std::unique_lock<std::mutex> m_lock;
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_COMMAND_QUEUE_HPP
@@ -9,7 +9,9 @@
 
 #include <tulpar/internal/Device.hpp>
 
+#include <AL/al.h>
 #include <AL/alc.h>
+#include <AL/alext.h>
 
 namespace tulpar
 {
@@ -24,6 +26,24 @@ namespace internal
 class Context
 {
 public:
+    //! Source event types delivered by AL_SOFT_events
+    enum class EventType : uint8_t
+    {
+        SourceStateChanged
+        , BufferCompleted
+    };
+
+    /** @brief  Source event handler
+     *
+     *  @note   Called from OpenAL event thread
+     *
+     *  @param  type        event type
+     *  @param  source      OpenAL source name
+     *  @param  param       new OpenAL source state or number of completed buffers
+     *  @param  pUserData   user data passed to SetEventHandler()
+     */
+    using EventHandler = void (*)(EventType type, ALuint source, ALuint param, void* pUserData);
+
     /** @brief  Create audio context
      *
      *  @param  device  device to be associated with context
@@ -40,9 +60,62 @@ public:
      */
     ~Context();
 
-    /** @brief  Make context object active */
+    /** @brief  Make context object active
+     *
+     *  Loads supported extension functions
+     */
     void MakeCurrent();
 
+    /** @brief  Checks if context supports deferred updates
+     *
+     *  @note   Result is valid after MakeCurrent() call
+     *
+     *  @return @c true if AL_SOFT_deferred_updates is present, @c false otherwise
+     */
+    bool IsDeferringSupported() const { return nullptr != m_alDeferUpdatesSOFT; }
+
+    /** @brief  Checks if context delivers source events
+     *
+     *  @note   Result is valid after MakeCurrent() call
+     *
+     *  @return @c true if AL_SOFT_events is present, @c false otherwise
+     */
+    bool IsEventSupported() const { return m_isEventSupported; }
+
+    /** @brief  Sets handler of source state change and buffer completion events
+     *
+     *  Once this call returns, previous handler is no longer called
+     *
+     *  @note   Has to be called while context is current
+     *
+     *  @param  handler     event handler, @c nullptr to disable events
+     *  @param  pUserData   pointer passed to @p handler
+     *
+     *  @return @c true if events are delivered to @p handler, @c false otherwise
+     */
+    bool SetEventHandler(EventHandler handler, void* pUserData);
+
+    /** @brief  Defers application of source and listener changes
+     *
+     *  Changes made after this call are applied at once by ProcessUpdates().
+     *  Does nothing if deferred updates are not supported.
+     */
+    void DeferUpdates();
+
+    /** @brief  Applies changes deferred since DeferUpdates() call
+     *
+     *  Does nothing if deferred updates are not supported
+     */
+    void ProcessUpdates();
+
+    /** @brief  Reports errors left by unchecked hot path calls
+     *
+     *  Does nothing unless built with TULPAR_HOT_PATH_CHECKS disabled
+     *
+     *  @return @c false if an error was pending, @c true otherwise
+     */
+    bool CheckErrors();
+
 private:
     //! Constructs empty audio context object
     Context();
@@ -63,6 +136,17 @@ private:
      */
     void Deinitialize();
 
+#ifdef AL_SOFT_events
+    //! Forwards OpenAL event to @p m_eventHandler, @p pUserParam is Context
+    static void AL_APIENTRY HandleEvent(ALenum eventType
+        , ALuint object
+        , ALuint param
+        , ALsizei length
+        , ALchar const* pMessage
+        , void* pUserParam
+    );
+#endif
+
     //! Flag indicating if object was initialized successfully
     bool m_isInitialized;
 
@@ -71,6 +155,29 @@ private:
 
     //! Pointer to associated OpenAL device
     ALCdevice* m_pDevice;
+
+    //! AL_SOFT_deferred_updates defer function, @c nullptr if not supported
+    LPALDEFERUPDATESSOFT m_alDeferUpdatesSOFT;
+
+    //! AL_SOFT_deferred_updates process function, @c nullptr if not supported
+    LPALPROCESSUPDATESSOFT m_alProcessUpdatesSOFT;
+
+    //! Flag indicating if AL_SOFT_events is supported
+    bool m_isEventSupported;
+
+    //! Source event handler, @c nullptr if events are disabled
+    EventHandler m_eventHandler;
+
+    //! User data passed to @p m_eventHandler
+    void* m_pEventUserData;
+
+#ifdef AL_SOFT_events
+    //! AL_SOFT_events control function, @c nullptr if not supported
+    LPALEVENTCONTROLSOFT m_alEventControlSOFT;
+
+    //! AL_SOFT_events callback function, @c nullptr if not supported
+    LPALEVENTCALLBACKSOFT m_alEventCallbackSOFT;
+#endif
 };
 
 }
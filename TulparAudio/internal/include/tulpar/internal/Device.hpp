@@ -10,6 +10,10 @@
 #include <tulpar/TulparConfigurator.hpp>
 
 #include <AL/alc.h>
+#include <AL/alext.h>
+
+#include <cstdint>
+#include <vector>
 
 namespace tulpar
 {
@@ -45,19 +49,52 @@ public:
     //! Returns pointer to OpenAL Device object associated with this Device
     ALCdevice* GetOpenALDevice() const { return m_pDevice; }
 
+    //! Returns @c true if device is a loopback device
+    bool IsLoopback() const { return m_isLoopback; }
+
+    //! Returns frequency of rendered samples, @c 0 if device is not a loopback device
+    uint32_t GetFrequencyHz() const { return m_frequencyHz; }
+
+    //! Returns number of rendered channels, @c 0 if device is not a loopback device
+    uint8_t GetChannelCount() const { return m_channelCount; }
+
+    /** @brief  Returns zero terminated context attributes required by device
+     *
+     *  @return attribute list, empty if no attributes are required
+     */
+    std::vector<ALCint> GetContextAttributes() const;
+
+    /** @brief  Renders samples of loopback device
+     *
+     *  @param  pSamples    interleaved 16-bit samples storage of at least
+     *                      @p frameCount * GetChannelCount() elements
+     *  @param  frameCount  number of sample frames to render
+     *
+     *  @return @c true if samples were rendered, @c false otherwise
+     */
+    bool RenderSamples(int16_t* pSamples, uint32_t frameCount);
+
 private:
     //! Constructs empty audio output device object
     Device();
 
     /** @brief  Initializes audio output device object
      *
-     *  Uses given name to open OpenAL device
+     *  Uses given configuration to open OpenAL device
      *
-     *  @param  name    device name
+     *  @param  config  device configuration information
      *
      *  @return @c true if device was initialized successfully, @c false otherwise
      */
-    bool Initialize(std::string const& name);
+    bool Initialize(TulparConfigurator::Device const& config);
+
+    /** @brief  Opens loopback device using ALC_SOFT_loopback
+     *
+     *  @param  config  device configuration information
+     *
+     *  @return @c true if device was opened successfully, @c false otherwise
+     */
+    bool OpenLoopback(TulparConfigurator::Device const& config);
 
     /** @brief  Deinitializes audio output device object
      *
@@ -70,6 +107,18 @@ private:
 
     //! Pointer to associated OpenAL device
     ALCdevice* m_pDevice;
+
+    //! Flag indicating if device is a loopback device
+    bool m_isLoopback;
+
+    //! Frequency of rendered samples
+    uint32_t m_frequencyHz;
+
+    //! Number of rendered channels
+    uint8_t m_channelCount;
+
+    //! Pointer to alcRenderSamplesSOFT
+    LPALCRENDERSAMPLESSOFT m_alcRenderSamplesSOFT;
 };
 
 }
@@ -0,0 +1,140 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_HOT_PATH_HPP
+#define TULPAR_INTERNAL_HOT_PATH_HPP
+
+#include <tulpar/InternalLoggers.hpp>
+
+#include <AL/al.h>
+
+#include <array>
+#include <cmath>
+
+//! Enables OpenAL error polling and debug logging on every hot path call
+#ifndef TULPAR_HOT_PATH_CHECKS
+#define TULPAR_HOT_PATH_CHECKS 1
+#endif
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Compile-time policy for diagnostics on frequently called paths
+ *
+ *  When @p IsChecked is @c false error polling and debug logging compile
+ *  to nothing, leaving the bare OpenAL call. Errors raised in that mode
+ *  are reported once per frame by CheckFrame().
+ *
+ *  @tparam IsChecked   flag indicating if every call is checked
+ */
+template<bool IsChecked>
+    struct HotPathPolicy
+{
+    //! Flag indicating if every call is checked
+    static constexpr bool isChecked = IsChecked;
+
+    /** @brief  Returns OpenAL error state, clearing it
+     *
+     *  @return OpenAL error code, @c AL_NO_ERROR when checks are disabled
+     */
+    static ALenum GetError()
+    {
+        if (isChecked)
+        {
+            return alGetError();
+        }
+        else
+        {
+            return AL_NO_ERROR;
+        }
+    }
+
+    /** @brief  Clears OpenAL error state before a checked call
+     *
+     *  When calls are unchecked a pending error was left by an earlier
+     *  hot path call, so it is reported as CheckFrame() would do instead
+     *  of being silently discarded.
+     *
+     *  @return OpenAL error code left by earlier calls
+     */
+    static ALenum ClearError()
+    {
+        ALenum const alErr = alGetError();
+
+        if (!isChecked)
+        {
+            if (AL_NO_ERROR != alErr)
+            {
+                LOG_AUDIO->Warning("Frame: unchecked call failed: {:#x}", alErr);
+            }
+        }
+
+        return alErr;
+    }
+
+    /** @brief  Logs debug message
+     *
+     *  @param  format  message format
+     *  @param  args    message arguments
+     */
+    template<typename... Args>
+        static void Debug(char const* format, Args const&... args)
+    {
+        if (isChecked)
+        {
+            LOG_AUDIO->Debug(format, args...);
+        }
+    }
+
+    /** @brief  Reports errors left by unchecked calls since last frame
+     *
+     *  @return @c false if an error was pending, @c true otherwise
+     */
+    static bool CheckFrame()
+    {
+        if (isChecked)
+        {
+            return true;
+        }
+        else
+        {
+            ALenum const alErr = alGetError();
+
+            if (AL_NO_ERROR != alErr)
+            {
+                LOG_AUDIO->Warning("Frame: unchecked call failed: {:#x}", alErr);
+            }
+
+            return AL_NO_ERROR == alErr;
+        }
+    }
+};
+
+//! Policy selected by TULPAR_HOT_PATH_CHECKS
+using HotPath = HotPathPolicy<0 != TULPAR_HOT_PATH_CHECKS>;
+
+/** @brief  Checks if given value is accepted by OpenAL for distance, gain and pitch properties
+ *
+ *  Setters validate values up front so that unchecked calls never store
+ *  a value rejected by OpenAL in shadow state
+ */
+inline bool IsValidScalar(float value)
+{
+    return (value >= 0.0f) && std::isfinite(value);
+}
+
+//! Checks if given vector is accepted by OpenAL for position, velocity and orientation properties
+inline bool IsValidVector(std::array<float, 3> const& vec)
+{
+    return std::isfinite(vec[0]) && std::isfinite(vec[1]) && std::isfinite(vec[2]);
+}
+
+}
+}
+
+#endif // TULPAR_INTERNAL_HOT_PATH_HPP
@@ -7,6 +7,8 @@
 #ifndef TULPAR_INTERNAL_LISTENER_COLLECTION_HPP
 #define TULPAR_INTERNAL_LISTENER_COLLECTION_HPP
 
+#include <tulpar/internal/CommandQueue.hpp>
+
 #include <tulpar/audio/Listener.hpp>
 
 #include <mule/asset/Content.hpp>
@@ -24,8 +26,8 @@ class ListenerController
     : public std::enable_shared_from_this<ListenerController>
 {
 public:
-    //! Default constructor
-    ListenerController() = default;
+    //! Constructs controller with OpenAL default listener values
+    ListenerController();
 
     //! Disable copy constructor
     ListenerController(ListenerController const& other) = delete;
@@ -56,6 +58,66 @@ public:
 
     //! Sets listener orientation in space
     bool SetListenerOrientation(audio::Listener::Orientation const& orientation);
+
+    //! Returns distance model
+    audio::Listener::DistanceModel GetListenerDistanceModel() const;
+
+    //! Sets distance model
+    bool SetListenerDistanceModel(audio::Listener::DistanceModel model);
+
+    /** @brief  Applies cached listener values to current context
+     *
+     *  Used to restore listener after switching to a new context
+     *
+     *  @return @c true if values were applied, @c false otherwise
+     */
+    bool ApplyListenerState();
+
+    /** @brief  Sets queue receiving mutating calls made outside of its consumer thread
+     *
+     *  @param  pCommands   command queue, @c nullptr to apply all calls immediately
+     */
+    void SetCommandQueue(CommandQueue* pCommands) { m_pCommands = pCommands; }
+
+private:
+    //! Returns @c true if mutating calls shall be pushed to the command queue
+    bool IsDeferringCommands() const { return (nullptr != m_pCommands) && m_pCommands->IsProducerThread(); }
+
+    /** @brief  Reports mismatch between cached and actual listener property
+     *
+     *  Used only when built with TULPAR_VERIFY_SHADOW_STATE
+     *
+     *  @param  property    property name
+     *  @param  isMatching  result of comparison
+     */
+    void VerifyListenerShadow(char const* property, bool isMatching) const;
+
+    //! Queries listener gain from OpenAL
+    float QueryListenerGain() const;
+
+    //! Queries listener position from OpenAL
+    std::array<float, 3> QueryListenerPosition() const;
+
+    //! Queries listener orientation from OpenAL
+    audio::Listener::Orientation QueryListenerOrientation() const;
+
+    //! Queries distance model from OpenAL
+    audio::Listener::DistanceModel QueryListenerDistanceModel() const;
+
+    //! Cached listener gain
+    float m_gain;
+
+    //! Cached listener position
+    std::array<float, 3> m_position;
+
+    //! Cached listener orientation
+    audio::Listener::Orientation m_orientation;
+
+    //! Cached distance model
+    audio::Listener::DistanceModel m_distanceModel;
+
+    //! Queue receiving mutating calls made outside of the audio thread
+    CommandQueue* m_pCommands;
 };
 
 }
@@ -0,0 +1,91 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_MAPPED_FILE_HPP
+#define TULPAR_INTERNAL_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Read-only memory mapping of a file
+ *
+ *  Content is paged in by the kernel on access and shares page cache with
+ *  other mappings of the same file, so it never gets copied to the heap
+ */
+class MappedFile
+{
+public:
+    /** @brief  Create mapping of given file
+     *
+     *  @param  path    path to the file
+     *
+     *  @return pointer to newly created MappedFile when successful, @c nullptr otherwise
+     *
+     *  @sa Initialize
+     */
+    static MappedFile* Create(std::string const& path);
+
+    //! Disable copy constructor
+    MappedFile(MappedFile const& other) = delete;
+
+    //! Disable assignment operator
+    MappedFile& operator=(MappedFile const& other) = delete;
+
+    /** @brief  Destructs mapping object
+     *
+     *  @sa Deinitialize
+     */
+    ~MappedFile();
+
+    //! Returns path to the mapped file
+    std::string const& GetPath() const { return m_path; }
+
+    //! Returns pointer to mapped content
+    uint8_t const* GetData() const { return m_pData; }
+
+    //! Returns size of mapped content in bytes
+    size_t GetSize() const { return m_size; }
+
+private:
+    //! Constructs empty mapping object
+    MappedFile();
+
+    /** @brief  Initializes mapping object
+     *
+     *  @param  path    path to the file
+     *
+     *  @return @c true if file was mapped successfully, @c false otherwise
+     */
+    bool Initialize(std::string const& path);
+
+    //! Unmaps file
+    void Deinitialize();
+
+    //! Path to the mapped file
+    std::string m_path;
+
+    //! Pointer to mapped content
+    uint8_t const* m_pData;
+
+    //! Size of mapped content in bytes
+    size_t m_size;
+
+#ifdef _WIN32
+    //! Handle of the file mapping object
+    void* m_mapping;
+#endif
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_MAPPED_FILE_HPP
@@ -0,0 +1,132 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_PCM_CACHE_HPP
+#define TULPAR_INTERNAL_PCM_CACHE_HPP
+
+#include <tulpar/internal/PcmData.hpp>
+
+#include <mule/asset/Handler.hpp>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Cache of decoded audio data keyed by asset identity
+ *
+ *  Assets are identified by their content object. Cache keeps a copy of
+ *  asset handle for every entry so that content stays alive while cached.
+ *  Least recently used entries are evicted once total size of decoded data
+ *  exceeds the budget.
+ *
+ *  @note   Thread safe, asynchronous requests look data up from producer
+ *          threads while the audio thread inserts uploaded data
+ */
+class PcmCache
+{
+public:
+    /** @brief  Constructs cache object
+     *
+     *  @param  budget  maximum size of cached data in bytes
+     */
+    explicit PcmCache(uint64_t budget);
+
+    //! Disable copy constructor
+    PcmCache(PcmCache const& other) = delete;
+
+    //! Disable assignment operator
+    PcmCache& operator=(PcmCache const& other) = delete;
+
+    //! Default destructor
+    ~PcmCache() = default;
+
+    //! Returns maximum size of cached data in bytes
+    uint64_t GetBudget() const;
+
+    /** @brief  Sets maximum size of cached data in bytes
+     *
+     *  Evicts entries if new budget is exceeded
+     */
+    void SetBudget(uint64_t budget);
+
+    //! Returns size of cached data in bytes
+    uint64_t GetSize() const;
+
+    //! Returns number of cached entries
+    uint32_t GetEntryCount() const;
+
+    /** @brief  Looks up decoded data for given asset
+     *
+     *  Marks found entry as the most recently used one
+     *
+     *  @param  asset   asset handle
+     *
+     *  @return decoded data if cached, @c nullptr otherwise
+     */
+    std::shared_ptr<PcmData const> Find(mule::asset::Handler const& asset);
+
+    /** @brief  Stores decoded data for given asset
+     *
+     *  Data larger than the budget is not cached
+     *
+     *  @param  asset   asset handle that @p pcm was decoded from
+     *  @param  pcm     decoded data
+     */
+    void Insert(mule::asset::Handler const& asset, std::shared_ptr<PcmData const> pcm);
+
+    //! Removes all entries
+    void Clear();
+
+private:
+    //! Cached data
+    struct Entry
+    {
+        //! Asset handle keeping content alive
+        mule::asset::Handler asset;
+
+        //! Decoded data
+        std::shared_ptr<PcmData const> pcm;
+
+        //! Size of decoded data in bytes
+        uint64_t size;
+    };
+
+    //! Shortcut to entry list type
+    using Entries = std::list<Entry>;
+
+    //! Returns size of given data in bytes
+    static uint64_t GetDataSize(PcmData const& pcm);
+
+    //! Evicts least recently used entries until budget is met, expects @p m_mutex to be locked
+    void Evict();
+
+    //! Guards all members below
+    mutable std::mutex m_mutex;
+
+    //! Maximum size of cached data in bytes
+    uint64_t m_budget;
+
+    //! Size of cached data in bytes
+    uint64_t m_size;
+
+    //! Entries ordered from the most to the least recently used
+    Entries m_entries;
+
+    //! Entry lookup by asset content
+    std::unordered_map<mule::asset::Content const*, Entries::iterator> m_lookup;
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_PCM_CACHE_HPP
@@ -0,0 +1,91 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_PCM_DATA_HPP
+#define TULPAR_INTERNAL_PCM_DATA_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Decoded audio data ready to be uploaded to OpenAL
+ *
+ *  Samples use OpenAL channel order. Data is either owned via @p bytes or
+ *  borrowed from asset content via @p pContent, in which case the asset
+ *  has to outlive the object
+ */
+struct PcmData
+{
+    //! Sample formats
+    enum class Format : uint8_t
+    {
+        UInt8
+        , Int16
+        , Float32
+    };
+
+    //! Returns size of a single sample of given format in bytes
+    static uint32_t GetSampleSize(Format format)
+    {
+        return (Format::UInt8 == format) ? 1 : ((Format::Int16 == format) ? 2 : 4);
+    }
+
+    //! Returns @c true if data is borrowed from asset content
+    bool IsBorrowed() const { return nullptr != pContent; }
+
+    //! Checks if given channel count maps to mono, stereo, quad, 5.1 or 7.1 layout
+    static bool IsLayoutSupported(uint32_t channels)
+    {
+        return (1 == channels) || (2 == channels) || (4 == channels) || (6 == channels) || (8 == channels);
+    }
+
+    //! Returns pointer to interleaved samples
+    void const* GetData() const { return IsBorrowed() ? pContent : bytes.data(); }
+
+    //! Returns size of interleaved samples in bytes
+    uint32_t GetSize() const { return IsBorrowed() ? contentSize : static_cast<uint32_t>(bytes.size()); }
+
+    //! Returns total sample count
+    uint32_t GetSampleCount() const { return GetSize() / GetSampleSize(format); }
+
+    /** @brief  Averages channels of stereo data into mono
+     *
+     *  @param  stereo  data with two channels
+     *
+     *  @return owned mono data
+     */
+    static PcmData DownmixToMono(PcmData const& stereo);
+
+    //! Number of audio channels
+    uint8_t channels                = 0;
+
+    //! Frequency in hz
+    uint32_t frequencyHz            = 0;
+
+    //! Sample format
+    Format format                   = Format::Int16;
+
+    //! Flag indicating if samples were down-mixed from stereo
+    bool isDownmixed                = false;
+
+    //! Interleaved samples of @p format
+    std::vector<uint8_t> bytes      = std::vector<uint8_t>();
+
+    //! Interleaved samples of @p format in asset content, @c nullptr if @p bytes are used
+    uint8_t const* pContent         = nullptr;
+
+    //! Size of samples at @p pContent in bytes
+    uint32_t contentSize            = 0;
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_PCM_DATA_HPP
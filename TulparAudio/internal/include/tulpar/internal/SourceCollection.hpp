@@ -11,13 +11,23 @@
 #include <tulpar/internal/Context.hpp>
 
 #include <tulpar/internal/BufferCollection.hpp>
+#include <tulpar/internal/CommandQueue.hpp>
+#include <tulpar/internal/SourceGrid.hpp>
+#include <tulpar/internal/VorbisStream.hpp>
 
 #include <tulpar/audio/Buffer.hpp>
+#include <tulpar/audio/Listener.hpp>
 #include <tulpar/audio/Source.hpp>
+#include <tulpar/audio/SourceEvent.hpp>
 
 #include <tulpar/TulparAudio.hpp>
 
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -74,14 +84,36 @@ public:
      *  @param  deleter     functor that will be called when releasing
      *                      previously used handle
      */
-    SourceCollection(BufferCollection const& buffers
+    SourceCollection(BufferCollection& buffers
         , Collection<audio::Source>::HandleGenerator generator = OpenAVSourceHandler::Generate
         , Collection<audio::Source>::HandleReclaimer reclaimer = OpenAVSourceHandler::Reclaim
         , Collection<audio::Source>::HandleDeleter deleter = OpenAVSourceHandler::Delete
     );
 
-    /** @brief  Destructs source collection */
-    virtual ~SourceCollection() = default;
+    /** @brief  Destructs source collection
+     *
+     *  Releases buffers owned by streamed and procedural sources
+     */
+    virtual ~SourceCollection();
+
+    /** @brief  Sets stream buffer ring settings
+     *
+     *  Settings are applied to streams bound after this call
+     *
+     *  @param  bufferCount     number of OpenAL buffers queued per stream
+     *  @param  bufferFrames    number of frames decoded into each buffer
+     */
+    void SetStreamSettings(uint32_t bufferCount, uint32_t bufferFrames);
+
+    /** @brief  Checks if OpenAL supports callback buffers
+     *
+     *  Procedural sources bound after this call pull data on OpenAL mixing
+     *  thread if AL_SOFT_callback_buffer is present, otherwise they are fed
+     *  by a ring of buffers refilled during UpdateSourceStreams() calls
+     *
+     *  @note   Has to be called while collection context is current
+     */
+    void QueryCallbackSupport();
 
     /** @brief  Migrates sources from given collection
      *
@@ -146,6 +178,9 @@ public:
     uint32_t GetSourceQueueIndex(SourceHandle source) const;
 
     /** @brief  Queues given collection of audio buffers for given source
+     *
+     *  If commands are deferred, buffers are queued by ApplySourceBind()
+     *  on the consumer thread.
      *
      *  @param  source  valid source handle
      *  @param  buffers collection of buffers
@@ -154,6 +189,120 @@ public:
      */
     bool QueueSourceBuffers(SourceHandle source, std::vector<audio::Buffer> const& buffers);
 
+    /** @brief  Binds Ogg Vorbis stream to given source
+     *
+     *  Instead of decoding the whole asset at once, the source is fed by a
+     *  ring of small buffers that are decoded incrementally during
+     *  UpdateSourceStreams() calls. Any previously associated buffers are
+     *  reset. If commands are deferred, binding is performed by
+     *  ApplySourceBind() on the consumer thread.
+     *
+     *  @note   source has to be stopped or in its initial state
+     *
+     *  @param  source  valid source handle
+     *  @param  asset   asset handle to Ogg Vorbis content
+     *
+     *  @return @c true if stream was bound successfully, @c false otherwise
+     */
+    bool SetSourceStream(SourceHandle source, mule::asset::Handler asset);
+
+    //! Returns @c true if given source is fed by a stream
+    bool IsSourceStreamed(SourceHandle source) const;
+
+    /** @brief  Binds procedural data callback to given source
+     *
+     *  Any previously associated buffers are reset. Callback buffer or
+     *  buffer ring is allocated once here and reused while playing.
+     *  If commands are deferred, binding is performed by ApplySourceBind()
+     *  on the consumer thread.
+     *
+     *  @note   source has to be stopped or in its initial state
+     *
+     *  @param  source      valid source handle
+     *  @param  callback    data callback
+     *  @param  channels    number of interleaved channels
+     *  @param  frequencyHz sample rate
+     *  @param  format      sample format written by @p callback
+     *
+     *  @return @c true if callback was bound successfully, @c false otherwise
+     */
+    bool SetSourceCallback(SourceHandle source
+        , audio::Source::StreamCallback callback
+        , uint8_t channels
+        , uint32_t frequencyHz
+        , audio::Source::SampleFormat format
+    );
+
+    //! Returns @c true if given source is fed by a callback
+    bool IsSourceProcedural(SourceHandle source) const;
+
+    /** @brief  Performs binding deferred by a producer thread
+     *
+     *  @param  source  valid source handle
+     *  @param  bind    bind id carried by the deferred command
+     *
+     *  @return @c true if binding was performed successfully, @c false otherwise
+     */
+    bool ApplySourceBind(SourceHandle source, uint32_t bind);
+
+    //! Drops binding deferred by a producer thread that won't be applied
+    void DiscardSourceBind(uint32_t bind);
+
+    /** @brief  Performs state change of a source batch deferred by a producer thread
+     *
+     *  Sources reset since the batch was deferred are skipped
+     *
+     *  @param  type    one of @c SourcesPlay, @c SourcesStop,
+     *                  @c SourcesRewind or @c SourcesPause command types
+     *  @param  batch   batch id carried by the deferred command
+     *
+     *  @return @c true if state was changed successfully, @c false otherwise
+     */
+    bool ApplySourceBatch(Command::Type type, uint32_t batch);
+
+    /** @brief  Refills processed buffers of all streamed and procedural sources
+     *
+     *  Shall be called periodically, otherwise streamed sources run out of
+     *  queued data and stop
+     */
+    void UpdateSourceStreams();
+
+    /** @brief  Queues source event delivered by OpenAL
+     *
+     *  Matches Context::EventHandler signature
+     *
+     *  @note   Thread safe
+     *
+     *  @param  type        event type
+     *  @param  source      OpenAL source name
+     *  @param  param       new OpenAL source state or number of completed buffers
+     *  @param  pUserData   source collection receiving the event
+     */
+    static void HandleEvent(Context::EventType type, ALuint source, ALuint param, void* pUserData);
+
+    /** @brief  Sets if source state changes are delivered via HandleEvent()
+     *
+     *  @param  isEventDriven   flag indicating if events are delivered,
+     *                          otherwise UpdateSourceEvents() polls sources
+     *                          cached as playing
+     */
+    void SetEventDriven(bool isEventDriven) { m_isEventDriven = isEventDriven; }
+
+    /** @brief  Updates cached source states and collects source events
+     *
+     *  Applies events received by HandleEvent() since last call, each one
+     *  confirmed by a single OpenAL query. Without events only sources
+     *  cached as playing are queried. Streamed sources are handled by
+     *  UpdateSourceStreams().
+     *
+     *  @note   Shall not be called while updates are deferred, as deferred
+     *          state changes are not visible to OpenAL queries
+     */
+    void UpdateSourceEvents();
+
+    //! Moves out events collected since last call
+    std::vector<audio::SourceEvent> ConsumeSourceEvents();
+
     /** @brief  Resets given source
      *
      *  Stops any activities with the source, resets associated buffers and
@@ -215,6 +364,58 @@ public:
      */
     bool PauseSource(SourceHandle source);
 
+    /** @brief  Plays given sources with a single OpenAL call
+     *
+     *  If commands are deferred, sources are passed to ApplySourceBatch()
+     *  by a single command.
+     *
+     *  @param  sources valid source handles
+     *
+     *  @return @c true if sources are now playing, @c false otherwise
+     *
+     *  @sa PlaySource
+     */
+    bool PlaySources(Handles const& sources);
+
+    /** @brief  Stops given sources with a single OpenAL call
+     *
+     *  If commands are deferred, sources are passed to ApplySourceBatch()
+     *  by a single command.
+     *
+     *  @param  sources valid source handles
+     *
+     *  @return @c true if sources were stopped, @c false otherwise
+     *
+     *  @sa StopSource
+     */
+    bool StopSources(Handles const& sources);
+
+    /** @brief  Rewinds given sources with a single OpenAL call
+     *
+     *  If commands are deferred, sources are passed to ApplySourceBatch()
+     *  by a single command.
+     *
+     *  @param  sources valid source handles
+     *
+     *  @return @c true if sources were rewound, @c false otherwise
+     *
+     *  @sa RewindSource
+     */
+    bool RewindSources(Handles const& sources);
+
+    /** @brief  Pauses given sources with a single OpenAL call
+     *
+     *  If commands are deferred, sources are passed to ApplySourceBatch()
+     *  by a single command.
+     *
+     *  @param  sources valid source handles
+     *
+     *  @return @c true if sources are now paused, @c false otherwise
+     *
+     *  @sa PauseSource
+     */
+    bool PauseSources(Handles const& sources);
+
     //! Returns playback queue duration for given source
     std::chrono::nanoseconds GetSourcePlaybackDuration(SourceHandle source) const;
 
@@ -233,6 +434,14 @@ public:
     //! Returns state of given source
     audio::Source::State GetSourceState(SourceHandle source) const;
 
+    /** @brief  Returns cached state of given source without querying OpenAL
+     *
+     *  State reflects calls made through this collection and playback
+     *  completion detected by the latest UpdateSourceEvents() or
+     *  UpdateSourceStreams() call
+     */
+    audio::Source::State GetSourceCachedState(SourceHandle source) const;
+
     //! Returns type of given source
     audio::Source::Type GetSourceType(SourceHandle source) const;
 
@@ -302,23 +511,521 @@ public:
     //! Sets position for given source
     bool SetSourcePosition(SourceHandle source, std::array<float, 3> const& vec);
 
+    //! Returns velocity of given source
+    std::array<float, 3> GetSourceVelocity(SourceHandle source) const;
+
+    //! Sets velocity for given source
+    bool SetSourceVelocity(SourceHandle source, std::array<float, 3> const& vec);
+
+    //! Returns reference distance of given source
+    float GetSourceReferenceDistance(SourceHandle source) const;
+
+    //! Sets reference distance for given source
+    bool SetSourceReferenceDistance(SourceHandle source, float value);
+
+    //! Returns max distance of given source
+    float GetSourceMaxDistance(SourceHandle source) const;
+
+    //! Sets max distance for given source
+    bool SetSourceMaxDistance(SourceHandle source, float value);
+
+    //! Returns rolloff factor of given source
+    float GetSourceRolloffFactor(SourceHandle source) const;
+
+    //! Sets rolloff factor for given source
+    bool SetSourceRolloffFactor(SourceHandle source, float value);
+
+    /** @brief  Sets positions of given sources from structure-of-arrays input
+     *
+     *  The whole batch is validated before any source is changed
+     *
+     *  @note   Callers are expected to defer context updates around the call
+     *
+     *  @param  pSources    valid source handles
+     *  @param  count       number of sources
+     *  @param  pX          x components, one per source
+     *  @param  pY          y components, one per source
+     *  @param  pZ          z components, one per source
+     *
+     *  @return @c true if positions were set, @c false if any component is
+     *          not finite or OpenAL call failed
+     */
+    bool SetSourcesPosition(SourceHandle const* pSources
+        , uint32_t count
+        , float const* pX
+        , float const* pY
+        , float const* pZ
+    );
+
+    //! Sets velocities of given sources, see SetSourcesPosition()
+    bool SetSourcesVelocity(SourceHandle const* pSources
+        , uint32_t count
+        , float const* pX
+        , float const* pY
+        , float const* pZ
+    );
+
+    //! Sets edge length of spatial grid cells used by GetSourcesInRadius()
+    void SetGridCellSize(float cellSize) { m_grid.SetCellSize(cellSize); }
+
+    /** @brief  Collects sources positioned within given sphere
+     *
+     *  Relative sources are not indexed by the grid and are never reported
+     *
+     *  @param  center  sphere center
+     *  @param  radius  sphere radius
+     *  @param  result  collection receiving found source handles
+     */
+    void GetSourcesInRadius(std::array<float, 3> const& center, float radius, Handles& result) const;
+
+    /** @brief  Estimates gain of every source as heard by the listener
+     *
+     *  Evaluates @p distanceModel the way OpenAL does with cached gain,
+     *  position and attenuation properties, without querying OpenAL.
+     *  Cones and listener gain are not applied. Each step is a single loop
+     *  over contiguous per-property values, so it is vectorized by the
+     *  compiler.
+     *
+     *  @param  listenerPosition    listener position
+     *  @param  distanceModel       active distance model
+     *  @param  result              audibility indexed by source handle,
+     *                              values for unused handles are unspecified
+     */
+    void ComputeAudibility(std::array<float, 3> const& listenerPosition
+        , audio::Listener::DistanceModel distanceModel
+        , std::vector<float>& result
+    ) const;
+
+    /** @brief  Estimates gain of given sources as heard by the listener
+     *
+     *  Same as the full pass, but cached properties are gathered only for
+     *  @p pSources, so the cost does not grow with the collection size.
+     *
+     *  @param  listenerPosition    listener position
+     *  @param  distanceModel       active distance model
+     *  @param  pSources            valid source references
+     *  @param  count               number of sources
+     *  @param  pResult             audibility, one per source
+     */
+    void ComputeAudibility(std::array<float, 3> const& listenerPosition
+        , audio::Listener::DistanceModel distanceModel
+        , Reference const* pSources
+        , uint32_t count
+        , float* pResult
+    ) const;
+
+    /** @brief  Pauses inaudible playing sources and resumes audible culled ones
+     *
+     *  Audibility is estimated by ComputeAudibility(). Playing sources
+     *  below @p threshold are paused and keep advancing a playback clock
+     *  scaled by pitch. Culled
+     *  sources are resumed from that clock once their audibility reaches
+     *  @p threshold, or stopped if a non-looping one runs past its end.
+     *  Streamed sources are resumed by seeking their stream to the clock.
+     *  Procedural sources are never culled.
+     *
+     *  Culled sources report @c Playing state and their clock as playback
+     *  position. Any state or position change resumes a culled source first.
+     *
+     *  @param  listenerPosition    listener position
+     *  @param  distanceModel       active distance model
+     *  @param  threshold           minimum audibility, non-positive value
+     *                              resumes all culled sources
+     *  @param  elapsed             time passed since previous call
+     */
+    void CullSources(std::array<float, 3> const& listenerPosition
+        , audio::Listener::DistanceModel distanceModel
+        , float threshold
+        , std::chrono::nanoseconds elapsed
+    );
+
+    //! Returns @c true if given source is paused by CullSources()
+    bool IsSourceCulled(SourceHandle source) const { return m_culledSources.end() != m_culledSources.find(source); }
+
 protected:
     //! Creates a source object associated with this collection and given handle
     virtual audio::Source CreateObject(SourceHandle source) override final;
 
 private:
+    //! Streaming information for sources fed by VorbisStream
+    struct Stream
+    {
+        //! Incremental decoder
+        std::unique_ptr<VorbisStream> decoder;
+
+        //! OpenAL buffers owned by the stream
+        std::vector<BufferHandle> buffers;
+
+        //! Frame counts of buffers queued on the source in queue order
+        std::deque<uint32_t> queuedFrames;
+
+        //! Stream frame that corresponds to the start of the source queue
+        uint32_t queueStartFrame    = 0;
+
+        //! Flag indicating if decoding wraps around at the end of the stream
+        bool isLooping              = false;
+
+        //! Flag indicating if source is expected to be playing
+        bool isPlaying              = false;
+
+        //! Flag indicating if source has to be polled during next update
+        bool isPending              = true;
+    };
+
+    //! Procedural data information for sources fed by a user callback
+    struct CallbackStream
+    {
+        //! User data callback
+        audio::Source::StreamCallback callback;
+
+        //! Number of interleaved channels
+        uint8_t channels                    = 0;
+
+        //! Sample rate
+        uint32_t frequencyHz                = 0;
+
+        //! Sample format written by @p callback
+        audio::Source::SampleFormat sampleFormat = audio::Source::SampleFormat::Int16;
+
+        //! OpenAL buffer format
+        ALenum format                       = AL_NONE;
+
+        //! Size of a single frame in bytes
+        uint32_t frameSize                  = 0;
+
+        //! OpenAL buffers owned by the stream, a single one for callback buffers
+        std::vector<BufferHandle> buffers;
+
+        //! Ring buffers that are not queued on the source
+        std::vector<BufferHandle> freeBuffers;
+
+        //! Flag indicating if data is pulled by OpenAL via AL_SOFT_callback_buffer
+        bool isCallbackBuffer               = false;
+
+        //! Flag indicating if callback reported the end of data
+        bool isDrained                      = false;
+
+        //! Flag indicating if source has to be polled during next update
+        bool isPending                      = true;
+    };
+
+    //! Arguments of a binding deferred to the consumer thread
+    struct PendingBind
+    {
+        //! Kinds of deferred bindings
+        enum class Kind : uint8_t
+        {
+            Queue
+            , Stream
+            , Callback
+        };
+
+        //! Kind of binding
+        Kind kind                           = Kind::Queue;
+
+        //! Buffers to be queued, kept alive until they are queued
+        std::vector<audio::Buffer> buffers;
+
+        //! Asset handle to Ogg Vorbis content of a stream
+        mule::asset::Handler asset;
+
+        //! User data callback
+        audio::Source::StreamCallback callback;
+
+        //! Number of interleaved channels
+        uint8_t channels                    = 0;
+
+        //! Sample rate
+        uint32_t frequencyHz                = 0;
+
+        //! Sample format written by @p callback
+        audio::Source::SampleFormat format  = audio::Source::SampleFormat::Int16;
+    };
+
+    //! Sources of a state change deferred to the consumer thread
+    struct PendingBatch
+    {
+        //! Source handles
+        Handles sources;
+
+        //! Generations of @p sources at the time of the call
+        std::vector<Generation> generations;
+    };
+
+    //! Source event received from OpenAL event thread
+    struct PendingEvent
+    {
+        //! Event type
+        Context::EventType type;
+
+        //! Source handle
+        SourceHandle source;
+
+        //! Generation of @p source when the event was received
+        Generation generation;
+
+        //! New OpenAL source state or number of completed buffers
+        uint32_t param;
+    };
+
+    /** @brief  CPU-side copy of settable source properties
+     *
+     *  Properties are stored per property and indexed by source handle,
+     *  getters read them instead of querying OpenAL
+     */
+    struct ShadowState
+    {
+        //! Pitch values
+        std::vector<float> pitch;
+
+        //! Gain values
+        std::vector<float> gain;
+
+        //! Positions
+        std::vector<std::array<float, 3>> position;
+
+        //! Velocities
+        std::vector<std::array<float, 3>> velocity;
+
+        //! Reference distances
+        std::vector<float> referenceDistance;
+
+        //! Max distances
+        std::vector<float> maxDistance;
+
+        //! Rolloff factors
+        std::vector<float> rolloffFactor;
+
+        //! Relativeness flags
+        std::vector<uint8_t> isRelative;
+
+        //! OpenAL looping flags
+        std::vector<uint8_t> isLooping;
+
+        //! Playback states
+        std::vector<audio::Source::State> state;
+    };
+
     //! Resets meta information for given source
     void ResetSourceMeta(SourceHandle source);
 
+    //! Makes room for given source in #m_shadow initializing it with default values
+    void ReserveSourceShadow(SourceHandle source);
+
+    /** @brief  Reports mismatch between cached and actual source property
+     *
+     *  Used only when built with TULPAR_VERIFY_SHADOW_STATE
+     *
+     *  @param  source      source handle
+     *  @param  property    property name
+     *  @param  isMatching  result of comparison
+     */
+    void VerifySourceShadow(SourceHandle source, char const* property, bool isMatching) const;
+
+    //! Queries relativeness flag from OpenAL
+    bool QuerySourceRelative(SourceHandle source) const;
+
+    //! Queries looping flag from OpenAL
+    bool QuerySourceLooping(SourceHandle source) const;
+
+    //! Queries pitch value from OpenAL
+    float QuerySourcePitch(SourceHandle source) const;
+
+    //! Queries gain value from OpenAL
+    float QuerySourceGain(SourceHandle source) const;
+
+    //! Queries position from OpenAL
+    std::array<float, 3> QuerySourcePosition(SourceHandle source) const;
+
+    //! Queries velocity from OpenAL
+    std::array<float, 3> QuerySourceVelocity(SourceHandle source) const;
+
+    //! Queries reference distance from OpenAL
+    float QuerySourceReferenceDistance(SourceHandle source) const;
+
+    //! Queries max distance from OpenAL
+    float QuerySourceMaxDistance(SourceHandle source) const;
+
+    //! Queries rolloff factor from OpenAL
+    float QuerySourceRolloffFactor(SourceHandle source) const;
+
+    /** @brief  Sets vector property of given sources from structure-of-arrays input
+     *
+     *  @param  type        command type used when deferring commands
+     *  @param  param       OpenAL source property
+     *  @param  action      action name used for logging
+     *  @param  shadow      cached values of the property
+     *  @param  pSources    valid source handles
+     *  @param  count       number of sources
+     *  @param  pX          x components, one per source
+     *  @param  pY          y components, one per source
+     *  @param  pZ          z components, one per source
+     *
+     *  @return @c true if values were set, @c false otherwise
+     */
+    bool SetSourcesVector(Command::Type type
+        , ALenum param
+        , char const* action
+        , std::vector<std::array<float, 3>>& shadow
+        , SourceHandle const* pSources
+        , uint32_t count
+        , float const* pX
+        , float const* pY
+        , float const* pZ
+    );
+
+    /** @brief  Decodes next chunk of the stream into given buffer
+     *
+     *  @param  stream  stream to be decoded
+     *  @param  buffer  buffer owned by @p stream
+     *
+     *  @return @c true if buffer was filled, @c false if stream is over
+     */
+    bool FillStreamBuffer(Stream& stream, BufferHandle buffer);
+
+    /** @brief  Requeues stream buffers of given source from given frame
+     *
+     *  Stops the source, detaches queued buffers, seeks the decoder and
+     *  queues freshly decoded buffers
+     *
+     *  @param  source  streamed source handle
+     *  @param  frame   stream frame to start from
+     *
+     *  @return @c true if buffers were queued successfully, @c false otherwise
+     */
+    bool RestartSourceStream(SourceHandle source, uint32_t frame);
+
+    /** @brief  Moves given streamed source to given frame
+     *
+     *  Preserves playing and paused states
+     *
+     *  @param  source  streamed source handle
+     *  @param  frame   stream frame to continue from
+     *
+     *  @return @c true if stream was moved successfully, @c false otherwise
+     */
+    bool SeekSourceStream(SourceHandle source, uint32_t frame);
+
+    //! Returns current stream frame for given streamed source
+    uint32_t GetSourceStreamFrame(SourceHandle source) const;
+
+    //! Stops given source and releases its stream if any
+    void ReleaseSourceStream(SourceHandle source);
+
+    /** @brief  Fills free ring buffers of given procedural source and queues them
+     *
+     *  Stops pulling data once callback reports the end of data
+     *
+     *  @param  source  procedural source handle
+     *  @param  stream  callback stream of @p source
+     */
+    void FillSourceCallbackQueue(SourceHandle source, CallbackStream& stream);
+
+    //! Returns @c true if given source is fed by a ring of buffers refilled from its callback
+    bool IsSourceBufferRing(SourceHandle source) const;
+
+    /** @brief  Refills ring of given procedural source unless it is playing or paused
+     *
+     *  Detaches queued ring buffers so that OpenAL does not replay old data
+     *  when the source is played again
+     */
+    void RestartSourceCallback(SourceHandle source);
+
+    //! Stops given source and releases its procedural data callback if any
+    void ReleaseSourceCallback(SourceHandle source);
+
+    //! Stores binding deferred to the consumer thread and returns its bind id
+    uint32_t StorePendingBind(PendingBind pending);
+
+    /** @brief  Checks that all given sources are valid
+     *
+     *  @param  sources source handles
+     *  @param  action  state change name used for logging
+     *
+     *  @return @c true if all handles are valid, @c false otherwise
+     */
+    bool AreSourcesValid(Handles const& sources, char const* action) const;
+
+    /** @brief  Defers state change of given sources as a single command
+     *
+     *  @param  type    batch command type
+     *  @param  sources valid source handles
+     */
+    void PushSourceBatch(Command::Type type, Handles const& sources);
+
+#ifdef AL_SOFT_callback_buffer
+    //! Forwards OpenAL data request to CallbackStream passed as @p pUserData
+    static ALsizei AL_APIENTRY HandleBufferCallback(ALvoid* pUserData, ALvoid* pSamples, ALsizei byteCount);
+#endif
+
+    /** @brief  Queries state of given source and updates its cached state
+     *
+     *  Pushes @c Stopped event if cached state was @c Playing
+     */
+    void RefreshSourceState(SourceHandle source);
+
+    /** @brief  Resumes given culled source from its culling clock
+     *
+     *  Does nothing if @p source is not culled
+     */
+    void RestoreCulledSource(SourceHandle source);
+
+    //! Appends event about given source unless event queue is full
+    void PushSourceEvent(audio::SourceEvent::Type type, SourceHandle source, uint32_t count);
+
+    //! Marks static and queued buffers of given source as detached in @p m_buffers
+    void ReleaseSourceBuffers(SourceHandle source);
+
     //! Meta information for initialized source handles
     struct Meta
     {
-        uint32_t activeSampleCount                      = 0;
+        //! Total number of sample frames in active buffers
+        uint32_t activeFrameCount                       = 0;
+
+        //! Total duration of active buffers
         std::chrono::nanoseconds activeTotalDuration    = std::chrono::nanoseconds{0};
+
+        //! Prefix sums of frame counts, i-th value is the first frame of i-th active buffer
+        std::vector<uint32_t> frameStarts               = std::vector<uint32_t>();
+
+        //! Prefix sums of durations in nanoseconds, i-th value is the start time of i-th active buffer
+        std::vector<double> timeStarts                  = std::vector<double>();
+
+        //! Frequencies of active buffers
+        std::vector<uint32_t> frequencies               = std::vector<uint32_t>();
     };
 
+    //! Resets given meta information to describe no active buffers
+    static void ClearMeta(Meta& meta);
+
+    /** @brief  Appends active buffer to given meta information
+     *
+     *  @param  meta        meta information
+     *  @param  frameCount  number of sample frames in buffer
+     *  @param  frequencyHz buffer frequency
+     */
+    static void AppendMeta(Meta& meta, uint32_t frameCount, uint32_t frequencyHz);
+
+    /** @brief  Converts sample frame offset to time using prefix sums
+     *
+     *  @param  meta    meta information
+     *  @param  frame   offset in sample frames from the start of active buffers
+     *
+     *  @return offset in nanoseconds
+     */
+    static double GetMetaTime(Meta const& meta, uint32_t frame);
+
+    /** @brief  Converts time to sample frame offset using prefix sums
+     *
+     *  @param  meta    meta information
+     *  @param  timeNs  offset in nanoseconds from the start of active buffers
+     *
+     *  @return offset in sample frames
+     */
+    static uint32_t GetMetaFrame(Meta const& meta, double timeNs);
+
     //! Buffer collection that process provided buffer handles
-    BufferCollection const& m_buffers;
+    BufferCollection& m_buffers;
 
     //! Collection of static buffer handles associated with sources
     std::unordered_map<SourceHandle, BufferHandle> m_sourceBuffers;
@@ -328,6 +1035,68 @@ private:
 
     //! Collection of meta information for sources
     std::unordered_map<SourceHandle, Meta> m_sourceMeta;
+
+    //! Collection of streams associated with sources
+    std::unordered_map<SourceHandle, Stream> m_sourceStreams;
+
+    //! Collection of procedural data callbacks associated with sources, address is passed to OpenAL
+    std::unordered_map<SourceHandle, std::unique_ptr<CallbackStream>> m_sourceCallbacks;
+
+    //! Mutex guarding @p m_pendingBinds, @p m_pendingBatches and @p m_nextBind
+    std::mutex m_bindMutex;
+
+    //! Bindings deferred by producer threads indexed by bind id
+    std::unordered_map<uint32_t, PendingBind> m_pendingBinds;
+
+    //! State changes of source batches deferred by producer threads indexed by bind id
+    std::unordered_map<uint32_t, PendingBatch> m_pendingBatches;
+
+    //! Id of the next deferred binding
+    uint32_t m_nextBind;
+
+    //! Cached source properties
+    ShadowState m_shadow;
+
+    //! Positions of sources that are not relative
+    SourceGrid m_grid;
+
+    //! Playback clocks of sources paused by CullSources()
+    std::unordered_map<SourceHandle, std::chrono::nanoseconds> m_culledSources;
+
+    //! Audibility computed by CullSources(), kept to reuse storage
+    std::vector<float> m_audibility;
+
+    //! Number of buffers queued per stream
+    uint32_t m_streamBufferCount;
+
+    //! Number of frames decoded into each stream buffer
+    uint32_t m_streamBufferFrames;
+
+    //! Intermediate storage for decoded stream samples
+    std::vector<int16_t> m_streamSamples;
+
+    //! Intermediate storage for procedural samples
+    std::vector<uint8_t> m_callbackSamples;
+
+#ifdef AL_SOFT_callback_buffer
+    //! AL_SOFT_callback_buffer function, @c nullptr if not supported
+    LPALBUFFERCALLBACKSOFT m_alBufferCallbackSOFT;
+#endif
+
+    //! Flag indicating if source state changes are delivered via HandleEvent()
+    bool m_isEventDriven;
+
+    //! Mutex guarding @p m_pendingEvents
+    std::mutex m_eventMutex;
+
+    //! Events received from OpenAL since last UpdateSourceEvents() call
+    std::vector<PendingEvent> m_pendingEvents;
+
+    //! Events being applied by UpdateSourceEvents(), kept to reuse storage
+    std::vector<PendingEvent> m_receivedEvents;
+
+    //! Events collected for the user
+    std::vector<audio::SourceEvent> m_events;
 };
 
 }
@@ -0,0 +1,145 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_SOURCE_GRID_HPP
+#define TULPAR_INTERNAL_SOURCE_GRID_HPP
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Uniform grid of source positions
+ *
+ *  Space is split into cubic cells, only occupied cells are stored.
+ *  Entries are indexed by source handle, moving an entry within its cell
+ *  only updates its position.
+ *
+ *  @note   Not thread safe
+ */
+class SourceGrid
+{
+public:
+    //! Shortcut to source handle type
+    using Handle = uint32_t;
+
+    /** @brief  Constructs empty grid
+     *
+     *  @param  cellSize    edge length of a cell, has to be positive
+     */
+    explicit SourceGrid(float cellSize);
+
+    //! Disable copy constructor
+    SourceGrid(SourceGrid const& other) = delete;
+
+    //! Disable assignment operator
+    SourceGrid& operator=(SourceGrid const& other) = delete;
+
+    //! Default destructor
+    ~SourceGrid() = default;
+
+    //! Returns edge length of a cell
+    float GetCellSize() const { return m_cellSize; }
+
+    /** @brief  Sets edge length of a cell
+     *
+     *  Reinserts all entries
+     *
+     *  @param  cellSize    edge length of a cell, has to be positive
+     */
+    void SetCellSize(float cellSize);
+
+    //! Returns number of stored entries
+    uint32_t GetEntryCount() const { return m_entryCount; }
+
+    //! Returns @c true if given handle is stored
+    bool Contains(Handle handle) const;
+
+    /** @brief  Inserts given handle or moves it to given position
+     *
+     *  @param  handle      source handle
+     *  @param  position    source position
+     */
+    void Update(Handle handle, std::array<float, 3> const& position);
+
+    //! Removes given handle if it is stored
+    void Remove(Handle handle);
+
+    /** @brief  Collects handles positioned within given sphere
+     *
+     *  Visits cells overlapping the bounding box of the sphere, or all
+     *  occupied cells if there are fewer of them
+     *
+     *  @param  center  sphere center
+     *  @param  radius  sphere radius
+     *  @param  result  collection receiving found handles
+     */
+    void Query(std::array<float, 3> const& center, float radius, std::vector<Handle>& result) const;
+
+private:
+    //! Packed cell coordinates
+    using CellKey = uint64_t;
+
+    //! Grid information about a single handle
+    struct Entry
+    {
+        //! Position
+        std::array<float, 3> position   = {{ 0.0f, 0.0f, 0.0f }};
+
+        //! Cell the handle is stored in
+        CellKey cell                    = 0;
+
+        //! Index of the handle in its cell
+        uint32_t index                  = 0;
+
+        //! Flag indicating if the handle is stored
+        bool isStored                   = false;
+    };
+
+    //! Returns coordinates of a cell containing given position
+    std::array<int32_t, 3> GetCellCoordinates(std::array<float, 3> const& position) const;
+
+    //! Packs cell coordinates into a key
+    static CellKey MakeCellKey(std::array<int32_t, 3> const& coordinates);
+
+    //! Unpacks cell coordinates from a key
+    static std::array<int32_t, 3> GetKeyCoordinates(CellKey key);
+
+    //! Appends handles of given cell positioned within given sphere
+    void QueryCell(std::vector<Handle> const& cell
+        , std::array<float, 3> const& center
+        , float radiusSq
+        , std::vector<Handle>& result
+    ) const;
+
+    //! Stores given handle in given cell
+    void Insert(Handle handle, CellKey cell);
+
+    //! Removes given handle from its cell
+    void Erase(Handle handle);
+
+    //! Edge length of a cell
+    float m_cellSize;
+
+    //! Number of stored entries
+    uint32_t m_entryCount;
+
+    //! Entries indexed by handle
+    std::vector<Entry> m_entries;
+
+    //! Handles stored in occupied cells
+    std::unordered_map<CellKey, std::vector<Handle>> m_cells;
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_SOURCE_GRID_HPP
@@ -0,0 +1,325 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_VOICE_COLLECTION_HPP
+#define TULPAR_INTERNAL_VOICE_COLLECTION_HPP
+
+#include <tulpar/internal/Collection.hpp>
+#include <tulpar/internal/CommandQueue.hpp>
+#include <tulpar/internal/ListenerController.hpp>
+#include <tulpar/internal/SourceCollection.hpp>
+
+#include <tulpar/audio/Buffer.hpp>
+#include <tulpar/audio/Source.hpp>
+#include <tulpar/audio/Voice.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Contains basic voice id operations */
+namespace VirtualVoiceHandler
+{
+    /** @brief  Resets given handle
+     *
+     *  @note   Does nothing at the moment
+     *
+     *  @param  handle  valid voice handle
+     */
+    void Reclaim(Collection<audio::Voice>::Handle handle);
+
+    /** @brief  Releases given collection of handles
+     *
+     *  @note   Does nothing at the moment
+     *
+     *  @param  handles collection of valid voice handles
+     */
+    void Delete(Collection<audio::Voice>::Handles const& handles);
+}
+
+/** @brief  Collection working with virtual voices
+ *
+ *  Keeps a pool of real sources spawned from SourceCollection, no more than
+ *  the voice limit. Every update playing voices are ranked by priority and
+ *  audibility, and the top ones are bound to real sources while the rest
+ *  are virtualized.
+ */
+class VoiceCollection
+    : public Collection<audio::Voice>
+{
+public:
+    //! Shortcut to voice handle type
+    using Handle = audio::Voice::Handle;
+
+    /** @brief  Constructs voice collection object
+     *
+     *  Voices are not backed by OpenAL objects, handles are generated
+     *  sequentially by the collection
+     *
+     *  @param  sources     source collection used to spawn real sources
+     *  @param  listener    listener controller used to estimate audibility
+     *  @param  reclaimer   functor that will be called when reclaiming
+     *                      previously used handle
+     *  @param  deleter     functor that will be called when releasing
+     *                      previously used handle
+     */
+    VoiceCollection(SourceCollection& sources
+        , ListenerController const& listener
+        , Collection<audio::Voice>::HandleReclaimer reclaimer = VirtualVoiceHandler::Reclaim
+        , Collection<audio::Voice>::HandleDeleter deleter = VirtualVoiceHandler::Delete
+    );
+
+    /** @brief  Destructs voice collection
+     *
+     *  Resets all real sources spawned by the collection
+     */
+    virtual ~VoiceCollection();
+
+    /** @brief  Sets source collection used to spawn real sources
+     *
+     *  @note   Real sources already spawned have to be migrated to
+     *          @p sources prior to calling this method
+     *
+     *  @param  sources source collection
+     */
+    void SetSourceCollection(SourceCollection& sources) { m_pSources = &sources; }
+
+    //! Returns maximum number of real sources used by voices
+    uint32_t GetVoiceLimit() const { return m_voiceLimit; }
+
+    /** @brief  Sets maximum number of real sources used by voices
+     *
+     *  Excess voices are virtualized on the next UpdateVoices() call
+     *
+     *  @param  limit   maximum number of real sources
+     */
+    void SetVoiceLimit(uint32_t limit);
+
+    //! Returns number of voices bound to real sources
+    uint32_t GetRealVoiceCount() const;
+
+    /** @brief  Advances virtual voices and rebinds real sources
+     *
+     *  Virtual voices advance their playback clock by @p elapsed, finished
+     *  voices are stopped and real sources are rebound to the most important
+     *  playing voices
+     *
+     *  @param  elapsed time passed since previous update
+     */
+    void UpdateVoices(std::chrono::nanoseconds elapsed);
+
+    //! Returns buffer associated with given voice
+    audio::Buffer GetVoiceBuffer(Handle voice) const;
+
+    //! Sets buffer for given voice
+    bool SetVoiceBuffer(Handle voice, audio::Buffer buffer);
+
+    //! Resets given voice
+    void ResetVoice(Handle voice);
+
+    //! Starts playing given voice, binding it if a real source is available
+    bool PlayVoice(Handle voice);
+
+    //! Stops given voice
+    bool StopVoice(Handle voice);
+
+    //! Stops given voice and rewinds it back to start
+    bool RewindVoice(Handle voice);
+
+    //! Pauses given voice releasing its real source
+    bool PauseVoice(Handle voice);
+
+    //! Returns state of given voice
+    audio::Source::State GetVoiceState(Handle voice) const;
+
+    //! Returns playback duration of given voice
+    std::chrono::nanoseconds GetVoicePlaybackDuration(Handle voice) const;
+
+    //! Returns playback position of given voice
+    std::chrono::nanoseconds GetVoicePlaybackPosition(Handle voice) const;
+
+    //! Sets playback position of given voice
+    bool SetVoicePlaybackPosition(Handle voice, std::chrono::nanoseconds offset);
+
+    //! Returns priority of given voice
+    int32_t GetVoicePriority(Handle voice) const;
+
+    //! Sets priority of given voice
+    void SetVoicePriority(Handle voice, int32_t value);
+
+    /** @brief  Returns audibility estimate of given voice
+     *
+     *  Audibility is the voice gain attenuated by inverse distance to the
+     *  listener, distances closer than 1 are not attenuated
+     *
+     *  @param  voice   valid voice handle
+     *
+     *  @return audibility estimate
+     */
+    float GetVoiceAudibility(Handle voice) const;
+
+    //! Returns @c true if given voice is not bound to a real source
+    bool IsVoiceVirtual(Handle voice) const;
+
+    //! Returns relativeness flag of given voice
+    bool IsVoiceRelative(Handle voice) const;
+
+    //! Sets relativeness flag of given voice
+    bool SetVoiceRelative(Handle voice, bool flag);
+
+    //! Returns looping flag of given voice
+    bool IsVoiceLooping(Handle voice) const;
+
+    //! Sets looping flag of given voice
+    bool SetVoiceLooping(Handle voice, bool flag);
+
+    //! Returns pitch of given voice
+    float GetVoicePitch(Handle voice) const;
+
+    //! Sets pitch of given voice
+    bool SetVoicePitch(Handle voice, float value);
+
+    //! Returns gain of given voice
+    float GetVoiceGain(Handle voice) const;
+
+    //! Sets gain of given voice
+    bool SetVoiceGain(Handle voice, float value);
+
+    //! Returns position of given voice
+    std::array<float, 3> GetVoicePosition(Handle voice) const;
+
+    //! Sets position of given voice
+    bool SetVoicePosition(Handle voice, std::array<float, 3> const& vec);
+
+protected:
+    //! Creates a voice object associated with this collection and given handle
+    virtual audio::Voice CreateObject(Handle voice) override final;
+
+    //! Generates sequential voice handles starting from 0
+    virtual Handles GenerateHandles(uint32_t batchSize) override final;
+
+private:
+    //! Information stored for every voice
+    struct VoiceInfo
+    {
+        //! Associated buffer
+        audio::Buffer buffer            = audio::Buffer();
+
+        //! Real source, invalid if voice is virtual
+        audio::Source source            = audio::Source();
+
+        //! Playback state
+        audio::Source::State state      = audio::Source::State::Initial;
+
+        //! Playback clock of virtual voice
+        std::chrono::nanoseconds clock  = std::chrono::nanoseconds{0};
+
+        //! Duration of associated buffer, cached when buffer is set or voice is played
+        std::chrono::nanoseconds duration = std::chrono::nanoseconds{0};
+
+        //! Priority
+        int32_t priority                = 0;
+
+        //! Pitch value
+        float pitch                     = 1.0f;
+
+        //! Gain value
+        float gain                      = 1.0f;
+
+        //! Position
+        std::array<float, 3> position   = {{ 0.0f, 0.0f, 0.0f }};
+
+        //! Relativeness flag
+        bool isRelative                 = false;
+
+        //! Looping flag
+        bool isLooping                  = false;
+    };
+
+    //! Playing voice competing for a real source
+    struct Candidate
+    {
+        //! Voice handle
+        Handle voice;
+
+        //! Voice information
+        VoiceInfo* pInfo;
+
+        //! Voice priority
+        int32_t priority;
+
+        //! Voice audibility estimate
+        float audibility;
+    };
+
+    /** @brief  Binds given voice to a real source
+     *
+     *  Applies voice properties and starts playback from the voice clock
+     *
+     *  @param  voice   valid virtual voice handle
+     *
+     *  @return @c true if voice was bound, @c false if no source is available
+     */
+    bool BindVoice(Handle voice);
+
+    /** @brief  Releases real source of given voice
+     *
+     *  @param  voice       valid voice handle
+     *  @param  saveClock   flag indicating if playback position of the real
+     *                      source shall be stored in the voice clock
+     */
+    void UnbindVoice(Handle voice, bool saveClock);
+
+    //! Returns a free real source spawning one if limit allows, invalid source otherwise
+    audio::Source AcquireSource();
+
+    /** @brief  Computes audibility estimate for given voice information
+     *
+     *  Unlike SourceCollection::ComputeAudibility() it does not evaluate
+     *  the listener distance model. Voices have no attenuation properties
+     *  and sources bound to them keep OpenAL defaults, with which the
+     *  default inverse clamped model reduces to the estimate used here.
+     *  It is computed per voice since virtual voices have no source
+     *  shadow state to batch over, and only ranks voices among themselves.
+     */
+    float ComputeAudibility(VoiceInfo const& info) const;
+
+    //! Source collection used to spawn real sources
+    SourceCollection* m_pSources;
+
+    //! Listener controller used to estimate audibility
+    ListenerController const& m_listener;
+
+    //! Maximum number of real sources
+    uint32_t m_voiceLimit;
+
+    //! Real sources that are not bound to any voice
+    std::vector<audio::Source> m_freeSources;
+
+    //! Number of voices bound to real sources
+    uint32_t m_realVoiceCount;
+
+    //! Handle of the next generated voice
+    Handle m_nextHandle;
+
+    //! Collection of voice information
+    std::unordered_map<Handle, VoiceInfo> m_voiceInfo;
+
+    //! Voices ranked by UpdateVoices(), kept to reuse its storage
+    std::vector<Candidate> m_candidates;
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_VOICE_COLLECTION_HPP
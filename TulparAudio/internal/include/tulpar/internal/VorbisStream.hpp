@@ -0,0 +1,131 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_VORBIS_STREAM_HPP
+#define TULPAR_INTERNAL_VORBIS_STREAM_HPP
+
+#include <mule/asset/Handler.hpp>
+
+#include <cstdint>
+
+struct stb_vorbis;
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Incremental Ogg Vorbis decoder
+ *
+ *  Decodes audio content in chunks instead of decoding the whole stream at
+ *  once, so that only a small portion of PCM data has to be resident
+ */
+class VorbisStream
+{
+public:
+    //! Constructs closed stream object
+    VorbisStream();
+
+    //! Disable copy constructor
+    VorbisStream(VorbisStream const& other) = delete;
+
+    //! Disable assignment operator
+    VorbisStream& operator=(VorbisStream const& other) = delete;
+
+    /** @brief  Destructs stream object
+     *
+     *  @sa Close
+     */
+    ~VorbisStream();
+
+    /** @brief  Opens given asset for decoding
+     *
+     *  Stream keeps a copy of @p asset so that compressed data stays alive
+     *  while the stream is open
+     *
+     *  @param  asset   asset handle to Ogg Vorbis content
+     *
+     *  @return @c true if stream was opened successfully, @c false otherwise
+     */
+    bool Open(mule::asset::Handler asset);
+
+    //! Closes stream releasing decoder resources
+    void Close();
+
+    //! Returns @c true if stream is open
+    bool IsOpen() const { return nullptr != m_pVorbis; }
+
+    //! Returns asset associated with the stream
+    mule::asset::Handler GetAsset() const { return m_asset; }
+
+    //! Returns number of audio channels
+    uint8_t GetChannelCount() const { return m_channels; }
+
+    //! Returns frequency in hz
+    uint32_t GetFrequencyHz() const { return m_frequencyHz; }
+
+    //! Returns total number of frames (samples per channel)
+    uint32_t GetFrameCount() const { return m_frameCount; }
+
+    //! Returns index of the next frame to be decoded
+    uint32_t GetFrameOffset() const { return m_frameOffset; }
+
+    /** @brief  Moves decoding position to given frame
+     *
+     *  @param  frame   frame index
+     *
+     *  @return @c true if position was changed, @c false otherwise
+     */
+    bool Seek(uint32_t frame);
+
+    /** @brief  Reorders interleaved samples from Vorbis to OpenAL channel order
+     *
+     *  Vorbis places center channel before the right one and LFE last in
+     *  5.1 and 7.1 layouts, other layouts already match OpenAL order
+     *
+     *  @param  pSamples    interleaved samples
+     *  @param  frameCount  number of frames in @p pSamples
+     *  @param  channels    number of audio channels
+     */
+    template<typename T>
+        static void ReorderChannels(T* pSamples, uint32_t frameCount, uint32_t channels);
+
+    /** @brief  Decodes next frames as interleaved 16-bit samples
+     *
+     *  Samples use OpenAL channel order
+     *
+     *  @param  pSamples    output buffer capable of holding
+     *                      @p frameCount * GetChannelCount() samples
+     *  @param  frameCount  maximum number of frames to decode
+     *
+     *  @return number of decoded frames, @c 0 if stream is over
+     */
+    uint32_t Decode(int16_t* pSamples, uint32_t frameCount);
+
+private:
+    //! Asset holding compressed data
+    mule::asset::Handler m_asset;
+
+    //! Underlying decoder
+    stb_vorbis* m_pVorbis;
+
+    //! Number of audio channels
+    uint8_t m_channels;
+
+    //! Frequency in hz
+    uint32_t m_frequencyHz;
+
+    //! Total frame count
+    uint32_t m_frameCount;
+
+    //! Index of the next frame to be decoded
+    uint32_t m_frameOffset;
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_VORBIS_STREAM_HPP
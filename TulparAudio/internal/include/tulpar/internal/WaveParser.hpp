@@ -0,0 +1,52 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_WAVE_PARSER_HPP
+#define TULPAR_INTERNAL_WAVE_PARSER_HPP
+
+#include <tulpar/internal/PcmData.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Contains RIFF/WAVE parsing operations */
+namespace WaveParser
+{
+    /** @brief  Checks if given data starts with RIFF/WAVE header
+     *
+     *  @param  pData   data to check
+     *  @param  size    size of @p pData in bytes
+     *
+     *  @return @c true if data looks like RIFF/WAVE content
+     */
+    bool IsWave(uint8_t const* pData, size_t size);
+
+    /** @brief  Parses RIFF/WAVE data
+     *
+     *  Supports 8-bit PCM, 16-bit PCM and 32-bit IEEE float data in mono,
+     *  stereo, quad, 5.1 and 7.1 layouts, including WAVE_FORMAT_EXTENSIBLE
+     *  headers. Samples are not copied, @p pcm borrows them from @p pData.
+     *
+     *  @note   Thread safe, does not call OpenAL
+     *
+     *  @param  pData   RIFF/WAVE data that has to outlive @p pcm
+     *  @param  size    size of @p pData in bytes
+     *  @param  pcm     parsed data
+     *
+     *  @return @c true if data was parsed successfully, @c false otherwise
+     */
+    bool Parse(uint8_t const* pData, size_t size, PcmData& pcm);
+}
+
+}
+}
+
+#endif // TULPAR_INTERNAL_WAVE_PARSER_HPP
@@ -0,0 +1,82 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_INTERNAL_WORKER_POOL_HPP
+#define TULPAR_INTERNAL_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace tulpar
+{
+namespace internal
+{
+
+/** @brief  Fixed size pool of worker threads executing submitted jobs
+ *
+ *  Jobs are executed in submission order by the first available worker.
+ *  Jobs shall not call OpenAL since workers do not own any context.
+ */
+class WorkerPool
+{
+public:
+    //! Shortcut to job type
+    using Job = std::function<void()>;
+
+    /** @brief  Creates worker pool and starts worker threads
+     *
+     *  @param  threadCount number of worker threads, if @c 0 then number of
+     *                      hardware threads is used
+     */
+    explicit WorkerPool(uint32_t threadCount);
+
+    //! Disable copy constructor
+    WorkerPool(WorkerPool const& other) = delete;
+
+    //! Disable assignment operator
+    WorkerPool& operator=(WorkerPool const& other) = delete;
+
+    /** @brief  Destructs worker pool
+     *
+     *  Finishes all submitted jobs and joins worker threads
+     */
+    ~WorkerPool();
+
+    //! Returns number of worker threads
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+
+    //! Queues given job for execution
+    void Submit(Job job);
+
+private:
+    //! Worker thread routine
+    void Run();
+
+    //! Worker threads
+    std::vector<std::thread> m_threads;
+
+    //! Mutex guarding @p m_jobs and @p m_isRunning
+    std::mutex m_mutex;
+
+    //! Condition signaled when a job is submitted or pool is stopped
+    std::condition_variable m_condition;
+
+    //! Queue of submitted jobs
+    std::queue<Job> m_jobs;
+
+    //! Flag indicating if workers shall keep waiting for jobs
+    bool m_isRunning;
+};
+
+}
+}
+
+#endif // TULPAR_INTERNAL_WORKER_POOL_HPP
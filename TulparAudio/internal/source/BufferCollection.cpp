@@ -5,15 +5,67 @@
 */
 
 #include <tulpar/internal/BufferCollection.hpp>
+#include <tulpar/internal/HotPath.hpp>
+#include <tulpar/internal/MappedFile.hpp>
+#include <tulpar/internal/VorbisStream.hpp>
+#include <tulpar/internal/WaveParser.hpp>
 
 #include <tulpar/InternalLoggers.hpp>
+#include <tulpar/Kernels.hpp>
 
 #include <AL/al.h>
+#include <AL/alext.h>
 
 #undef STB_VORBIS_HEADER_ONLY
 #include <stb_vorbis.c>
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+//! OpenAL formats of a channel layout indexed by PcmData::Format
+struct LayoutFormats
+{
+    //! Number of audio channels
+    uint8_t channels;
+
+    //! Formats for 8-bit, 16-bit and 32-bit float samples
+    ALenum formats[3];
+};
+
+//! Supported channel layouts
+LayoutFormats const s_layoutFormats[] = {
+    { 1, { AL_FORMAT_MONO8, AL_FORMAT_MONO16, AL_FORMAT_MONO_FLOAT32 } }
+    , { 2, { AL_FORMAT_STEREO8, AL_FORMAT_STEREO16, AL_FORMAT_STEREO_FLOAT32 } }
+    , { 4, { AL_FORMAT_QUAD8, AL_FORMAT_QUAD16, AL_FORMAT_QUAD32 } }
+    , { 6, { AL_FORMAT_51CHN8, AL_FORMAT_51CHN16, AL_FORMAT_51CHN32 } }
+    , { 8, { AL_FORMAT_71CHN8, AL_FORMAT_71CHN16, AL_FORMAT_71CHN32 } }
+};
+
+/** @brief  Converts 32-bit float samples to 16-bit samples
+ *
+ *  @param  pcm decoded data of @c Float32 format
+ *
+ *  @return converted samples
+ */
+std::vector<int16_t> ConvertFloatSamples(tulpar::internal::PcmData const& pcm)
+{
+    uint32_t const sampleCount = pcm.GetSampleCount();
+    float const* pSamples = static_cast<float const*>(pcm.GetData());
+
+    std::vector<int16_t> result(sampleCount);
+
+    tulpar::kernels::ConvertFloatToInt16(pSamples, result.data(), sampleCount);
+
+    return result;
+}
+
+}
 
 namespace tulpar
 {
@@ -30,7 +82,7 @@ Collection<audio::Buffer>::Handles OpenAVBufferHandler::Generate(uint32_t batchS
     ALuint* alBuffers = new ALuint[batchSize];
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     alGenBuffers(batchSize, alBuffers);
 
@@ -78,7 +130,7 @@ void OpenAVBufferHandler::Delete(Collection<audio::Buffer>::Handles const& handl
     );
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     alDeleteBuffers(handles.size(), alBuffers);
 
@@ -98,13 +150,114 @@ BufferCollection::BufferCollection(
     , Collection<audio::Buffer>::HandleDeleter deleter
 )
     : Collection<audio::Buffer>(generator, reclaimer, deleter)
+    , m_workerPool(nullptr)
+    , m_pcmCache(nullptr)
+    , m_inFlightCount(0)
+    , m_isFloatSupported(false)
+    , m_isMultiChannelSupported(false)
+    , m_isStereoDownmixed(false)
+    , m_budget(0)
+    , m_residentSize(0)
 {
 
 }
 
 BufferCollection::~BufferCollection()
 {
+    std::unique_lock<std::mutex> lock(m_pendingMutex);
+
+    m_pendingCondition.wait(lock, [this]() -> bool { return 0 == m_inFlightCount; });
+
+    for (std::shared_ptr<PendingData>& pending : m_decoded)
+    {
+        CompleteData(*pending, false);
+    }
+}
+
+void BufferCollection::QueryFormatSupport()
+{
+    m_isFloatSupported = (AL_TRUE == alIsExtensionPresent("AL_EXT_FLOAT32"));
+    m_isMultiChannelSupported = (AL_TRUE == alIsExtensionPresent("AL_EXT_MCFORMATS"));
+
+    LOG_AUDIO->Debug("Buffers: float formats: {}; multi-channel formats: {}", m_isFloatSupported, m_isMultiChannelSupported);
+}
+
+ALenum BufferCollection::GetFormat(PcmData::Format format, uint8_t channels) const
+{
+    if ((PcmData::Format::Float32 == format && !m_isFloatSupported)
+        || (channels > 2 && !m_isMultiChannelSupported))
+    {
+        return AL_NONE;
+    }
+
+    for (LayoutFormats const& layout : s_layoutFormats)
+    {
+        if (channels == layout.channels)
+        {
+            return layout.formats[static_cast<uint8_t>(format)];
+        }
+    }
+
+    return AL_NONE;
+}
+
+void BufferCollection::SetBudget(uint64_t budget)
+{
+    m_budget = budget;
+
+    EvictBuffers();
+}
+
+bool BufferCollection::AcquireBuffer(Handle handle)
+{
+    auto infoIt = m_bufferInfo.find(handle);
+
+    if (0 == handle || m_bufferInfo.end() == infoIt)
+    {
+        return true;
+    }
+
+    ++infoIt->second.useCount;
+
+    if (infoIt->second.isEvicted && !ReloadBuffer(handle))
+    {
+        LOG_AUDIO->Warning("Buffer #{}: failed to reload evicted data", handle);
+
+        --m_bufferInfo.at(handle).useCount;
+
+        return false;
+    }
+
+    BufferInfo& info = m_bufferInfo.at(handle);
+
+    if (info.isResident)
+    {
+        m_residentBuffers.splice(m_residentBuffers.begin(), m_residentBuffers, info.residentIt);
+    }
+
+    return true;
+}
+
+void BufferCollection::ReleaseBuffer(Handle handle)
+{
+    auto infoIt = m_bufferInfo.find(handle);
 
+    // buffer might have been reset while attached
+    if (0 == handle || m_bufferInfo.end() == infoIt || 0 == infoIt->second.useCount)
+    {
+        return;
+    }
+
+    BufferInfo& info = infoIt->second;
+
+    --info.useCount;
+
+    if (info.isResident)
+    {
+        m_residentBuffers.splice(m_residentBuffers.begin(), m_residentBuffers, info.residentIt);
+    }
+
+    EvictBuffers();
 }
 
 BufferCollection::MigrationMapping BufferCollection::InheritCollection(BufferCollection const& other)
@@ -125,19 +278,41 @@ BufferCollection::MigrationMapping BufferCollection::InheritCollection(BufferCol
             Handle newHandle = batch[i++];
 
             {
-                audio::Buffer const& oldObject = other.m_objects.at(oldHandle);
+                audio::Buffer const& oldObject = other.GetObject(oldHandle);
                 *(oldObject.m_pParent) = this;
                 *(oldObject.m_handle) = newHandle;
 
-                audio::Buffer& newObject = m_objects.at(newHandle);
+                audio::Buffer& newObject = GetObject(newHandle);
                 newObject = oldObject;
             }
 
             mapping[oldHandle] = newHandle;
 
-            SetBufferData(newHandle, other.m_bufferInfo.at(oldHandle).asset);
-            SetBufferName(newHandle, other.m_bufferInfo.at(oldHandle).name);
+            BufferInfo const& info = other.m_bufferInfo.at(oldHandle);
+
+            audio::Buffer::Downmix const downmix = info.isMono ? audio::Buffer::Downmix::Mono : audio::Buffer::Downmix::Keep;
+
+            if (info.isEvicted)
+            {
+                // evicted data is reloaded on next use
+                BufferInfo& newInfo = m_bufferInfo[newHandle];
+
+                newInfo = info;
+                newInfo.useCount = 0;
+            }
+            else if (info.path.empty())
+            {
+                SetBufferData(newHandle, info.asset, downmix);
+            }
+            else
+            {
+                SetBufferFile(newHandle, info.path, downmix);
+            }
+
+            SetBufferName(newHandle, info.name);
         }
+
+        InheritReferences(other, old, batch);
     }
 
     return mapping;
@@ -145,6 +320,8 @@ BufferCollection::MigrationMapping BufferCollection::InheritCollection(BufferCol
 
 std::string BufferCollection::GetBufferName(Handle handle) const
 {
+    ConsumerLock lock(m_pCommands);
+
     auto infoIt = m_bufferInfo.find(handle);
 
     return ((m_bufferInfo.cend() != infoIt) ? infoIt->second.name : std::string());
@@ -152,6 +329,8 @@ std::string BufferCollection::GetBufferName(Handle handle) const
 
 void BufferCollection::SetBufferName(Handle handle, std::string const& name)
 {
+    ConsumerLock lock(m_pCommands);
+
     m_bufferInfo[handle].name = name;
 
     LOG_AUDIO->Debug("Buffer #{}: name = {}", handle, name.c_str());
@@ -159,13 +338,26 @@ void BufferCollection::SetBufferName(Handle handle, std::string const& name)
 
 uint8_t BufferCollection::GetBufferChannelCount(Handle handle) const
 {
+    ConsumerLock lock(m_pCommands);
+
     auto infoIt = m_bufferInfo.find(handle);
 
     return ((m_bufferInfo.cend() != infoIt) ? infoIt->second.channels : 0);
 }
 
+PcmData::Format BufferCollection::GetBufferSampleFormat(Handle handle) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    auto infoIt = m_bufferInfo.find(handle);
+
+    return ((m_bufferInfo.cend() != infoIt) ? infoIt->second.format : PcmData::Format::Int16);
+}
+
 uint32_t BufferCollection::GetBufferFrequencyHz(Handle handle) const
 {
+    ConsumerLock lock(m_pCommands);
+
     auto infoIt = m_bufferInfo.find(handle);
 
     return ((m_bufferInfo.cend() != infoIt) ? infoIt->second.frequencyHz : 0);
@@ -173,6 +365,8 @@ uint32_t BufferCollection::GetBufferFrequencyHz(Handle handle) const
 
 uint32_t BufferCollection::GetBufferSampleCount(Handle handle) const
 {
+    ConsumerLock lock(m_pCommands);
+
     auto infoIt = m_bufferInfo.find(handle);
 
     return ((m_bufferInfo.cend() != infoIt) ? infoIt->second.sampleCount : 0);
@@ -180,97 +374,273 @@ uint32_t BufferCollection::GetBufferSampleCount(Handle handle) const
 
 std::chrono::nanoseconds BufferCollection::GetBufferDuration(Handle handle) const
 {
+    ConsumerLock lock(m_pCommands);
+
     auto infoIt = m_bufferInfo.find(handle);
 
     return ((m_bufferInfo.cend() != infoIt) ? infoIt->second.duration : std::chrono::nanoseconds(0));
 }
 
-bool BufferCollection::SetBufferData(Handle handle, mule::asset::Handler asset)
+uint64_t BufferCollection::GetBufferResidentSize(Handle handle) const
 {
-    ALuint index = static_cast<ALuint>(handle);
+    ConsumerLock lock(m_pCommands);
 
-    LOG_AUDIO->Trace("Buffer #{}: parsing '{}' data with STB...", handle, asset.GetName().c_str());
+    auto infoIt = m_bufferInfo.find(handle);
 
-    int error = 0;
+    return ((m_bufferInfo.cend() != infoIt && infoIt->second.isResident) ? infoIt->second.size : 0);
+}
+
+bool BufferCollection::SetBufferData(Handle handle, mule::asset::Handler asset, audio::Buffer::Downmix downmix)
+{
+    if (IsDeferringCommands())
+    {
+        SetBufferDataAsync(handle, asset, downmix);
+
+        return true;
+    }
+
+    bool const isMono = IsMono(downmix);
+
+    std::shared_ptr<PcmData const> cached = FindCachedData(asset, isMono);
+
+    if (nullptr != cached)
+    {
+        LOG_AUDIO->Trace("Buffer #{}: using cached '{}' data", handle, asset.GetName().c_str());
+
+        return UploadData(handle, asset, std::string(), isMono, *cached);
+    }
+
+    std::shared_ptr<PcmData> pcm = std::make_shared<PcmData>();
     mule::asset::Content const& content = asset.GetContent();
-    stb_vorbis* pVorbis = stb_vorbis_open_memory(content.GetBuffer().data(), content.GetSize(), &error, NULL);
 
-    if (VORBIS__no_error == error)
+    if (DecodeData(content.GetBuffer().data(), content.GetSize(), asset.GetName(), m_isFloatSupported, isMono, *pcm))
+    {
+        // borrowed data costs nothing to parse again
+        if (nullptr != m_pcmCache && !pcm->IsBorrowed())
+        {
+            m_pcmCache->Insert(asset, pcm);
+        }
+
+        return UploadData(handle, asset, std::string(), isMono, *pcm);
+    }
+    else
+    {
+        LOG_AUDIO->Error("Buffer #{}: couldn't parse data", handle);
+
+        return false;
+    }
+}
+
+bool BufferCollection::SetBufferFile(Handle handle, std::string const& path, audio::Buffer::Downmix downmix)
+{
+    if (IsDeferringCommands())
     {
-        stb_vorbis_info vorbisInfo = stb_vorbis_get_info(pVorbis);
-        uint32_t const sampleCount = stb_vorbis_stream_length_in_samples(pVorbis) * vorbisInfo.channels;
+        SetBufferFileAsync(handle, path, downmix);
 
-        ALshort* pSampleBuffer = new ALshort[sampleCount];
+        return true;
+    }
 
-        stb_vorbis_get_samples_short_interleaved(pVorbis
-            , vorbisInfo.channels
-            , pSampleBuffer
-            , sampleCount
-        );
+    bool const isMono = IsMono(downmix);
 
-        LOG_AUDIO->Debug(
-            "Buffer #{}: channels: {}; samples: {}; rate: {}"
-            , handle
-            , vorbisInfo.channels
-            , sampleCount
-            , vorbisInfo.sample_rate
-        );
+    std::unique_ptr<MappedFile> file(MappedFile::Create(path));
 
-        // clear error state
-        ALenum alErr = alGetError();
+    if (nullptr == file)
+    {
+        return false;
+    }
 
-        alBufferData(index
-            , ((1 == vorbisInfo.channels) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16)
-            , pSampleBuffer
-            , (sampleCount * sizeof(ALshort))
-            , vorbisInfo.sample_rate
-        );
+    // mapping is released once OpenAL copies the samples
+    PcmData pcm;
 
-        alErr = alGetError();
+    if (DecodeData(file->GetData(), file->GetSize(), path, m_isFloatSupported, isMono, pcm))
+    {
+        return UploadData(handle, mule::asset::Handler(), path, isMono, pcm);
+    }
+    else
+    {
+        LOG_AUDIO->Error("Buffer #{}: couldn't parse data", handle);
 
-        if (AL_NO_ERROR == alErr)
+        return false;
+    }
+}
+
+std::future<bool> BufferCollection::SetBufferFileAsync(Handle handle
+    , std::string const& path
+    , audio::Buffer::Downmix downmix
+)
+{
+    LOG_AUDIO->Trace("Buffer #{}: queueing '{}' file...", handle, path.c_str());
+
+    std::shared_ptr<PendingBatch> batch = std::make_shared<PendingBatch>();
+    batch->remaining = 1;
+
+    std::future<bool> result = batch->promise.get_future();
+
+    std::shared_ptr<PendingData> pending = std::make_shared<PendingData>();
+    pending->handle = handle;
+    pending->generation = GetGeneration(handle);
+    pending->file.reset(MappedFile::Create(path));
+    pending->isMono = IsMono(downmix);
+    pending->batch = batch;
+
+    if (nullptr == pending->file)
+    {
+        CompleteData(*pending, false);
+    }
+    else
+    {
+        SubmitData(pending);
+    }
+
+    return result;
+}
+
+std::future<bool> BufferCollection::SetBufferDataAsync(Handle handle
+    , mule::asset::Handler asset
+    , audio::Buffer::Downmix downmix
+)
+{
+    return SetBuffersDataAsync(Handles{ handle }, { asset }, downmix);
+}
+
+std::future<bool> BufferCollection::SetBuffersDataAsync(
+    Handles const& handles
+    , std::vector<mule::asset::Handler> const& assets
+    , audio::Buffer::Downmix downmix
+)
+{
+    assert(handles.size() == assets.size());
+
+    std::shared_ptr<PendingBatch> batch = std::make_shared<PendingBatch>();
+    batch->remaining = static_cast<uint32_t>(handles.size());
+
+    std::future<bool> result = batch->promise.get_future();
+
+    if (handles.empty())
+    {
+        batch->promise.set_value(true);
+
+        return result;
+    }
+
+    bool const isMono = IsMono(downmix);
+
+    for (uint32_t i = 0; i < handles.size(); ++i)
+    {
+        LOG_AUDIO->Trace("Buffer #{}: queueing '{}' data...", handles[i], assets[i].GetName().c_str());
+
+        std::shared_ptr<PendingData> pending = std::make_shared<PendingData>();
+        pending->handle = handles[i];
+        pending->generation = GetGeneration(handles[i]);
+        pending->asset = assets[i];
+        pending->isMono = isMono;
+        pending->batch = batch;
+
+        std::shared_ptr<PcmData const> cached = FindCachedData(assets[i], isMono);
+
+        if (nullptr != cached)
         {
-            BufferInfo& info = m_bufferInfo[handle];
+            LOG_AUDIO->Trace("Buffer #{}: using cached '{}' data", handles[i], assets[i].GetName().c_str());
+
+            pending->pcm = cached;
+            pending->isDecoded = true;
+            pending->isCached = true;
+
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
 
-            double const timeNs = 1e-9 * (static_cast<double>(info.sampleCount) / static_cast<double>(info.frequencyHz));
+            m_decoded.push_back(pending);
 
-            info.asset = asset;
-            info.name = asset.GetName();
-            info.channels = vorbisInfo.channels;
-            info.frequencyHz = vorbisInfo.sample_rate;
-            info.sampleCount = sampleCount;
-            info.duration = std::chrono::nanoseconds(static_cast<uint64_t>(std::round(timeNs)));
+            continue;
         }
-        else
+
+        SubmitData(pending);
+    }
+
+    return result;
+}
+
+void BufferCollection::UploadPendingData()
+{
+    std::vector<std::shared_ptr<PendingData>> decoded;
+
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+        decoded.swap(m_decoded);
+    }
+
+    for (std::shared_ptr<PendingData>& pending : decoded)
+    {
+        bool result = false;
+
+        if (!IsValid(pending->handle, pending->generation))
+        {
+            LOG_AUDIO->Warning("Buffer #{}: discarding '{}' data, buffer was reset"
+                , pending->handle
+                , pending->asset.GetName().c_str()
+            );
+        }
+        else if (!pending->isDecoded)
         {
-            LOG_AUDIO->Warning("Buffer #{}: binding data to OpenAL: {:#x}", handle, alErr);
+            LOG_AUDIO->Error("Buffer #{}: couldn't parse data", pending->handle);
         }
+        else
+        {
+            if (nullptr != m_pcmCache && !pending->isCached && nullptr == pending->file && !pending->pcm->IsBorrowed())
+            {
+                m_pcmCache->Insert(pending->asset, pending->pcm);
+            }
 
-        delete[] pSampleBuffer;
-        stb_vorbis_close(pVorbis);
+            result = UploadData(pending->handle
+                , pending->asset
+                , (nullptr != pending->file) ? pending->file->GetPath() : std::string()
+                , pending->isMono
+                , *pending->pcm
+            );
+        }
 
-        return (AL_NO_ERROR == alErr);
+        CompleteData(*pending, result);
     }
-    else // if open_memory indicated some error, we don't have to close any resources
+}
+
+void BufferCollection::FinishPendingData()
+{
     {
-        LOG_AUDIO->Error("Buffer #{}: couldn't parse data", handle);
+        std::unique_lock<std::mutex> lock(m_pendingMutex);
 
-        return false;
+        m_pendingCondition.wait(lock, [this]() -> bool { return 0 == m_inFlightCount; });
     }
+
+    UploadPendingData();
 }
 
 void BufferCollection::ResetBuffer(Handle handle)
 {
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::BufferReset, handle));
+
+        return;
+    }
+
     LOG_AUDIO->Trace("Buffer #{}: reset", handle);
 
     Reclaim(handle);
 
+    auto infoIt = m_bufferInfo.find(handle);
+
+    if (m_bufferInfo.end() != infoIt && infoIt->second.isResident)
+    {
+        m_residentSize -= infoIt->second.size;
+        m_residentBuffers.erase(infoIt->second.residentIt);
+    }
+
     m_bufferInfo.erase(handle);
 }
 
 audio::Buffer BufferCollection::CreateObject(Handle handle)
 {
-    assert(m_objects.cend() == m_objects.find(handle));
+    assert(!IsValid(handle));
 
     SetBufferName(handle, std::string());
 
@@ -279,5 +649,348 @@ audio::Buffer BufferCollection::CreateObject(Handle handle)
     );
 }
 
+void BufferCollection::SubmitData(std::shared_ptr<PendingData> pending)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+        ++m_inFlightCount;
+    }
+
+    bool const isFloat = m_isFloatSupported;
+
+    auto job = [this, pending, isFloat]()
+    {
+        std::shared_ptr<PcmData> pcm = std::make_shared<PcmData>();
+
+        if (nullptr != pending->file)
+        {
+            MappedFile const& file = *pending->file;
+
+            pending->isDecoded = DecodeData(file.GetData(), file.GetSize(), file.GetPath(), isFloat, pending->isMono, *pcm);
+        }
+        else
+        {
+            mule::asset::Content const& content = pending->asset.GetContent();
+
+            pending->isDecoded = DecodeData(content.GetBuffer().data()
+                , content.GetSize()
+                , pending->asset.GetName()
+                , isFloat
+                , pending->isMono
+                , *pcm
+            );
+        }
+
+        pending->pcm = pcm;
+
+        // notify under lock, collection may be destroyed right after unlocking
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+        m_decoded.push_back(pending);
+        --m_inFlightCount;
+
+        m_pendingCondition.notify_all();
+    };
+
+    if (nullptr != m_workerPool)
+    {
+        m_workerPool->Submit(job);
+    }
+    else
+    {
+        job();
+    }
+}
+
+bool BufferCollection::IsMono(audio::Buffer::Downmix downmix) const
+{
+    return (audio::Buffer::Downmix::Mono == downmix)
+        || (audio::Buffer::Downmix::Default == downmix && m_isStereoDownmixed);
+}
+
+std::shared_ptr<PcmData const> BufferCollection::FindCachedData(mule::asset::Handler const& asset, bool isMono)
+{
+    std::shared_ptr<PcmData const> cached = (nullptr != m_pcmCache) ? m_pcmCache->Find(asset) : nullptr;
+
+    if (nullptr == cached)
+    {
+        return nullptr;
+    }
+
+    // stereo can't be restored, request decodes again replacing the entry
+    if (cached->isDownmixed && !isMono)
+    {
+        return nullptr;
+    }
+
+    if (isMono && 2 == cached->channels)
+    {
+        return std::make_shared<PcmData const>(PcmData::DownmixToMono(*cached));
+    }
+
+    return cached;
+}
+
+bool BufferCollection::DecodeData(uint8_t const* pData
+    , size_t size
+    , std::string const& name
+    , bool isFloat
+    , bool isMono
+    , PcmData& pcm
+)
+{
+    bool result = false;
+
+    if (WaveParser::IsWave(pData, size))
+    {
+        LOG_AUDIO->Trace("Parsing '{}' data as RIFF/WAVE...", name.c_str());
+
+        result = WaveParser::Parse(pData, size, pcm);
+    }
+    else
+    {
+        result = DecodeVorbis(pData, size, name, isFloat, pcm);
+    }
+
+    if (result && isMono && 2 == pcm.channels)
+    {
+        LOG_AUDIO->Trace("Down-mixing '{}' data to mono...", name.c_str());
+
+        pcm = PcmData::DownmixToMono(pcm);
+    }
+
+    return result;
+}
+
+bool BufferCollection::DecodeVorbis(uint8_t const* pData, size_t size, std::string const& name, bool isFloat, PcmData& pcm)
+{
+    LOG_AUDIO->Trace("Parsing '{}' data with STB...", name.c_str());
+
+    int error = 0;
+    stb_vorbis* pVorbis = stb_vorbis_open_memory(pData, static_cast<int>(size), &error, NULL);
+
+    // if open_memory indicated some error, we don't have to close any resources
+    if (VORBIS__no_error != error)
+    {
+        return false;
+    }
+
+    stb_vorbis_info vorbisInfo = stb_vorbis_get_info(pVorbis);
+    uint32_t const frameCount = stb_vorbis_stream_length_in_samples(pVorbis);
+    uint32_t const sampleCount = frameCount * vorbisInfo.channels;
+
+    if (!PcmData::IsLayoutSupported(vorbisInfo.channels))
+    {
+        LOG_AUDIO->Warning("Parsing '{}' data: unsupported channel count {}", name.c_str(), vorbisInfo.channels);
+
+        stb_vorbis_close(pVorbis);
+
+        return false;
+    }
+
+    pcm.channels = static_cast<uint8_t>(vorbisInfo.channels);
+    pcm.frequencyHz = vorbisInfo.sample_rate;
+    pcm.format = isFloat ? PcmData::Format::Float32 : PcmData::Format::Int16;
+    pcm.bytes.resize(sampleCount * PcmData::GetSampleSize(pcm.format));
+
+    // stb_vorbis decodes to float internally, so float output skips quantization
+    if (isFloat)
+    {
+        float* pSamples = reinterpret_cast<float*>(pcm.bytes.data());
+
+        stb_vorbis_get_samples_float_interleaved(pVorbis, vorbisInfo.channels, pSamples, sampleCount);
+        VorbisStream::ReorderChannels(pSamples, frameCount, vorbisInfo.channels);
+    }
+    else
+    {
+        int16_t* pSamples = reinterpret_cast<int16_t*>(pcm.bytes.data());
+
+        stb_vorbis_get_samples_short_interleaved(pVorbis, vorbisInfo.channels, pSamples, sampleCount);
+        VorbisStream::ReorderChannels(pSamples, frameCount, vorbisInfo.channels);
+    }
+
+    stb_vorbis_close(pVorbis);
+
+    return true;
+}
+
+bool BufferCollection::UploadData(Handle handle
+    , mule::asset::Handler const& asset
+    , std::string const& path
+    , bool isMono
+    , PcmData const& pcm
+)
+{
+    ALuint index = static_cast<ALuint>(handle);
+    uint32_t const sampleCount = pcm.GetSampleCount();
+
+    LOG_AUDIO->Debug(
+        "Buffer #{}: channels: {}; samples: {}; rate: {}; bytes per sample: {}"
+        , handle
+        , pcm.channels
+        , sampleCount
+        , pcm.frequencyHz
+        , PcmData::GetSampleSize(pcm.format)
+    );
+
+    PcmData::Format sampleFormat = pcm.format;
+    ALenum format = GetFormat(sampleFormat, pcm.channels);
+    void const* pData = pcm.GetData();
+    uint32_t size = pcm.GetSize();
+
+    // float data has to be converted if device can't take it as is
+    std::vector<int16_t> converted;
+
+    if (AL_NONE == format && PcmData::Format::Float32 == pcm.format)
+    {
+        converted = ConvertFloatSamples(pcm);
+
+        sampleFormat = PcmData::Format::Int16;
+        format = GetFormat(sampleFormat, pcm.channels);
+        pData = converted.data();
+        size = static_cast<uint32_t>(converted.size() * sizeof(int16_t));
+    }
+
+    if (AL_NONE == format)
+    {
+        LOG_AUDIO->Warning("Buffer #{}: {} channel layout is not supported", handle, pcm.channels);
+
+        return false;
+    }
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    alBufferData(index, format, pData, size, pcm.frequencyHz);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        BufferInfo& info = m_bufferInfo[handle];
+
+        double const frameCount = static_cast<double>(sampleCount) / static_cast<double>(pcm.channels);
+        double const timeNs = 1e9 * (frameCount / static_cast<double>(pcm.frequencyHz));
+
+        info.asset = asset;
+        info.path = path;
+        info.name = path.empty() ? asset.GetName() : path;
+        info.channels = pcm.channels;
+        info.isMono = isMono;
+        info.format = sampleFormat;
+        info.frequencyHz = pcm.frequencyHz;
+        info.sampleCount = sampleCount;
+        info.duration = std::chrono::nanoseconds(static_cast<uint64_t>(std::round(timeNs)));
+
+        if (info.isResident)
+        {
+            m_residentSize -= info.size;
+            m_residentBuffers.erase(info.residentIt);
+        }
+
+        m_residentBuffers.push_front(handle);
+        m_residentSize += size;
+
+        info.size = size;
+        info.isResident = true;
+        info.isEvicted = false;
+        info.residentIt = m_residentBuffers.begin();
+
+        EvictBuffers();
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Buffer #{}: binding data to OpenAL: {:#x}", handle, alErr);
+    }
+
+    return (AL_NO_ERROR == alErr);
+}
+
+bool BufferCollection::ReloadBuffer(Handle handle)
+{
+    BufferInfo const& info = m_bufferInfo.at(handle);
+
+    LOG_AUDIO->Trace("Buffer #{}: reloading evicted '{}' data", handle, info.name.c_str());
+
+    // upload overwrites the name that might have been set by user
+    std::string const name = info.name;
+    audio::Buffer::Downmix const downmix = info.isMono ? audio::Buffer::Downmix::Mono : audio::Buffer::Downmix::Keep;
+
+    bool const result = info.path.empty()
+        ? SetBufferData(handle, info.asset, downmix)
+        : SetBufferFile(handle, info.path, downmix);
+
+    m_bufferInfo.at(handle).name = name;
+
+    return result;
+}
+
+bool BufferCollection::EvictBuffer(Handle handle)
+{
+    BufferInfo& info = m_bufferInfo.at(handle);
+
+    assert(info.isResident);
+    assert(0 == info.useCount);
+
+    LOG_AUDIO->Trace("Buffer #{}: evicting '{}' data ({} bytes)", handle, info.name.c_str(), info.size);
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    // empty data releases storage while keeping the buffer name
+    alBufferData(static_cast<ALuint>(handle), GetFormat(info.format, info.channels), nullptr, 0, info.frequencyHz);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Buffer #{}: evicting data: {:#x}", handle, alErr);
+
+        return false;
+    }
+
+    m_residentSize -= info.size;
+    m_residentBuffers.erase(info.residentIt);
+
+    info.isResident = false;
+    info.isEvicted = true;
+
+    return true;
+}
+
+void BufferCollection::EvictBuffers()
+{
+    if (0 == m_budget || m_residentBuffers.empty())
+    {
+        return;
+    }
+
+    auto const first = m_residentBuffers.begin();
+    auto it = std::prev(m_residentBuffers.end());
+
+    while (m_residentSize > m_budget && first != it)
+    {
+        Handle const handle = *(it--);
+
+        if (0 == m_bufferInfo.at(handle).useCount)
+        {
+            EvictBuffer(handle);
+        }
+    }
+}
+
+void BufferCollection::CompleteData(PendingData& pending, bool result)
+{
+    PendingBatch& batch = *pending.batch;
+
+    batch.result = batch.result && result;
+
+    if (0 == --batch.remaining)
+    {
+        batch.promise.set_value(batch.result);
+    }
+}
+
 }
 }
@@ -0,0 +1,190 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/CommandQueue.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+
+//! Consumer mutex held by the calling thread via ConsumerLock
+thread_local std::mutex* t_pHeldMutex = nullptr;
+
+}
+
+namespace tulpar
+{
+namespace internal
+{
+
+Command Command::Make(Type type, uint32_t handle)
+{
+    Command result;
+    result.type = type;
+    result.handle = handle;
+    result.generation = 0;
+    result.payload.nanoseconds = 0;
+
+    return result;
+}
+
+Command Command::MakeFlag(Type type, uint32_t handle, bool flag)
+{
+    Command result = Make(type, handle);
+    result.payload.flag = flag;
+
+    return result;
+}
+
+Command Command::MakeInteger(Type type, uint32_t handle, int32_t value)
+{
+    Command result = Make(type, handle);
+    result.payload.integer = value;
+
+    return result;
+}
+
+Command Command::MakeHandle(Type type, uint32_t handle, uint32_t value)
+{
+    Command result = Make(type, handle);
+    result.payload.handle = value;
+
+    return result;
+}
+
+Command Command::MakeScalar(Type type, uint32_t handle, float value)
+{
+    Command result = Make(type, handle);
+    result.payload.scalar = value;
+
+    return result;
+}
+
+Command Command::MakeTime(Type type, uint32_t handle, std::chrono::nanoseconds value)
+{
+    Command result = Make(type, handle);
+    result.payload.nanoseconds = value.count();
+
+    return result;
+}
+
+Command Command::MakeVector(Type type, uint32_t handle, float const* pData, uint32_t size)
+{
+    assert(size <= 6);
+
+    Command result = Make(type, handle);
+    std::copy(pData, pData + size, result.payload.vector);
+
+    return result;
+}
+
+CommandQueue::CommandQueue(uint32_t capacity)
+    : m_cells(nullptr)
+    , m_mask(0)
+    , m_consumer()
+    , m_pConsumerMutex(nullptr)
+    , m_enqueuePosition(0)
+    , m_dequeuePosition(0)
+{
+    uint64_t size = 2;
+
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    m_cells.reset(new Cell[size]);
+    m_mask = size - 1;
+
+    for (uint64_t i = 0; i < size; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool CommandQueue::TryPush(Command const& command)
+{
+    uint64_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        Cell& cell = m_cells[position & m_mask];
+        uint64_t const sequence = cell.sequence.load(std::memory_order_acquire);
+        int64_t const difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+        if (0 == difference)
+        {
+            // claim the slot, position is reloaded on failure
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                cell.command = command;
+                cell.sequence.store(position + 1, std::memory_order_release);
+
+                return true;
+            }
+        }
+        else if (0 > difference)
+        {
+            // slot still holds a command pushed a lap ago
+            return false;
+        }
+        else
+        {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void CommandQueue::Push(Command const& command)
+{
+    while (!TryPush(command))
+    {
+        std::this_thread::yield();
+    }
+}
+
+bool CommandQueue::Pop(Command& command)
+{
+    Cell& cell = m_cells[m_dequeuePosition & m_mask];
+
+    // slot is either empty or its producer has not finished writing yet
+    if (cell.sequence.load(std::memory_order_acquire) != (m_dequeuePosition + 1))
+    {
+        return false;
+    }
+
+    command = cell.command;
+    cell.sequence.store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+
+    ++m_dequeuePosition;
+
+    return true;
+}
+
+ConsumerLock::ConsumerLock(CommandQueue const* pQueue)
+    : m_lock()
+{
+    std::mutex* pMutex = (nullptr != pQueue) ? pQueue->GetConsumerMutex() : nullptr;
+
+    if (nullptr != pMutex && t_pHeldMutex != pMutex && pQueue->IsProducerThread())
+    {
+        m_lock = std::unique_lock<std::mutex>(*pMutex);
+        t_pHeldMutex = pMutex;
+    }
+}
+
+ConsumerLock::~ConsumerLock()
+{
+    if (m_lock.owns_lock())
+    {
+        t_pHeldMutex = nullptr;
+    }
+}
+
+}
+}
@@ -5,12 +5,14 @@
 */
 
 #include <tulpar/internal/Context.hpp>
+#include <tulpar/internal/HotPath.hpp>
 
 #include <tulpar/InternalLoggers.hpp>
 
 #include <cassert>
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 
 namespace tulpar
 {
@@ -55,12 +57,157 @@ void Context::MakeCurrent()
     {
         LOG_AUDIO->Debug("Context::MakeCurrent() {:#x} failed: {:#x}", reinterpret_cast<uintptr_t>(m_pContext), alcErr);
     }
+    else if (AL_TRUE == alIsExtensionPresent("AL_SOFT_deferred_updates"))
+    {
+        m_alDeferUpdatesSOFT = reinterpret_cast<LPALDEFERUPDATESSOFT>(alGetProcAddress("alDeferUpdatesSOFT"));
+        m_alProcessUpdatesSOFT = reinterpret_cast<LPALPROCESSUPDATESSOFT>(alGetProcAddress("alProcessUpdatesSOFT"));
+
+        if (nullptr == m_alDeferUpdatesSOFT || nullptr == m_alProcessUpdatesSOFT)
+        {
+            m_alDeferUpdatesSOFT = nullptr;
+            m_alProcessUpdatesSOFT = nullptr;
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Debug("Context::MakeCurrent() {:#x} AL_SOFT_deferred_updates is not supported", reinterpret_cast<uintptr_t>(m_pContext));
+
+        m_alDeferUpdatesSOFT = nullptr;
+        m_alProcessUpdatesSOFT = nullptr;
+    }
+
+    m_isEventSupported = false;
+
+#ifdef AL_SOFT_events
+    if (ALC_NO_ERROR == alcErr && AL_TRUE == alIsExtensionPresent("AL_SOFT_events"))
+    {
+        m_alEventControlSOFT = reinterpret_cast<LPALEVENTCONTROLSOFT>(alGetProcAddress("alEventControlSOFT"));
+        m_alEventCallbackSOFT = reinterpret_cast<LPALEVENTCALLBACKSOFT>(alGetProcAddress("alEventCallbackSOFT"));
+
+        m_isEventSupported = (nullptr != m_alEventControlSOFT) && (nullptr != m_alEventCallbackSOFT);
+    }
+#endif
+
+    if (!m_isEventSupported)
+    {
+        LOG_AUDIO->Debug("Context::MakeCurrent() {:#x} AL_SOFT_events is not supported", reinterpret_cast<uintptr_t>(m_pContext));
+    }
+}
+
+bool Context::SetEventHandler(EventHandler handler, void* pUserData)
+{
+    assert(true == m_isInitialized);
+
+    if (!m_isEventSupported)
+    {
+        return false;
+    }
+
+    bool result = false;
+
+#ifdef AL_SOFT_events
+    ALenum const types[] = { AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT, AL_EVENT_TYPE_BUFFER_COMPLETED_SOFT };
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    // callback lock is held while events are dispatched, so old handler is done after this call
+    m_alEventCallbackSOFT(nullptr, nullptr);
+
+    m_eventHandler = handler;
+    m_pEventUserData = pUserData;
+
+    if (nullptr != handler)
+    {
+        m_alEventCallbackSOFT(&Context::HandleEvent, this);
+    }
+
+    m_alEventControlSOFT(2, types, (nullptr != handler) ? AL_TRUE : AL_FALSE);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Context::SetEventHandler() {:#x} failed: {:#x}", reinterpret_cast<uintptr_t>(m_pContext), alErr);
+
+        m_alEventCallbackSOFT(nullptr, nullptr);
+
+        m_eventHandler = nullptr;
+        m_pEventUserData = nullptr;
+    }
+
+    result = (nullptr != m_eventHandler);
+#else
+    (void)handler;
+    (void)pUserData;
+#endif
+
+    return result;
+}
+
+void Context::DeferUpdates()
+{
+    assert(true == m_isInitialized);
+
+    if (IsDeferringSupported())
+    {
+        // clear error state
+        ALenum alErr = HotPath::ClearError();
+
+        m_alDeferUpdatesSOFT();
+
+        alErr = alGetError();
+
+        if (AL_NO_ERROR != alErr)
+        {
+            LOG_AUDIO->Warning("Context::DeferUpdates() {:#x} failed: {:#x}", reinterpret_cast<uintptr_t>(m_pContext), alErr);
+        }
+    }
+}
+
+void Context::ProcessUpdates()
+{
+    assert(true == m_isInitialized);
+
+    if (IsDeferringSupported())
+    {
+        // deferred changes are applied here, report them before clearing
+        CheckErrors();
+
+        // clear error state
+        ALenum alErr = alGetError();
+
+        m_alProcessUpdatesSOFT();
+
+        alErr = alGetError();
+
+        if (AL_NO_ERROR != alErr)
+        {
+            LOG_AUDIO->Warning("Context::ProcessUpdates() {:#x} failed: {:#x}", reinterpret_cast<uintptr_t>(m_pContext), alErr);
+        }
+    }
+}
+
+bool Context::CheckErrors()
+{
+    assert(true == m_isInitialized);
+
+    return HotPath::CheckFrame();
 }
 
 Context::Context()
     : m_isInitialized(false)
     , m_pContext(nullptr)
     , m_pDevice(nullptr)
+    , m_alDeferUpdatesSOFT(nullptr)
+    , m_alProcessUpdatesSOFT(nullptr)
+    , m_isEventSupported(false)
+    , m_eventHandler(nullptr)
+    , m_pEventUserData(nullptr)
+#ifdef AL_SOFT_events
+    , m_alEventControlSOFT(nullptr)
+    , m_alEventCallbackSOFT(nullptr)
+#endif
 {
 
 }
@@ -76,7 +223,9 @@ bool Context::Initialize(Device const& device)
     // clear error state
     ALCenum alcErr = alcGetError(m_pDevice);
 
-    m_pContext = alcCreateContext(m_pDevice, NULL);
+    std::vector<ALCint> const attributes = device.GetContextAttributes();
+
+    m_pContext = alcCreateContext(m_pDevice, attributes.empty() ? NULL : attributes.data());
 
     alcErr = alcGetError(m_pDevice);
 
@@ -94,6 +243,42 @@ bool Context::Initialize(Device const& device)
     return m_isInitialized;
 }
 
+#ifdef AL_SOFT_events
+void AL_APIENTRY Context::HandleEvent(ALenum eventType
+    , ALuint object
+    , ALuint param
+    , ALsizei /*length*/
+    , ALchar const* /*pMessage*/
+    , void* pUserParam
+)
+{
+    Context const* pContext = static_cast<Context const*>(pUserParam);
+
+    if (nullptr == pContext->m_eventHandler)
+    {
+        return;
+    }
+
+    switch (eventType)
+    {
+        case AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT:
+        {
+            pContext->m_eventHandler(EventType::SourceStateChanged, object, param, pContext->m_pEventUserData);
+            break;
+        }
+        case AL_EVENT_TYPE_BUFFER_COMPLETED_SOFT:
+        {
+            pContext->m_eventHandler(EventType::BufferCompleted, object, param, pContext->m_pEventUserData);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+#endif
+
 void Context::Deinitialize()
 {
     if (m_isInitialized)
@@ -8,6 +8,7 @@
 
 #include <tulpar/InternalLoggers.hpp>
 
+#include <cassert>
 #include <cstddef>
 
 namespace tulpar
@@ -19,7 +20,7 @@ Device* Device::Create(TulparConfigurator::Device const& config)
 {
     Device* obj = new Device();
 
-    if (obj->Initialize(config.name))
+    if (obj->Initialize(config))
     {
         return obj;
     }
@@ -39,14 +40,68 @@ Device::~Device()
 Device::Device()
     : m_isInitialized(false)
     , m_pDevice(nullptr)
+    , m_isLoopback(false)
+    , m_frequencyHz(0)
+    , m_channelCount(0)
+    , m_alcRenderSamplesSOFT(nullptr)
 {
 
 }
 
-bool Device::Initialize(std::string const& name)
+std::vector<ALCint> Device::GetContextAttributes() const
+{
+    std::vector<ALCint> result;
+
+    if (m_isLoopback)
+    {
+        result = {
+            ALC_FORMAT_CHANNELS_SOFT, (1 == m_channelCount) ? ALC_MONO_SOFT : ALC_STEREO_SOFT
+            , ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT
+            , ALC_FREQUENCY, static_cast<ALCint>(m_frequencyHz)
+            , 0
+        };
+    }
+
+    return result;
+}
+
+bool Device::RenderSamples(int16_t* pSamples, uint32_t frameCount)
+{
+    assert(true == m_isInitialized);
+
+    if (!m_isLoopback)
+    {
+        LOG_AUDIO->Warning("Device::RenderSamples() {:#x} is not a loopback device", reinterpret_cast<uintptr_t>(m_pDevice));
+
+        return false;
+    }
+
+    // clear error state
+    ALCenum alcErr = alcGetError(m_pDevice);
+
+    m_alcRenderSamplesSOFT(m_pDevice, pSamples, static_cast<ALCsizei>(frameCount));
+
+    alcErr = alcGetError(m_pDevice);
+
+    if (ALC_NO_ERROR != alcErr)
+    {
+        LOG_AUDIO->Warning("Device::RenderSamples() {:#x} failed: {:#x}", reinterpret_cast<uintptr_t>(m_pDevice), alcErr);
+    }
+
+    return ALC_NO_ERROR == alcErr;
+}
+
+bool Device::Initialize(TulparConfigurator::Device const& config)
 {
     assert(false == m_isInitialized);
 
+    std::string const& name = config.name;
+
+    if (config.isLoopback)
+    {
+        return OpenLoopback(config);
+    }
+
     LOG_AUDIO->Debug("Device::Initialize({}) started", name.c_str());
 
     // clear error state
@@ -70,6 +125,78 @@ bool Device::Initialize(std::string const& name)
     return m_isInitialized;
 }
 
+bool Device::OpenLoopback(TulparConfigurator::Device const& config)
+{
+    LOG_AUDIO->Debug("Device::OpenLoopback({}Hz, {} channels) started", config.loopbackFrequencyHz, config.loopbackChannelCount);
+
+    if (1 != config.loopbackChannelCount && 2 != config.loopbackChannelCount)
+    {
+        LOG_AUDIO->Error("Device::OpenLoopback() unsupported channel count {}", config.loopbackChannelCount);
+
+        return false;
+    }
+
+    if (ALC_TRUE != alcIsExtensionPresent(NULL, "ALC_SOFT_loopback"))
+    {
+        LOG_AUDIO->Error("Device::OpenLoopback() ALC_SOFT_loopback is not supported");
+
+        return false;
+    }
+
+    LPALCLOOPBACKOPENDEVICESOFT alcLoopbackOpenDeviceSOFT =
+        reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT"));
+    LPALCISRENDERFORMATSUPPORTEDSOFT alcIsRenderFormatSupportedSOFT =
+        reinterpret_cast<LPALCISRENDERFORMATSUPPORTEDSOFT>(alcGetProcAddress(NULL, "alcIsRenderFormatSupportedSOFT"));
+    m_alcRenderSamplesSOFT = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(alcGetProcAddress(NULL, "alcRenderSamplesSOFT"));
+
+    if (nullptr == alcLoopbackOpenDeviceSOFT || nullptr == alcIsRenderFormatSupportedSOFT || nullptr == m_alcRenderSamplesSOFT)
+    {
+        LOG_AUDIO->Error("Device::OpenLoopback() failed to load ALC_SOFT_loopback functions");
+
+        m_alcRenderSamplesSOFT = nullptr;
+
+        return false;
+    }
+
+    // clear error state
+    ALCenum alcErr = alcGetError(NULL);
+
+    m_pDevice = alcLoopbackOpenDeviceSOFT(NULL);
+
+    alcErr = alcGetError(m_pDevice);
+
+    if (nullptr == m_pDevice || ALC_NO_ERROR != alcErr)
+    {
+        LOG_AUDIO->Error("Device::OpenLoopback() failed: {:#x}", alcErr);
+
+        m_pDevice = nullptr;
+
+        return false;
+    }
+
+    ALCenum const channels = (1 == config.loopbackChannelCount) ? ALC_MONO_SOFT : ALC_STEREO_SOFT;
+
+    if (ALC_TRUE != alcIsRenderFormatSupportedSOFT(m_pDevice, static_cast<ALCsizei>(config.loopbackFrequencyHz), channels, ALC_SHORT_SOFT))
+    {
+        LOG_AUDIO->Error("Device::OpenLoopback() {}Hz 16-bit format is not supported", config.loopbackFrequencyHz);
+
+        alcCloseDevice(m_pDevice);
+        m_pDevice = nullptr;
+
+        return false;
+    }
+
+    m_isLoopback = true;
+    m_frequencyHz = config.loopbackFrequencyHz;
+    m_channelCount = config.loopbackChannelCount;
+
+    m_isInitialized = true;
+
+    LOG_AUDIO->Debug("Device::OpenLoopback() done {:#x}", reinterpret_cast<uintptr_t>(m_pDevice));
+
+    return m_isInitialized;
+}
+
 void Device::Deinitialize()
 {
     if (m_isInitialized)
@@ -5,6 +5,7 @@
 */
 
 #include <tulpar/internal/ListenerController.hpp>
+#include <tulpar/internal/HotPath.hpp>
 
 #include <tulpar/InternalLoggers.hpp>
 
@@ -12,20 +13,46 @@
 
 #include <limits>
 
+namespace
+{
+
+//! OpenAL distance models indexed by audio::Listener::DistanceModel
+constexpr ALenum s_alDistanceModels[] = {
+    AL_NONE
+    , AL_INVERSE_DISTANCE
+    , AL_INVERSE_DISTANCE_CLAMPED
+    , AL_LINEAR_DISTANCE
+    , AL_LINEAR_DISTANCE_CLAMPED
+    , AL_EXPONENT_DISTANCE
+    , AL_EXPONENT_DISTANCE_CLAMPED
+};
+
+}
+
 namespace tulpar
 {
 namespace internal
 {
 
+ListenerController::ListenerController()
+    : m_gain(1.0f)
+    , m_position{{ 0.0f, 0.0f, 0.0f }}
+    , m_orientation{ {{ 0.0f, 0.0f, -1.0f }}, {{ 0.0f, 1.0f, 0.0f }} }
+    , m_distanceModel(audio::Listener::DistanceModel::InverseClamped)
+    , m_pCommands(nullptr)
+{
+
+}
+
 audio::Listener ListenerController::Get() const
 {
     return audio::Listener(const_cast<ListenerController*>(this)->shared_from_this());
 }
 
-float ListenerController::GetListenerGain() const
+float ListenerController::QueryListenerGain() const
 {
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     ALfloat result = 0.0f;
 
@@ -42,18 +69,47 @@ float ListenerController::GetListenerGain() const
     return result;
 }
 
+float ListenerController::GetListenerGain() const
+{
+    ConsumerLock lock(m_pCommands);
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifyListenerShadow("gain", m_gain == QueryListenerGain());
+#endif
+
+    return m_gain;
+}
+
 bool ListenerController::SetListenerGain(float value)
 {
-    LOG_AUDIO->Debug("Listener: set gain {}", value);
+    if (!IsValidScalar(value))
+    {
+        LOG_AUDIO->Warning("Listener: set gain: invalid value {}", value);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        m_pCommands->Push(Command::MakeScalar(Command::Type::ListenerGain, 0, value));
+
+        return true;
+    }
+
+    HotPath::Debug("Listener: set gain {}", value);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::GetError();
 
     alListenerf(AL_GAIN, value);
 
-    alErr = alGetError();
+    alErr = HotPath::GetError();
 
-    if (AL_NO_ERROR != alErr)
+    if (AL_NO_ERROR == alErr)
+    {
+        m_gain = value;
+    }
+    else
     {
         LOG_AUDIO->Warning("Listener: set gain: {:#x}", alErr);
     }
@@ -61,10 +117,10 @@ bool ListenerController::SetListenerGain(float value)
     return AL_NO_ERROR == alErr;
 }
 
-std::array<float, 3> ListenerController::GetListenerPosition() const
+std::array<float, 3> ListenerController::QueryListenerPosition() const
 {
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     ALfloat x;
     ALfloat y;
@@ -86,18 +142,47 @@ std::array<float, 3> ListenerController::GetListenerPosition() const
     return {{ static_cast<float>(x), static_cast<float>(y), static_cast<float>(z) }};
 }
 
+std::array<float, 3> ListenerController::GetListenerPosition() const
+{
+    ConsumerLock lock(m_pCommands);
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifyListenerShadow("position", m_position == QueryListenerPosition());
+#endif
+
+    return m_position;
+}
+
 bool ListenerController::SetListenerPosition(std::array<float, 3> const& vec)
 {
-    LOG_AUDIO->Debug("Listener: set position {{ {}, {}, {} }}", vec[0], vec[1], vec[2]);
+    if (!IsValidVector(vec))
+    {
+        LOG_AUDIO->Warning("Listener: set position: invalid value {{ {}, {}, {} }}", vec[0], vec[1], vec[2]);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        m_pCommands->Push(Command::MakeVector(Command::Type::ListenerPosition, 0, vec.data(), 3));
+
+        return true;
+    }
+
+    HotPath::Debug("Listener: set position {{ {}, {}, {} }}", vec[0], vec[1], vec[2]);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::GetError();
 
     alListener3f(AL_POSITION, static_cast<ALfloat>(vec[0]), static_cast<ALfloat>(vec[1]), static_cast<ALfloat>(vec[2]));
 
-    alErr = alGetError();
+    alErr = HotPath::GetError();
 
-    if (AL_NO_ERROR != alErr)
+    if (AL_NO_ERROR == alErr)
+    {
+        m_position = vec;
+    }
+    else
     {
         LOG_AUDIO->Warning("Listener: set position: {:#x}", alErr);
     }
@@ -105,12 +190,12 @@ bool ListenerController::SetListenerPosition(std::array<float, 3> const& vec)
     return AL_NO_ERROR == alErr;
 }
 
-audio::Listener::Orientation ListenerController::GetListenerOrientation() const
+audio::Listener::Orientation ListenerController::QueryListenerOrientation() const
 {
     audio::Listener::Orientation result;
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     ALfloat values[6];
 
@@ -125,7 +210,7 @@ audio::Listener::Orientation ListenerController::GetListenerOrientation() const
     }
     else
     {
-        LOG_AUDIO->Warning("Listener: get position: {:#x}", alErr);
+        LOG_AUDIO->Warning("Listener: get orientation: {:#x}", alErr);
 
         result.at = {{ std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN() }};
         result.up = {{ std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN() }};
@@ -134,9 +219,41 @@ audio::Listener::Orientation ListenerController::GetListenerOrientation() const
     return result;
 }
 
+audio::Listener::Orientation ListenerController::GetListenerOrientation() const
+{
+    ConsumerLock lock(m_pCommands);
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    audio::Listener::Orientation const actual = QueryListenerOrientation();
+
+    VerifyListenerShadow("orientation", (m_orientation.at == actual.at) && (m_orientation.up == actual.up));
+#endif
+
+    return m_orientation;
+}
+
 bool ListenerController::SetListenerOrientation(audio::Listener::Orientation const& orientation)
 {
-    LOG_AUDIO->Debug("Listener: set orientation {{ at: {{ {}, {}, {} }}, up: {{ {}, {}, {} }} }}"
+    if (!IsValidVector(orientation.at) || !IsValidVector(orientation.up))
+    {
+        LOG_AUDIO->Warning("Listener: set orientation: invalid value");
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        float const vector[6] = {
+            orientation.at[0], orientation.at[1], orientation.at[2]
+            , orientation.up[0], orientation.up[1], orientation.up[2]
+        };
+
+        m_pCommands->Push(Command::MakeVector(Command::Type::ListenerOrientation, 0, vector, 6));
+
+        return true;
+    }
+
+    HotPath::Debug("Listener: set orientation {{ at: {{ {}, {}, {} }}, up: {{ {}, {}, {} }} }}"
         , orientation.at[0], orientation.at[1], orientation.at[2]
         , orientation.up[0], orientation.up[1], orientation.up[2]
     );
@@ -152,13 +269,17 @@ bool ListenerController::SetListenerOrientation(audio::Listener::Orientation con
     values[5] = orientation.up[2];
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::GetError();
 
     alListenerfv(AL_ORIENTATION, values);
 
-    alErr = alGetError();
+    alErr = HotPath::GetError();
 
-    if (AL_NO_ERROR != alErr)
+    if (AL_NO_ERROR == alErr)
+    {
+        m_orientation = orientation;
+    }
+    else
     {
         LOG_AUDIO->Warning("Listener: set orientation: {:#x}", alErr);
     }
@@ -166,5 +287,101 @@ bool ListenerController::SetListenerOrientation(audio::Listener::Orientation con
     return AL_NO_ERROR == alErr;
 }
 
+audio::Listener::DistanceModel ListenerController::QueryListenerDistanceModel() const
+{
+    audio::Listener::DistanceModel result = audio::Listener::DistanceModel::InverseClamped;
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALint const alModel = alGetInteger(AL_DISTANCE_MODEL);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        for (size_t i = 0; i < sizeof(s_alDistanceModels) / sizeof(s_alDistanceModels[0]); ++i)
+        {
+            if (s_alDistanceModels[i] == alModel)
+            {
+                result = static_cast<audio::Listener::DistanceModel>(i);
+            }
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Listener: get distance model: {:#x}", alErr);
+    }
+
+    return result;
+}
+
+audio::Listener::DistanceModel ListenerController::GetListenerDistanceModel() const
+{
+    ConsumerLock lock(m_pCommands);
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifyListenerShadow("distance model", m_distanceModel == QueryListenerDistanceModel());
+#endif
+
+    return m_distanceModel;
+}
+
+bool ListenerController::SetListenerDistanceModel(audio::Listener::DistanceModel model)
+{
+    if (IsDeferringCommands())
+    {
+        m_pCommands->Push(Command::MakeInteger(Command::Type::ListenerDistanceModel, 0, static_cast<int32_t>(model)));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Listener: set distance model {}", static_cast<uint32_t>(model));
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    alDistanceModel(s_alDistanceModels[static_cast<size_t>(model)]);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_distanceModel = model;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Listener: set distance model: {:#x}", alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+bool ListenerController::ApplyListenerState()
+{
+    LOG_AUDIO->Debug("Listener: apply cached state");
+
+    // setters update cached values, so copies are passed
+    float const gain = m_gain;
+    std::array<float, 3> const position = m_position;
+    audio::Listener::Orientation const orientation = m_orientation;
+    audio::Listener::DistanceModel const distanceModel = m_distanceModel;
+
+    bool result = SetListenerGain(gain);
+    result = SetListenerPosition(position) && result;
+    result = SetListenerOrientation(orientation) && result;
+    result = SetListenerDistanceModel(distanceModel) && result;
+
+    return result;
+}
+
+void ListenerController::VerifyListenerShadow(char const* property, bool isMatching) const
+{
+    if (!isMatching)
+    {
+        LOG_AUDIO->Error("Listener: cached {} differs from OpenAL state", property);
+    }
+}
+
 }
 }
@@ -0,0 +1,182 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/MappedFile.hpp>
+
+#include <tulpar/InternalLoggers.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tulpar
+{
+namespace internal
+{
+
+MappedFile* MappedFile::Create(std::string const& path)
+{
+    MappedFile* obj = new MappedFile();
+
+    if (obj->Initialize(path))
+    {
+        return obj;
+    }
+    else
+    {
+        delete obj;
+
+        return nullptr;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    Deinitialize();
+}
+
+MappedFile::MappedFile()
+    : m_path()
+    , m_pData(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_mapping(nullptr)
+#endif
+{
+
+}
+
+#ifdef _WIN32
+bool MappedFile::Initialize(std::string const& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (INVALID_HANDLE_VALUE == file)
+    {
+        LOG_AUDIO->Error("MappedFile: couldn't open '{}': {}", path.c_str(), GetLastError());
+
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (FALSE == GetFileSizeEx(file, &size) || 0 == size.QuadPart)
+    {
+        LOG_AUDIO->Error("MappedFile: '{}' is empty or can't be measured", path.c_str());
+
+        CloseHandle(file);
+
+        return false;
+    }
+
+    // mapping object keeps file open
+    m_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    CloseHandle(file);
+
+    if (nullptr == m_mapping)
+    {
+        LOG_AUDIO->Error("MappedFile: couldn't map '{}': {}", path.c_str(), GetLastError());
+
+        return false;
+    }
+
+    m_pData = static_cast<uint8_t const*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (nullptr == m_pData)
+    {
+        LOG_AUDIO->Error("MappedFile: couldn't map '{}': {}", path.c_str(), GetLastError());
+
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+
+        return false;
+    }
+
+    m_path = path;
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    return true;
+}
+
+void MappedFile::Deinitialize()
+{
+    if (nullptr != m_pData)
+    {
+        UnmapViewOfFile(m_pData);
+        CloseHandle(m_mapping);
+
+        m_pData = nullptr;
+        m_mapping = nullptr;
+        m_size = 0;
+    }
+}
+#else
+bool MappedFile::Initialize(std::string const& path)
+{
+    int const file = open(path.c_str(), O_RDONLY);
+
+    if (-1 == file)
+    {
+        LOG_AUDIO->Error("MappedFile: couldn't open '{}'", path.c_str());
+
+        return false;
+    }
+
+    struct stat info;
+
+    if (0 != fstat(file, &info) || 0 == info.st_size)
+    {
+        LOG_AUDIO->Error("MappedFile: '{}' is empty or can't be measured", path.c_str());
+
+        close(file);
+
+        return false;
+    }
+
+    // shared read-only mapping is backed by the page cache directly
+    void* pData = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, file, 0);
+
+    // mapping keeps file referenced
+    close(file);
+
+    if (MAP_FAILED == pData)
+    {
+        LOG_AUDIO->Error("MappedFile: couldn't map '{}'", path.c_str());
+
+        return false;
+    }
+
+    // content is decoded front to back
+    posix_madvise(pData, static_cast<size_t>(info.st_size), POSIX_MADV_SEQUENTIAL);
+
+    m_path = path;
+    m_pData = static_cast<uint8_t const*>(pData);
+    m_size = static_cast<size_t>(info.st_size);
+
+    return true;
+}
+
+void MappedFile::Deinitialize()
+{
+    if (nullptr != m_pData)
+    {
+        munmap(const_cast<uint8_t*>(m_pData), m_size);
+
+        m_pData = nullptr;
+        m_size = 0;
+    }
+}
+#endif
+
+}
+}
@@ -0,0 +1,129 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/PcmCache.hpp>
+
+#include <tulpar/InternalLoggers.hpp>
+
+#include <utility>
+
+namespace tulpar
+{
+namespace internal
+{
+
+PcmCache::PcmCache(uint64_t budget)
+    : m_budget(budget)
+    , m_size(0)
+{
+
+}
+
+uint64_t PcmCache::GetBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_budget;
+}
+
+void PcmCache::SetBudget(uint64_t budget)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_budget = budget;
+
+    Evict();
+}
+
+uint64_t PcmCache::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_size;
+}
+
+uint32_t PcmCache::GetEntryCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return static_cast<uint32_t>(m_entries.size());
+}
+
+std::shared_ptr<PcmData const> PcmCache::Find(mule::asset::Handler const& asset)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto lookupIt = m_lookup.find(&asset.GetContent());
+
+    if (m_lookup.end() == lookupIt)
+    {
+        return nullptr;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, lookupIt->second);
+
+    return lookupIt->second->pcm;
+}
+
+void PcmCache::Insert(mule::asset::Handler const& asset, std::shared_ptr<PcmData const> pcm)
+{
+    uint64_t const size = GetDataSize(*pcm);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto lookupIt = m_lookup.find(&asset.GetContent());
+
+    if (m_lookup.end() != lookupIt)
+    {
+        m_size -= lookupIt->second->size;
+        m_entries.erase(lookupIt->second);
+        m_lookup.erase(lookupIt);
+    }
+
+    if (size > m_budget)
+    {
+        LOG_AUDIO->Trace("PcmCache: '{}' exceeds budget ({} > {})", asset.GetName().c_str(), size, m_budget);
+
+        return;
+    }
+
+    m_entries.push_front(Entry{ asset, pcm, size });
+    m_lookup[&asset.GetContent()] = m_entries.begin();
+    m_size += size;
+
+    Evict();
+}
+
+void PcmCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_lookup.clear();
+    m_entries.clear();
+    m_size = 0;
+}
+
+uint64_t PcmCache::GetDataSize(PcmData const& pcm)
+{
+    return static_cast<uint64_t>(pcm.bytes.size());
+}
+
+void PcmCache::Evict()
+{
+    while (m_size > m_budget)
+    {
+        Entry const& entry = m_entries.back();
+
+        LOG_AUDIO->Trace("PcmCache: evicting '{}'", entry.asset.GetName().c_str());
+
+        m_size -= entry.size;
+        m_lookup.erase(&entry.asset.GetContent());
+        m_entries.pop_back();
+    }
+}
+
+}
+}
@@ -0,0 +1,68 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/PcmData.hpp>
+
+#include <tulpar/Kernels.hpp>
+
+#include <cassert>
+
+namespace tulpar
+{
+namespace internal
+{
+
+PcmData PcmData::DownmixToMono(PcmData const& stereo)
+{
+    assert(2 == stereo.channels);
+
+    uint32_t const frameCount = stereo.GetSampleCount() / 2;
+
+    PcmData result;
+    result.channels = 1;
+    result.frequencyHz = stereo.frequencyHz;
+    result.format = stereo.format;
+    result.isDownmixed = true;
+    result.bytes.resize(frameCount * GetSampleSize(stereo.format));
+
+    switch (stereo.format)
+    {
+        case Format::UInt8:
+        {
+            uint8_t const* pIn = static_cast<uint8_t const*>(stereo.GetData());
+
+            for (uint32_t i = 0; i < frameCount; ++i)
+            {
+                result.bytes[i] = static_cast<uint8_t>((pIn[2 * i] + pIn[2 * i + 1]) >> 1);
+            }
+
+            break;
+        }
+        case Format::Int16:
+        {
+            kernels::DownmixStereoToMono(static_cast<int16_t const*>(stereo.GetData())
+                , reinterpret_cast<int16_t*>(result.bytes.data())
+                , frameCount
+            );
+
+            break;
+        }
+        case Format::Float32:
+        {
+            kernels::DownmixStereoToMono(static_cast<float const*>(stereo.GetData())
+                , reinterpret_cast<float*>(result.bytes.data())
+                , frameCount
+            );
+
+            break;
+        }
+    }
+
+    return result;
+}
+
+}
+}
@@ -5,13 +5,66 @@
 */
 
 #include <tulpar/internal/SourceCollection.hpp>
+#include <tulpar/internal/HotPath.hpp>
 
 #include <tulpar/InternalLoggers.hpp>
 
 #include <AL/al.h>
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <vector>
+
+namespace
+{
+
+//! Maximum number of source events kept until consumed
+constexpr size_t s_maxSourceEvents = 4096;
+
+//! Default edge length of spatial grid cells
+constexpr float s_defaultGridCellSize = 32.0f;
+
+//! Signature of OpenAL calls changing state of multiple sources
+using SourcesStateCall = void (AL_APIENTRY*)(ALsizei, ALuint const*);
+
+/** @brief  Changes state of given sources with a single OpenAL call
+ *
+ *  @param  sources valid source handles
+ *  @param  call    vectored OpenAL state call
+ *  @param  action  action name used for logging
+ *
+ *  @return @c true if call succeeded, @c false otherwise
+ */
+bool ApplySourcesState(
+    tulpar::internal::SourceCollection::Handles const& sources
+    , SourcesStateCall call
+    , char const* action
+)
+{
+    if (sources.empty())
+    {
+        return true;
+    }
+
+    std::vector<ALuint> alSources(sources.begin(), sources.end());
+
+    // clear error state
+    ALenum alErr = tulpar::internal::HotPath::ClearError();
+
+    call(static_cast<ALsizei>(alSources.size()), alSources.data());
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Sources ({}): {}: {:#x}", sources.size(), action, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+}
 
 namespace tulpar
 {
@@ -28,7 +81,7 @@ Collection<audio::Source>::Handles OpenAVSourceHandler::Generate(uint32_t batchS
     ALuint* alSources = new ALuint[batchSize];
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     alGenSources(batchSize, alSources);
 
@@ -49,6 +102,9 @@ Collection<audio::Source>::Handles OpenAVSourceHandler::Generate(uint32_t batchS
             alSourcef(index, AL_GAIN, 1);
             alSource3f(index, AL_POSITION, 0, 0, 0);
             alSource3f(index, AL_VELOCITY, 0, 0, 0);
+            alSourcef(index, AL_REFERENCE_DISTANCE, 1);
+            alSourcef(index, AL_MAX_DISTANCE, std::numeric_limits<float>::max());
+            alSourcef(index, AL_ROLLOFF_FACTOR, 1);
             alSourcei(index, AL_LOOPING, AL_FALSE);
 
             return static_cast<Collection<audio::Source>::Handle>(index);
@@ -65,7 +121,7 @@ void OpenAVSourceHandler::Reclaim(Collection<audio::Source>::Handle handle)
     LOG_AUDIO->Trace("Source #{}: reclaim", handle);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     alSourceStop(static_cast<ALuint>(handle));
     alSourcei(static_cast<ALuint>(handle)
@@ -98,7 +154,7 @@ void OpenAVSourceHandler::Delete(Collection<audio::Source>::Handles const& handl
     );
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     alDeleteSources(handles.size(), alSources);
 
@@ -112,15 +168,58 @@ void OpenAVSourceHandler::Delete(Collection<audio::Source>::Handles const& handl
     delete[] alSources;
 }
 
-SourceCollection::SourceCollection(BufferCollection const& buffers
+SourceCollection::SourceCollection(BufferCollection& buffers
     , Collection<audio::Source>::HandleGenerator generator
     , Collection<audio::Source>::HandleReclaimer reclaimer
     , Collection<audio::Source>::HandleDeleter deleter
 )
     : Collection<audio::Source>(generator, reclaimer, deleter)
     , m_buffers(buffers)
+    , m_nextBind(0)
+    , m_grid(s_defaultGridCellSize)
+    , m_streamBufferCount(4)
+    , m_streamBufferFrames(8192)
+#ifdef AL_SOFT_callback_buffer
+    , m_alBufferCallbackSOFT(nullptr)
+#endif
+    , m_isEventDriven(false)
+{
+
+}
+
+SourceCollection::~SourceCollection()
+{
+    while (!m_sourceStreams.empty())
+    {
+        ReleaseSourceStream(m_sourceStreams.begin()->first);
+    }
+
+    while (!m_sourceCallbacks.empty())
+    {
+        ReleaseSourceCallback(m_sourceCallbacks.begin()->first);
+    }
+}
+
+void SourceCollection::SetStreamSettings(uint32_t bufferCount, uint32_t bufferFrames)
 {
+    assert(bufferCount > 1);
+    assert(bufferFrames > 0);
+
+    m_streamBufferCount = bufferCount;
+    m_streamBufferFrames = bufferFrames;
+}
 
+void SourceCollection::QueryCallbackSupport()
+{
+#ifdef AL_SOFT_callback_buffer
+    m_alBufferCallbackSOFT = (AL_TRUE == alIsExtensionPresent("AL_SOFT_callback_buffer"))
+        ? reinterpret_cast<LPALBUFFERCALLBACKSOFT>(alGetProcAddress("alBufferCallbackSOFT"))
+        : nullptr;
+
+    LOG_AUDIO->Debug("Sources: callback buffers: {}", nullptr != m_alBufferCallbackSOFT);
+#else
+    LOG_AUDIO->Debug("Sources: callback buffers: {}", false);
+#endif
 }
 
 namespace
@@ -136,11 +235,29 @@ struct MigrationInfo
 
     ALint sampleOffset;
 
+    std::chrono::nanoseconds cullClock;
+    bool isCulled;
+
+    mule::asset::Handler streamAsset;
+    uint32_t streamFrame;
+    bool isStreamed;
+
+    audio::Source::StreamCallback callback;
+    uint8_t callbackChannels;
+    uint32_t callbackFrequencyHz;
+    audio::Source::SampleFormat callbackFormat;
+    bool isProcedural;
+
     std::array<float, 3> position;
+    std::array<float, 3> velocity;
 
     float pitch;
     float gain;
 
+    float referenceDistance;
+    float maxDistance;
+    float rolloffFactor;
+
     bool isRelative;
     bool isLooping;
 };
@@ -175,6 +292,17 @@ void SourceCollection::InheritCollection(SourceCollection const& other
 
                 migrate.state = other.GetSourceState(handle);
                 tmpSources[i++] = static_cast<ALuint>(handle);
+
+                // offset of culled sources stopped advancing when they were paused
+                auto const culledIt = other.m_culledSources.find(handle);
+
+                migrate.isCulled = (other.m_culledSources.cend() != culledIt);
+                migrate.cullClock = migrate.isCulled ? culledIt->second : std::chrono::nanoseconds(0);
+
+                if (migrate.isCulled)
+                {
+                    migrate.state = audio::Source::State::Playing;
+                }
             }
 
             // pause all old sources
@@ -188,6 +316,25 @@ void SourceCollection::InheritCollection(SourceCollection const& other
                 MigrationInfo& migrate = info[handle];
 
                 migrate.type = other.GetSourceType(handle);
+                migrate.isStreamed = other.IsSourceStreamed(handle);
+
+                if (migrate.isStreamed)
+                {
+                    migrate.streamAsset = other.m_sourceStreams.at(handle).decoder->GetAsset();
+                    migrate.streamFrame = other.GetSourceStreamFrame(handle);
+                }
+
+                migrate.isProcedural = other.IsSourceProcedural(handle);
+
+                if (migrate.isProcedural)
+                {
+                    CallbackStream const& stream = *other.m_sourceCallbacks.at(handle);
+
+                    migrate.callback = stream.callback;
+                    migrate.callbackChannels = stream.channels;
+                    migrate.callbackFrequencyHz = stream.frequencyHz;
+                    migrate.callbackFormat = stream.sampleFormat;
+                }
 
                 switch (migrate.type)
                 {
@@ -198,7 +345,10 @@ void SourceCollection::InheritCollection(SourceCollection const& other
                     }
                     case audio::Source::Type::Streaming:
                     {
-                        migrate.queuedBuffers = other.m_sourceQueuedBuffers.at(handle);
+                        if (!migrate.isStreamed && !migrate.isProcedural)
+                        {
+                            migrate.queuedBuffers = other.m_sourceQueuedBuffers.at(handle);
+                        }
                         break;
                     }
                     default:
@@ -210,10 +360,15 @@ void SourceCollection::InheritCollection(SourceCollection const& other
                 alGetSourcei(static_cast<ALuint>(handle), AL_SAMPLE_OFFSET, &migrate.sampleOffset);
 
                 migrate.position = other.GetSourcePosition(handle);
+                migrate.velocity = other.GetSourceVelocity(handle);
 
                 migrate.pitch = other.GetSourcePitch(handle);
                 migrate.gain = other.GetSourceGain(handle);
 
+                migrate.referenceDistance = other.GetSourceReferenceDistance(handle);
+                migrate.maxDistance = other.GetSourceMaxDistance(handle);
+                migrate.rolloffFactor = other.GetSourceRolloffFactor(handle);
+
                 migrate.isRelative = other.IsSourceRelative(handle);
                 migrate.isLooping = other.IsSourceLooping(handle);
             }
@@ -234,11 +389,11 @@ void SourceCollection::InheritCollection(SourceCollection const& other
                 SourceHandle newHandle = batch[i++];
 
                 {
-                    audio::Source const& oldObject = other.m_objects.at(oldHandle);
+                    audio::Source const& oldObject = other.GetObject(oldHandle);
                     *(oldObject.m_pParent) = this;
                     *(oldObject.m_handle) = newHandle;
 
-                    audio::Source& newObject = m_objects.at(newHandle);
+                    audio::Source& newObject = GetObject(newHandle);
                     newObject = oldObject;
                 }
 
@@ -246,7 +401,11 @@ void SourceCollection::InheritCollection(SourceCollection const& other
                 {
                     case audio::Source::State::Playing:
                     {
-                        tmpSources[playingSources++] = static_cast<ALuint>(newHandle);
+                        // culled sources are resumed from their clock by CullSources()
+                        if (!migrate.isCulled)
+                        {
+                            tmpSources[playingSources++] = static_cast<ALuint>(newHandle);
+                        }
                         break;
                     }
                     default:
@@ -255,51 +414,92 @@ void SourceCollection::InheritCollection(SourceCollection const& other
                     }
                 }
 
-                switch (migrate.type)
+                if (migrate.isStreamed)
                 {
-                    case audio::Source::Type::Static:
-                    {
-                        assert(bufferMapping.cend() != bufferMapping.find(migrate.staticBuffer));
+                    SetSourceStream(newHandle, migrate.streamAsset);
+                    RestartSourceStream(newHandle, migrate.streamFrame);
 
-                        SetSourceStaticBuffer(newHandle, bufferMapping.at(migrate.staticBuffer));
-                        break;
-                    }
-                    case audio::Source::Type::Streaming:
+                    m_sourceStreams.at(newHandle).isPlaying = (audio::Source::State::Playing == migrate.state);
+                }
+                else if (migrate.isProcedural)
+                {
+                    SetSourceCallback(newHandle
+                        , migrate.callback
+                        , migrate.callbackChannels
+                        , migrate.callbackFrequencyHz
+                        , migrate.callbackFormat
+                    );
+
+                    // ring has to be filled before playback is resumed
+                    if (IsSourceProcedural(newHandle) && audio::Source::State::Playing == migrate.state)
                     {
-                        std::vector<audio::Buffer> buffers;
-                        buffers.reserve(migrate.queuedBuffers.size());
-
-                        std::transform(migrate.queuedBuffers.cbegin()
-                            , migrate.queuedBuffers.cend()
-                            , std::back_inserter(buffers)
-                            , [&](BufferHandle const& oldBuffer) -> audio::Buffer
-                            {
-                                assert(bufferMapping.cend() != bufferMapping.find(oldBuffer));
-
-                                return m_buffers.Get(bufferMapping.at(oldBuffer));
-                            }
-                        );
-
-                        QueueSourceBuffers(newHandle, buffers);
-                        break;
+                        RestartSourceCallback(newHandle);
                     }
-                    default:
+                }
+                else
+                {
+                    switch (migrate.type)
                     {
-                        break;
+                        case audio::Source::Type::Static:
+                        {
+                            assert(bufferMapping.cend() != bufferMapping.find(migrate.staticBuffer));
+
+                            SetSourceStaticBuffer(newHandle, bufferMapping.at(migrate.staticBuffer));
+                            break;
+                        }
+                        case audio::Source::Type::Streaming:
+                        {
+                            std::vector<audio::Buffer> buffers;
+                            buffers.reserve(migrate.queuedBuffers.size());
+
+                            std::transform(migrate.queuedBuffers.cbegin()
+                                , migrate.queuedBuffers.cend()
+                                , std::back_inserter(buffers)
+                                , [&](BufferHandle const& oldBuffer) -> audio::Buffer
+                                {
+                                    assert(bufferMapping.cend() != bufferMapping.find(oldBuffer));
+
+                                    return m_buffers.Get(bufferMapping.at(oldBuffer));
+                                }
+                            );
+
+                            QueueSourceBuffers(newHandle, buffers);
+                            break;
+                        }
+                        default:
+                        {
+                            break;
+                        }
                     }
-                }
 
-                alSourcei(static_cast<ALuint>(newHandle), AL_SAMPLE_OFFSET, migrate.sampleOffset);
+                    alSourcei(static_cast<ALuint>(newHandle), AL_SAMPLE_OFFSET, migrate.sampleOffset);
+                }
 
                 SetSourcePosition(newHandle, migrate.position);
+                SetSourceVelocity(newHandle, migrate.velocity);
 
                 SetSourcePitch(newHandle, migrate.pitch);
                 SetSourceGain(newHandle, migrate.gain);
 
+                SetSourceReferenceDistance(newHandle, migrate.referenceDistance);
+                SetSourceMaxDistance(newHandle, migrate.maxDistance);
+                SetSourceRolloffFactor(newHandle, migrate.rolloffFactor);
+
                 SetSourceRelative(newHandle, migrate.isRelative);
                 SetSourceLooping(newHandle, migrate.isLooping);
+
+                m_shadow.state[newHandle] = (audio::Source::State::Playing == migrate.state)
+                    ? audio::Source::State::Playing
+                    : audio::Source::State::Initial;
+
+                if (migrate.isCulled)
+                {
+                    m_culledSources[newHandle] = migrate.cullClock;
+                }
             }
 
+            InheritReferences(other, old, batch);
+
             if (playingSources)
             {
                 alSourcePlayv(playingSources, tmpSources);
@@ -312,10 +512,17 @@ void SourceCollection::InheritCollection(SourceCollection const& other
 
 audio::Buffer SourceCollection::GetSourceActiveBuffer(SourceHandle source) const
 {
+    ConsumerLock lock(m_pCommands);
+
     assert(m_sourceBuffers.cend() != m_sourceBuffers.find(source));
 
     audio::Buffer buffer;
 
+    if (IsSourceStreamed(source) || IsSourceProcedural(source))
+    {
+        return buffer;
+    }
+
     switch (GetSourceType(source))
     {
         case audio::Source::Type::Static:
@@ -355,10 +562,17 @@ audio::Buffer SourceCollection::GetSourceActiveBuffer(SourceHandle source) const
 
 std::vector<audio::Buffer> SourceCollection::GetSourceActiveBuffers(SourceHandle source) const
 {
+    ConsumerLock lock(m_pCommands);
+
     assert(m_sourceBuffers.cend() != m_sourceBuffers.find(source));
 
     std::vector<audio::Buffer> queue;
 
+    if (IsSourceStreamed(source) || IsSourceProcedural(source))
+    {
+        return queue;
+    }
+
     switch (GetSourceType(source))
     {
         case audio::Source::Type::Static:
@@ -384,6 +598,8 @@ std::vector<audio::Buffer> SourceCollection::GetSourceActiveBuffers(SourceHandle
 
 audio::Buffer SourceCollection::GetSourceStaticBuffer(SourceHandle source) const
 {
+    ConsumerLock lock(m_pCommands);
+
     assert(m_sourceBuffers.cend() != m_sourceBuffers.find(source));
 
     return m_buffers.Get(m_sourceBuffers.at(source));
@@ -393,12 +609,28 @@ bool SourceCollection::SetSourceStaticBuffer(SourceHandle source, BufferHandle b
 {
     assert(IsValid(source));
 
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeHandle(Command::Type::SourceStaticBuffer, source, buffer));
+
+        return true;
+    }
+
     LOG_AUDIO->Debug("Source #{}: buffer = #{}", source, buffer);
 
-    m_sourceBuffers[source] = buffer;
+    ReleaseSourceStream(source);
+    ReleaseSourceCallback(source);
+
+    // evicted data has to be reloaded before it is attached
+    if (!m_buffers.AcquireBuffer(buffer))
+    {
+        LOG_AUDIO->Warning("Source #{}: buffer = #{}: data is not available", source, buffer);
+
+        return false;
+    }
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     alSourcei(static_cast<ALuint>(source)
         , AL_BUFFER
@@ -409,27 +641,27 @@ bool SourceCollection::SetSourceStaticBuffer(SourceHandle source, BufferHandle b
 
     if (AL_NO_ERROR == alErr)
     {
-        using namespace std::chrono_literals;
+        ReleaseSourceBuffers(source);
+
+        m_sourceBuffers[source] = buffer;
 
         Meta& meta = m_sourceMeta[source];
 
+        ClearMeta(meta);
+
         if (0 != buffer)
         {
             audio::Buffer buf = m_buffers.Get(buffer);
 
-            meta.activeSampleCount = buf.GetSampleCount();
-            meta.activeTotalDuration = buf.GetDuration();
-        }
-        else
-        {
-            meta.activeSampleCount = 0;
-            meta.activeTotalDuration = 0ns;
+            AppendMeta(meta, buf.GetSampleCount() / std::max<uint32_t>(buf.GetChannelCount(), 1), buf.GetFrequencyHz());
         }
 
         m_sourceQueuedBuffers[source].clear();
     }
     else
     {
+        m_buffers.ReleaseBuffer(buffer);
+
         LOG_AUDIO->Warning("Source #{}: buffer = #{}: {:#x}", source, buffer, alErr);
     }
 
@@ -438,12 +670,19 @@ bool SourceCollection::SetSourceStaticBuffer(SourceHandle source, BufferHandle b
 
 std::vector<audio::Buffer> SourceCollection::GetSourceQueuedBuffers(SourceHandle source) const
 {
+    ConsumerLock lock(m_pCommands);
+
     assert(IsValid(source));
 
     std::vector<audio::Buffer> result;
 
+    if (IsSourceStreamed(source) || IsSourceProcedural(source))
+    {
+        return result;
+    }
+
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     ALint alQueueLength;
     alGetSourcei(static_cast<ALuint>(source), AL_BUFFERS_QUEUED, &alQueueLength);
@@ -481,10 +720,12 @@ std::vector<audio::Buffer> SourceCollection::GetSourceQueuedBuffers(SourceHandle
 
 uint32_t SourceCollection::GetSourceQueueIndex(SourceHandle source) const
 {
+    ConsumerLock lock(m_pCommands);
+
     assert(IsValid(source));
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     ALint alQueueIndex;
     alGetSourcei(static_cast<ALuint>(source), AL_BUFFERS_PROCESSED, &alQueueIndex);
@@ -504,19 +745,48 @@ bool SourceCollection::QueueSourceBuffers(SourceHandle source, std::vector<audio
 {
     assert(IsValid(source));
 
+    if (IsDeferringCommands())
+    {
+        PendingBind pending;
+
+        pending.kind = PendingBind::Kind::Queue;
+        pending.buffers = buffers;
+
+        PushCommand(Command::MakeHandle(Command::Type::SourceQueueBuffers, source, StorePendingBind(std::move(pending))));
+
+        return true;
+    }
+
     LOG_AUDIO->Debug("Source #{}: set buffer queue[{}]", source, buffers.size());
 
-    std::vector<ALuint> tmp(buffers.size(), 0);
+    ReleaseSourceStream(source);
+    ReleaseSourceCallback(source);
+
+    std::vector<ALuint> tmp;
+    tmp.reserve(buffers.size());
 
-    std::transform(buffers.begin(), buffers.end(), tmp.begin(),
-        [](audio::Buffer const& buffer) -> ALuint
+    // evicted data has to be reloaded before it is queued
+    for (audio::Buffer const& buffer : buffers)
+    {
+        BufferHandle const handle = *(buffer.GetSharedHandle());
+
+        if (!m_buffers.AcquireBuffer(handle))
         {
-            return static_cast<ALuint>(*(buffer.GetSharedHandle()));
+            for (ALuint acquired : tmp)
+            {
+                m_buffers.ReleaseBuffer(static_cast<BufferHandle>(acquired));
+            }
+
+            LOG_AUDIO->Warning("Source #{}: set buffer queue[{}]: buffer #{} data is not available", source, buffers.size(), handle);
+
+            return false;
         }
-    );
+
+        tmp.push_back(static_cast<ALuint>(handle));
+    }
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
     alSourceQueueBuffers(static_cast<ALuint>(source), tmp.size(), tmp.data());
 
@@ -524,664 +794,2911 @@ bool SourceCollection::QueueSourceBuffers(SourceHandle source, std::vector<audio
 
     if (AL_NO_ERROR == alErr)
     {
-        using namespace std::chrono_literals;
-
         std::vector<BufferHandle>& queue = m_sourceQueuedBuffers[source];
-        queue.reserve(buffers.size());
-
         Meta& meta = m_sourceMeta[source];
 
-        meta.activeSampleCount = 0;
-        meta.activeTotalDuration = 0ns;
+        // buffers are appended to the queue, offsets count from its head
+        if (queue.empty())
+        {
+            ClearMeta(meta);
+        }
+
+        queue.reserve(queue.size() + buffers.size());
 
         for (audio::Buffer const& buffer : buffers)
         {
-            meta.activeSampleCount += buffer.GetSampleCount();
-            meta.activeTotalDuration += buffer.GetDuration();
+            AppendMeta(meta, buffer.GetSampleCount() / std::max<uint32_t>(buffer.GetChannelCount(), 1), buffer.GetFrequencyHz());
 
             queue.push_back(*(buffer.GetSharedHandle()));
         }
 
+        m_buffers.ReleaseBuffer(m_sourceBuffers[source]);
         m_sourceBuffers[source] = *(audio::Buffer().GetSharedHandle());
     }
     else
     {
+        for (ALuint buffer : tmp)
+        {
+            m_buffers.ReleaseBuffer(static_cast<BufferHandle>(buffer));
+        }
+
         LOG_AUDIO->Warning("Source #{}: set buffer queue[{}]: {:#x}", source, tmp.size(), alErr);
     }
 
     return AL_NO_ERROR == alErr;
 }
 
-void SourceCollection::ResetSource(SourceHandle source)
+bool SourceCollection::SetSourceStream(SourceHandle source, mule::asset::Handler asset)
 {
     assert(IsValid(source));
 
-    LOG_AUDIO->Debug("Source #{}: reset", source);
+    if (IsDeferringCommands())
+    {
+        PendingBind pending;
 
-    ResetSourceMeta(source);
-    Reclaim(source);
+        pending.kind = PendingBind::Kind::Stream;
+        pending.asset = std::move(asset);
 
-    m_sourceMeta.erase(source);
-    m_sourceBuffers.erase(source);
-    m_sourceQueuedBuffers.erase(source);
-}
+        PushCommand(Command::MakeHandle(Command::Type::SourceStream, source, StorePendingBind(std::move(pending))));
 
-bool SourceCollection::PlaySource(SourceHandle source)
-{
-    assert(IsValid(source));
+        return true;
+    }
 
-    LOG_AUDIO->Debug("Source #{}: play", source);
+    LOG_AUDIO->Debug("Source #{}: set stream '{}'", source, asset.GetName().c_str());
 
-    // clear error state
-    ALenum alErr = alGetError();
+    bool const isLooping = IsSourceLooping(source);
 
-    alSourcePlay(static_cast<ALuint>(source));
+    SetSourceStaticBuffer(source, *(audio::Buffer().GetSharedHandle()));
 
-    alErr = alGetError();
+    std::unique_ptr<VorbisStream> decoder(new VorbisStream());
 
-    if (AL_NO_ERROR != alErr)
+    if (!decoder->Open(asset))
     {
-        LOG_AUDIO->Warning("Source #{}: play: {:#x}", source, alErr);
+        return false;
     }
 
-    return AL_NO_ERROR == alErr;
-}
-
-bool SourceCollection::StopSource(SourceHandle source)
-{
-    assert(IsValid(source));
-
-    LOG_AUDIO->Debug("Source #{}: stop", source);
+    std::vector<ALuint> alBuffers(m_streamBufferCount, 0);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
-    alSourceStop(static_cast<ALuint>(source));
+    alGenBuffers(m_streamBufferCount, alBuffers.data());
+    alSourcei(static_cast<ALuint>(source), AL_LOOPING, AL_FALSE);
 
     alErr = alGetError();
 
     if (AL_NO_ERROR != alErr)
     {
-        LOG_AUDIO->Warning("Source #{}: stop: {:#x}", source, alErr);
-    }
-
-    return AL_NO_ERROR == alErr;
-}
+        LOG_AUDIO->Warning("Source #{}: set stream: {:#x}", source, alErr);
 
-bool SourceCollection::RewindSource(SourceHandle source)
-{
-    assert(IsValid(source));
+        alDeleteBuffers(m_streamBufferCount, alBuffers.data());
 
-    LOG_AUDIO->Debug("Source #{}: rewind", source);
+        return false;
+    }
 
-    // clear error state
-    ALenum alErr = alGetError();
+    m_shadow.isLooping[source] = 0;
 
-    alSourceRewind(static_cast<ALuint>(source));
+    Stream& stream = m_sourceStreams[source];
 
-    alErr = alGetError();
+    stream.decoder = std::move(decoder);
+    stream.buffers.assign(alBuffers.cbegin(), alBuffers.cend());
+    stream.isLooping = isLooping;
 
-    if (AL_NO_ERROR != alErr)
     {
-        LOG_AUDIO->Warning("Source #{}: rewind: {:#x}", source, alErr);
+        VorbisStream const& vorbis = *stream.decoder;
+        Meta& meta = m_sourceMeta[source];
+
+        ClearMeta(meta);
+        AppendMeta(meta, vorbis.GetFrameCount(), vorbis.GetFrequencyHz());
     }
 
-    return AL_NO_ERROR == alErr;
+    return RestartSourceStream(source, 0);
 }
 
-bool SourceCollection::PauseSource(SourceHandle source)
+bool SourceCollection::IsSourceStreamed(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    return m_sourceStreams.cend() != m_sourceStreams.find(source);
+}
+
+bool SourceCollection::SetSourceCallback(SourceHandle source
+    , audio::Source::StreamCallback callback
+    , uint8_t channels
+    , uint32_t frequencyHz
+    , audio::Source::SampleFormat format
+)
 {
     assert(IsValid(source));
+    assert(nullptr != callback);
 
-    LOG_AUDIO->Debug("Source #{}: pause", source);
+    PcmData::Format const pcmFormat = (audio::Source::SampleFormat::Float32 == format)
+        ? PcmData::Format::Float32
+        : PcmData::Format::Int16;
 
-    // clear error state
-    ALenum alErr = alGetError();
+    ALenum const alFormat = m_buffers.GetFormat(pcmFormat, channels);
 
-    alSourcePause(static_cast<ALuint>(source));
+    if (AL_NONE == alFormat || 0 == frequencyHz)
+    {
+        LOG_AUDIO->Warning("Source #{}: {} channel callback layout is not supported", source, channels);
 
-    alErr = alGetError();
+        return false;
+    }
 
-    if (AL_NO_ERROR != alErr)
+    if (IsDeferringCommands())
     {
-        LOG_AUDIO->Warning("Source #{}: pause: {:#x}", source, alErr);
+        PendingBind pending;
+
+        pending.kind = PendingBind::Kind::Callback;
+        pending.callback = std::move(callback);
+        pending.channels = channels;
+        pending.frequencyHz = frequencyHz;
+        pending.format = format;
+
+        PushCommand(Command::MakeHandle(Command::Type::SourceCallback, source, StorePendingBind(std::move(pending))));
+
+        return true;
     }
 
-    return AL_NO_ERROR == alErr;
-}
+    LOG_AUDIO->Debug("Source #{}: set callback, {} channels, {} Hz", source, channels, frequencyHz);
 
-std::chrono::nanoseconds SourceCollection::GetSourcePlaybackDuration(SourceHandle source) const
-{
-    assert(IsValid(source));
+    SetSourceStaticBuffer(source, *(audio::Buffer().GetSharedHandle()));
 
-    return m_sourceMeta.at(source).activeTotalDuration;
-}
+    std::unique_ptr<CallbackStream> stream(new CallbackStream());
 
-std::chrono::nanoseconds SourceCollection::GetSourcePlaybackPosition(SourceHandle source) const
-{
-    assert(IsValid(source));
+    stream->callback = std::move(callback);
+    stream->channels = channels;
+    stream->frequencyHz = frequencyHz;
+    stream->sampleFormat = format;
+    stream->format = alFormat;
+    stream->frameSize = channels * PcmData::GetSampleSize(pcmFormat);
 
-    std::chrono::nanoseconds result(0);
+#ifdef AL_SOFT_callback_buffer
+    stream->isCallbackBuffer = (nullptr != m_alBufferCallbackSOFT);
+#endif
+
+    ALuint const index = static_cast<ALuint>(source);
+    uint32_t const bufferCount = stream->isCallbackBuffer ? 1 : m_streamBufferCount;
+
+    std::vector<ALuint> alBuffers(bufferCount, 0);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
-    ALint sampleOffset;
-    alGetSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, &sampleOffset);
+    alGenBuffers(bufferCount, alBuffers.data());
+    alSourcei(index, AL_LOOPING, AL_FALSE);
+
+#ifdef AL_SOFT_callback_buffer
+    if (stream->isCallbackBuffer)
+    {
+        m_alBufferCallbackSOFT(alBuffers[0], alFormat, frequencyHz, &SourceCollection::HandleBufferCallback, stream.get());
+        alSourcei(index, AL_BUFFER, alBuffers[0]);
+    }
+#endif
 
     alErr = alGetError();
 
-    if (AL_NO_ERROR == alErr)
+    if (AL_NO_ERROR != alErr)
     {
-        audio::Source::State const state = GetSourceState(source);
-
-        if (sampleOffset > 0
-            && ((audio::Source::State::Playing == state)
-                || (audio::Source::State::Paused == state))
-        )
-        {
-            std::vector<audio::Buffer> buffers = GetSourceActiveBuffers(source);
-            double timeNs = 0.0;
-            uint32_t i = 0;
+        LOG_AUDIO->Warning("Source #{}: set callback: {:#x}", source, alErr);
 
-            while (sampleOffset > 0)
-            {
-                // get buffer
-                audio::Buffer const& buffer = buffers.at(i);
-
-                // check how many samples from this buffer we can consume
-                uint32_t const consumedSamples = std::min(
-                    static_cast<uint32_t>(sampleOffset)
-                    , buffer.GetSampleCount()
-                );
-
-                // calculate time based on this buffer properties
-                timeNs += (static_cast<double>(consumedSamples)
-                        / static_cast<double>(buffer.GetFrequencyHz()))
-                    * 1e9;
-
-                // remove consumed samples
-                sampleOffset -= consumedSamples;
-                ++i;
-            }
+        alSourcei(index, AL_BUFFER, 0);
+        alDeleteBuffers(bufferCount, alBuffers.data());
 
-            result = std::chrono::nanoseconds(static_cast<uint64_t>(std::round(timeNs)));
-        }
+        return false;
     }
-    else
+
+    m_shadow.isLooping[source] = 0;
+
+    stream->buffers.assign(alBuffers.cbegin(), alBuffers.cend());
+
+    if (!stream->isCallbackBuffer)
     {
-        LOG_AUDIO->Warning("Source #{}: get playback position: {:#x}", source, alErr);
+        stream->freeBuffers = stream->buffers;
     }
 
-    return result;
+    m_sourceCallbacks[source] = std::move(stream);
+
+    return true;
 }
 
-bool SourceCollection::SetSourcePlaybackPosition(SourceHandle source, std::chrono::nanoseconds offset)
+bool SourceCollection::IsSourceProcedural(SourceHandle source) const
 {
-    assert(IsValid(source));
-
-    LOG_AUDIO->Debug("Source #{}: set playback position {}ns", source, offset.count());
+    ConsumerLock lock(m_pCommands);
 
-    audio::Buffer buffer = GetSourceActiveBuffer(source);
+    return m_sourceCallbacks.cend() != m_sourceCallbacks.find(source);
+}
 
-    ALint sampleOffset = 0;
+bool SourceCollection::ApplySourceBind(SourceHandle source, uint32_t bind)
+{
+    PendingBind pending;
 
     {
-        std::vector<audio::Buffer> buffers = GetSourceActiveBuffers(source);
-        uint64_t offsetNs = offset.count();
-        uint32_t i = 0;
+        std::lock_guard<std::mutex> lock(m_bindMutex);
 
-        while (offsetNs > 0)
-        {
-            // get buffer
-            audio::Buffer const& buffer = buffers.at(i);
+        auto const bindIt = m_pendingBinds.find(bind);
 
-            // check how much time from this buffer we can consume
-            uint64_t const consumedTime = std::min(
-                offsetNs
-                , static_cast<uint64_t>(buffer.GetDuration().count())
-            );
+        if (m_pendingBinds.end() == bindIt)
+        {
+            return false;
+        }
 
-            // calculate time based on this buffer properties
-            uint32_t const sampleCount = buffer.GetFrequencyHz()
-                * (static_cast<double>(consumedTime) * 1e-9);
+        pending = std::move(bindIt->second);
 
-            sampleOffset += std::min(sampleCount, buffer.GetSampleCount());
+        m_pendingBinds.erase(bindIt);
+    }
 
-            // removed consumed time
-            offsetNs -= consumedTime;
-            ++i;
+    switch (pending.kind)
+    {
+        case PendingBind::Kind::Queue:
+        {
+            return QueueSourceBuffers(source, pending.buffers);
+        }
+        case PendingBind::Kind::Stream:
+        {
+            return SetSourceStream(source, std::move(pending.asset));
+        }
+        case PendingBind::Kind::Callback:
+        {
+            return SetSourceCallback(source, std::move(pending.callback), pending.channels, pending.frequencyHz, pending.format);
         }
     }
 
+    return false;
+}
 
-    // clear error state
-    ALenum alErr = alGetError();
+void SourceCollection::DiscardSourceBind(uint32_t bind)
+{
+    std::lock_guard<std::mutex> lock(m_bindMutex);
 
-    alSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, sampleOffset);
+    m_pendingBinds.erase(bind);
+}
 
-    alErr = alGetError();
+uint32_t SourceCollection::StorePendingBind(PendingBind pending)
+{
+    std::lock_guard<std::mutex> lock(m_bindMutex);
+
+    uint32_t const bind = m_nextBind++;
+
+    m_pendingBinds[bind] = std::move(pending);
+
+    return bind;
+}
+
+bool SourceCollection::ApplySourceBatch(Command::Type type, uint32_t batch)
+{
+    PendingBatch pending;
+
+    {
+        std::lock_guard<std::mutex> lock(m_bindMutex);
+
+        auto const batchIt = m_pendingBatches.find(batch);
+
+        if (m_pendingBatches.end() == batchIt)
+        {
+            return false;
+        }
+
+        pending = std::move(batchIt->second);
+
+        m_pendingBatches.erase(batchIt);
+    }
+
+    Handles sources;
+    sources.reserve(pending.sources.size());
+
+    for (size_t i = 0; i < pending.sources.size(); ++i)
+    {
+        if (IsValid(pending.sources[i], pending.generations[i]))
+        {
+            sources.push_back(pending.sources[i]);
+        }
+        else
+        {
+            LOG_AUDIO->Warning("Source #{}: dropping batched state change", pending.sources[i]);
+        }
+    }
+
+    switch (type)
+    {
+        case Command::Type::SourcesPlay:
+        {
+            return PlaySources(sources);
+        }
+        case Command::Type::SourcesStop:
+        {
+            return StopSources(sources);
+        }
+        case Command::Type::SourcesRewind:
+        {
+            return RewindSources(sources);
+        }
+        case Command::Type::SourcesPause:
+        {
+            return PauseSources(sources);
+        }
+        default:
+        {
+            assert(false);
+
+            return false;
+        }
+    }
+}
+
+bool SourceCollection::AreSourcesValid(Handles const& sources, char const* action) const
+{
+    for (SourceHandle source : sources)
+    {
+        if (!IsValid(source))
+        {
+            LOG_AUDIO->Warning("Sources ({}): {}: source #{} is not valid", sources.size(), action, source);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SourceCollection::PushSourceBatch(Command::Type type, Handles const& sources)
+{
+    if (sources.empty())
+    {
+        return;
+    }
+
+    PendingBatch pending;
+
+    pending.sources = sources;
+    pending.generations.reserve(sources.size());
+
+    for (SourceHandle source : sources)
+    {
+        pending.generations.push_back(GetGeneration(source));
+    }
+
+    uint32_t batch;
+
+    {
+        std::lock_guard<std::mutex> lock(m_bindMutex);
+
+        batch = m_nextBind++;
+
+        m_pendingBatches[batch] = std::move(pending);
+    }
+
+    // batch is validated per source when applied
+    PushCommand(Command::MakeHandle(type, sources.front(), batch));
+}
+
+void SourceCollection::UpdateSourceStreams()
+{
+    for (auto& streamIt : m_sourceStreams)
+    {
+        ALuint const index = static_cast<ALuint>(streamIt.first);
+        Stream& stream = streamIt.second;
+
+        // without events queues are polled every update
+        if (m_isEventDriven && !stream.isPending)
+        {
+            continue;
+        }
+
+        stream.isPending = !m_isEventDriven;
+
+        ALint processed = 0;
+        ALint alState = AL_STOPPED;
+
+        // clear error state
+        ALenum alErr = HotPath::ClearError();
+
+        alGetSourcei(index, AL_BUFFERS_PROCESSED, &processed);
+
+        for (ALint i = 0; i < processed; ++i)
+        {
+            ALuint buffer = 0;
+
+            alSourceUnqueueBuffers(index, 1, &buffer);
+
+            if (!stream.queuedFrames.empty())
+            {
+                stream.queueStartFrame = (stream.queueStartFrame + stream.queuedFrames.front())
+                    % std::max(stream.decoder->GetFrameCount(), 1u);
+                stream.queuedFrames.pop_front();
+            }
+
+            if (FillStreamBuffer(stream, static_cast<BufferHandle>(buffer)))
+            {
+                alSourceQueueBuffers(index, 1, &buffer);
+            }
+        }
+
+        alGetSourcei(index, AL_SOURCE_STATE, &alState);
+
+        if (stream.isPlaying && AL_STOPPED == alState)
+        {
+            if (stream.queuedFrames.empty())
+            {
+                // stream is over
+                stream.isPlaying = false;
+
+                m_shadow.state[streamIt.first] = audio::Source::State::Stopped;
+                PushSourceEvent(audio::SourceEvent::Type::Stopped, streamIt.first, 0);
+            }
+            else
+            {
+                LOG_AUDIO->Debug("Source #{}: stream underrun", streamIt.first);
+
+                alSourcePlay(index);
+            }
+        }
+
+        alErr = alGetError();
+
+        if (AL_NO_ERROR != alErr)
+        {
+            LOG_AUDIO->Warning("Source #{}: update stream: {:#x}", streamIt.first, alErr);
+        }
+    }
+
+    for (auto& callbackIt : m_sourceCallbacks)
+    {
+        ALuint const index = static_cast<ALuint>(callbackIt.first);
+        CallbackStream& stream = *callbackIt.second;
+
+        // callback buffers are pulled by OpenAL, paused and stopped rings keep their data
+        if (stream.isCallbackBuffer
+            || audio::Source::State::Playing != m_shadow.state[callbackIt.first]
+            || (m_isEventDriven && !stream.isPending))
+        {
+            continue;
+        }
+
+        stream.isPending = !m_isEventDriven;
+
+        ALint processed = 0;
+        ALint alState = AL_STOPPED;
+
+        // clear error state
+        ALenum alErr = HotPath::ClearError();
+
+        alGetSourcei(index, AL_BUFFERS_PROCESSED, &processed);
+
+        for (ALint i = 0; i < processed; ++i)
+        {
+            ALuint buffer = 0;
+
+            alSourceUnqueueBuffers(index, 1, &buffer);
+
+            stream.freeBuffers.push_back(static_cast<BufferHandle>(buffer));
+        }
+
+        FillSourceCallbackQueue(callbackIt.first, stream);
+
+        alGetSourcei(index, AL_SOURCE_STATE, &alState);
+
+        if (AL_STOPPED == alState)
+        {
+            if (stream.freeBuffers.size() == stream.buffers.size())
+            {
+                // callback reported the end of data and all of it was played
+                m_shadow.state[callbackIt.first] = audio::Source::State::Stopped;
+                PushSourceEvent(audio::SourceEvent::Type::Stopped, callbackIt.first, 0);
+            }
+            else
+            {
+                LOG_AUDIO->Debug("Source #{}: callback underrun", callbackIt.first);
+
+                alSourcePlay(index);
+            }
+        }
+
+        alErr = alGetError();
+
+        if (AL_NO_ERROR != alErr)
+        {
+            LOG_AUDIO->Warning("Source #{}: update callback: {:#x}", callbackIt.first, alErr);
+        }
+    }
+}
+
+void SourceCollection::HandleEvent(Context::EventType type, ALuint source, ALuint param, void* pUserData)
+{
+    SourceCollection* pCollection = static_cast<SourceCollection*>(pUserData);
+
+    SourceHandle const handle = static_cast<SourceHandle>(source);
+    Generation const generation = pCollection->GetGeneration(handle);
+
+    std::lock_guard<std::mutex> lock(pCollection->m_eventMutex);
+
+    pCollection->m_pendingEvents.push_back(PendingEvent{ type, handle, generation, param });
+}
+
+void SourceCollection::UpdateSourceEvents()
+{
+    if (!m_isEventDriven)
+    {
+        for (SourceHandle source : m_used)
+        {
+            if (audio::Source::State::Playing == m_shadow.state[source]
+                && !IsSourceStreamed(source)
+                && !IsSourceBufferRing(source))
+            {
+                RefreshSourceState(source);
+            }
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+
+        m_receivedEvents.swap(m_pendingEvents);
+    }
+
+    for (PendingEvent const& event : m_receivedEvents)
+    {
+        // source might have been reset or even spawned again after the event was received
+        if (!IsValid(event.source, event.generation))
+        {
+            continue;
+        }
+
+        auto streamIt = m_sourceStreams.find(event.source);
+
+        if (m_sourceStreams.end() != streamIt)
+        {
+            streamIt->second.isPending = true;
+
+            continue;
+        }
+
+        auto callbackIt = m_sourceCallbacks.find(event.source);
+
+        if (m_sourceCallbacks.end() != callbackIt)
+        {
+            callbackIt->second->isPending = true;
+
+            // ring sources are handled by UpdateSourceStreams(), callback buffers are not reported
+            if (!callbackIt->second->isCallbackBuffer || Context::EventType::BufferCompleted == event.type)
+            {
+                continue;
+            }
+        }
+
+        switch (event.type)
+        {
+            case Context::EventType::SourceStateChanged:
+            {
+                if (AL_STOPPED == static_cast<ALint>(event.param))
+                {
+                    RefreshSourceState(event.source);
+                }
+                break;
+            }
+            case Context::EventType::BufferCompleted:
+            {
+                PushSourceEvent(audio::SourceEvent::Type::BufferCompleted, event.source, event.param);
+                break;
+            }
+        }
+    }
+
+    m_receivedEvents.clear();
+}
+
+std::vector<audio::SourceEvent> SourceCollection::ConsumeSourceEvents()
+{
+    std::vector<audio::SourceEvent> result;
+    result.swap(m_events);
+
+    return result;
+}
+
+void SourceCollection::ResetSource(SourceHandle source)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::SourceReset, source));
+
+        return;
+    }
+
+    LOG_AUDIO->Debug("Source #{}: reset", source);
+
+    m_culledSources.erase(source);
+    m_grid.Remove(source);
+
+    ResetSourceMeta(source);
+    ReleaseSourceStream(source);
+    ReleaseSourceCallback(source);
+    Reclaim(source);
+
+    m_shadow.state[source] = audio::Source::State::Stopped;
+
+    // buffers are detached by reclaimer, so they can be evicted now
+    ReleaseSourceBuffers(source);
+
+    m_sourceMeta.erase(source);
+    m_sourceBuffers.erase(source);
+    m_sourceQueuedBuffers.erase(source);
+}
+
+bool SourceCollection::PlaySource(SourceHandle source)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::SourcePlay, source));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: play", source);
+
+    RestoreCulledSource(source);
+
+    if (IsSourceStreamed(source))
+    {
+        // restart stream that was stopped or is over
+        if (audio::Source::State::Stopped == GetSourceState(source))
+        {
+            RestartSourceStream(source, 0);
+        }
+
+        Stream& stream = m_sourceStreams.at(source);
+        stream.isPlaying = true;
+        stream.isPending = true;
+    }
+    else if (IsSourceProcedural(source))
+    {
+        RestartSourceCallback(source);
+    }
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcePlay(static_cast<ALuint>(source));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: play: {:#x}", source, alErr);
+    }
+    else
+    {
+        m_shadow.state[source] = audio::Source::State::Playing;
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+bool SourceCollection::StopSource(SourceHandle source)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::SourceStop, source));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: stop", source);
+
+    RestoreCulledSource(source);
+
+    if (IsSourceStreamed(source))
+    {
+        m_sourceStreams.at(source).isPlaying = false;
+    }
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourceStop(static_cast<ALuint>(source));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: stop: {:#x}", source, alErr);
+    }
+    else
+    {
+        m_shadow.state[source] = audio::Source::State::Stopped;
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+bool SourceCollection::RewindSource(SourceHandle source)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::SourceRewind, source));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: rewind", source);
+
+    RestoreCulledSource(source);
+
+    if (IsSourceStreamed(source))
+    {
+        m_sourceStreams.at(source).isPlaying = false;
+
+        RestartSourceStream(source, 0);
+    }
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourceRewind(static_cast<ALuint>(source));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: rewind: {:#x}", source, alErr);
+    }
+    else
+    {
+        m_shadow.state[source] = audio::Source::State::Initial;
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+bool SourceCollection::PauseSource(SourceHandle source)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::SourcePause, source));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: pause", source);
+
+    RestoreCulledSource(source);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcePause(static_cast<ALuint>(source));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: pause: {:#x}", source, alErr);
+    }
+    else if (audio::Source::State::Playing == m_shadow.state[source])
+    {
+        m_shadow.state[source] = audio::Source::State::Paused;
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+bool SourceCollection::PlaySources(Handles const& sources)
+{
+    if (!AreSourcesValid(sources, "play"))
+    {
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushSourceBatch(Command::Type::SourcesPlay, sources);
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Sources ({}): play", sources.size());
+
+    for (SourceHandle source : sources)
+    {
+        RestoreCulledSource(source);
+
+        if (IsSourceStreamed(source))
+        {
+            if (audio::Source::State::Stopped == GetSourceState(source))
+            {
+                RestartSourceStream(source, 0);
+            }
+
+            Stream& stream = m_sourceStreams.at(source);
+            stream.isPlaying = true;
+            stream.isPending = true;
+        }
+        else if (IsSourceProcedural(source))
+        {
+            RestartSourceCallback(source);
+        }
+    }
+
+    if (!ApplySourcesState(sources, alSourcePlayv, "play"))
+    {
+        return false;
+    }
+
+    for (SourceHandle source : sources)
+    {
+        m_shadow.state[source] = audio::Source::State::Playing;
+    }
+
+    return true;
+}
+
+bool SourceCollection::StopSources(Handles const& sources)
+{
+    if (!AreSourcesValid(sources, "stop"))
+    {
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushSourceBatch(Command::Type::SourcesStop, sources);
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Sources ({}): stop", sources.size());
+
+    for (SourceHandle source : sources)
+    {
+        RestoreCulledSource(source);
+
+        if (IsSourceStreamed(source))
+        {
+            m_sourceStreams.at(source).isPlaying = false;
+        }
+    }
+
+    if (!ApplySourcesState(sources, alSourceStopv, "stop"))
+    {
+        return false;
+    }
+
+    for (SourceHandle source : sources)
+    {
+        m_shadow.state[source] = audio::Source::State::Stopped;
+    }
+
+    return true;
+}
+
+bool SourceCollection::RewindSources(Handles const& sources)
+{
+    if (!AreSourcesValid(sources, "rewind"))
+    {
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushSourceBatch(Command::Type::SourcesRewind, sources);
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Sources ({}): rewind", sources.size());
+
+    for (SourceHandle source : sources)
+    {
+        RestoreCulledSource(source);
+
+        if (IsSourceStreamed(source))
+        {
+            m_sourceStreams.at(source).isPlaying = false;
+
+            RestartSourceStream(source, 0);
+        }
+    }
+
+    if (!ApplySourcesState(sources, alSourceRewindv, "rewind"))
+    {
+        return false;
+    }
+
+    for (SourceHandle source : sources)
+    {
+        m_shadow.state[source] = audio::Source::State::Initial;
+    }
+
+    return true;
+}
+
+bool SourceCollection::PauseSources(Handles const& sources)
+{
+    if (!AreSourcesValid(sources, "pause"))
+    {
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushSourceBatch(Command::Type::SourcesPause, sources);
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Sources ({}): pause", sources.size());
+
+    for (SourceHandle source : sources)
+    {
+        RestoreCulledSource(source);
+    }
+
+    if (!ApplySourcesState(sources, alSourcePausev, "pause"))
+    {
+        return false;
+    }
+
+    for (SourceHandle source : sources)
+    {
+        if (audio::Source::State::Playing == m_shadow.state[source])
+        {
+            m_shadow.state[source] = audio::Source::State::Paused;
+        }
+    }
+
+    return true;
+}
+
+std::chrono::nanoseconds SourceCollection::GetSourcePlaybackDuration(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+    return m_sourceMeta.at(source).activeTotalDuration;
+}
+
+std::chrono::nanoseconds SourceCollection::GetSourcePlaybackPosition(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+    auto const culledIt = m_culledSources.find(source);
+
+    if (m_culledSources.end() != culledIt)
+    {
+        return culledIt->second;
+    }
+
+    std::chrono::nanoseconds result(0);
+
+    if (IsSourceStreamed(source))
+    {
+        audio::Source::State const state = GetSourceState(source);
+
+        if ((audio::Source::State::Playing == state)
+            || (audio::Source::State::Paused == state)
+        )
+        {
+            double const timeNs = 1e9 * (static_cast<double>(GetSourceStreamFrame(source))
+                / static_cast<double>(m_sourceStreams.at(source).decoder->GetFrequencyHz()));
+
+            result = std::chrono::nanoseconds(static_cast<uint64_t>(std::round(timeNs)));
+        }
+
+        return result;
+    }
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALint sampleOffset;
+    alGetSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, &sampleOffset);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        audio::Source::State const state = GetSourceState(source);
+
+        if (sampleOffset > 0
+            && ((audio::Source::State::Playing == state)
+                || (audio::Source::State::Paused == state))
+        )
+        {
+            double const timeNs = GetMetaTime(m_sourceMeta.at(source), static_cast<uint32_t>(sampleOffset));
+
+            result = std::chrono::nanoseconds(static_cast<uint64_t>(std::round(timeNs)));
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: get playback position: {:#x}", source, alErr);
+    }
+
+    return result;
+}
+
+bool SourceCollection::SetSourcePlaybackPosition(SourceHandle source, std::chrono::nanoseconds offset)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeTime(Command::Type::SourcePlaybackPosition, source, offset));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Source #{}: set playback position {}ns", source, offset.count());
+
+    RestoreCulledSource(source);
+
+    if (IsSourceStreamed(source))
+    {
+        VorbisStream const& vorbis = *m_sourceStreams.at(source).decoder;
+
+        uint32_t const frame = static_cast<uint32_t>(std::min(
+            static_cast<double>(offset.count()) * 1e-9 * static_cast<double>(vorbis.GetFrequencyHz())
+            , static_cast<double>(vorbis.GetFrameCount())
+        ));
+
+        return SeekSourceStream(source, frame);
+    }
+
+    ALint const sampleOffset = static_cast<ALint>(
+        GetMetaFrame(m_sourceMeta[source], static_cast<double>(offset.count()))
+    );
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    alSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, sampleOffset);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: set playback position: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+float SourceCollection::GetSourcePlaybackProgress(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+    float result = 0.0f;
+
+    auto const culledIt = m_culledSources.find(source);
+
+    if (m_culledSources.end() != culledIt)
+    {
+        return static_cast<float>(culledIt->second.count())
+            / static_cast<float>(std::max(GetSourcePlaybackDuration(source).count(), std::chrono::nanoseconds::rep(1)));
+    }
+
+    if (IsSourceStreamed(source))
+    {
+        audio::Source::State const state = GetSourceState(source);
+
+        if ((audio::Source::State::Playing == state)
+            || (audio::Source::State::Paused == state)
+        )
+        {
+            result = static_cast<float>(GetSourceStreamFrame(source))
+                / static_cast<float>(std::max(m_sourceStreams.at(source).decoder->GetFrameCount(), 1u));
+        }
+
+        return result;
+    }
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALint sampleOffset;
+    alGetSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, &sampleOffset);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        audio::Source::State const state = GetSourceState(source);
+
+        if (sampleOffset > 0
+            && ((audio::Source::State::Playing == state)
+                || (audio::Source::State::Paused == state))
+        )
+        {
+            result = static_cast<float>(sampleOffset)
+                / static_cast<float>(std::max(m_sourceMeta.at(source).activeFrameCount, 1u));
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: get playback progress: {:#x}", source, alErr);
+    }
+
+    return result;
+}
+
+bool SourceCollection::SetSourcePlaybackProgress(SourceHandle source, float value)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::SourcePlaybackProgress, source, value));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Source #{}: set playback progress {}%", source, value);
+
+    RestoreCulledSource(source);
+
+    if (IsSourceStreamed(source))
+    {
+        uint32_t const frameCount = m_sourceStreams.at(source).decoder->GetFrameCount();
+
+        return SeekSourceStream(source, static_cast<uint32_t>(std::round(static_cast<float>(frameCount) * value)));
+    }
+
+    ALint const sampleOffset = static_cast<ALint>(std::round(static_cast<float>(m_sourceMeta[source].activeFrameCount) * value));
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    alSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, sampleOffset);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: set playback progress: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+audio::Source::State SourceCollection::GetSourceState(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+    // culled sources are paused on behalf of the user
+    if (IsSourceCulled(source))
+    {
+        return audio::Source::State::Playing;
+    }
+
+    audio::Source::State state = audio::Source::State::Unknown;
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALint alState;
+    alGetSourcei(static_cast<ALuint>(source), AL_SOURCE_STATE, &alState);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        using audio::Source;
+
+        switch (alState)
+        {
+            case AL_INITIAL:
+            {
+                state = Source::State::Initial;
+                break;
+            }
+            case AL_PLAYING:
+            {
+                state = Source::State::Playing;
+                break;
+            }
+            case AL_PAUSED:
+            {
+                state = Source::State::Paused;
+                break;
+            }
+            case AL_STOPPED:
+            {
+                state = Source::State::Stopped;
+                break;
+            }
+            default:
+            {
+                state = Source::State::Unknown;
+                break;
+            }
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: get state: {:#x}", source, alErr);
+    }
+
+    return state;
+}
+
+audio::Source::State SourceCollection::GetSourceCachedState(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+    return m_shadow.state[source];
+}
+
+audio::Source::Type SourceCollection::GetSourceType(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+    audio::Source::Type type = audio::Source::Type::Unknown;
+
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALint alType;
+    alGetSourcei(static_cast<ALuint>(source), AL_SOURCE_TYPE, &alType);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        using audio::Source;
+
+        switch (alType)
+        {
+            case AL_UNDETERMINED:
+            {
+                type = Source::Type::Undetermined;
+                break;
+            }
+            case AL_STATIC:
+            {
+                type = Source::Type::Static;
+                break;
+            }
+            case AL_STREAMING:
+            {
+                type = Source::Type::Streaming;
+                break;
+            }
+            default:
+            {
+                type = Source::Type::Unknown;
+                break;
+            }
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: get type: {:#x}", source, alErr);
+    }
+
+    return type;
+}
+
+bool SourceCollection::IsSourceRelative(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "relative", (0 != m_shadow.isRelative[source]) == QuerySourceRelative(source));
+#endif
+
+    return 0 != m_shadow.isRelative[source];
+}
+
+bool SourceCollection::SetSourceRelative(SourceHandle source, bool flag)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeFlag(Command::Type::SourceRelative, source, flag));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set relative {}", source, flag);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcei(static_cast<ALuint>(source), AL_SOURCE_RELATIVE, (flag ? AL_TRUE : AL_FALSE));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.isRelative[source] = static_cast<uint8_t>(flag);
+
+        if (flag)
+        {
+            m_grid.Remove(source);
+        }
+        else
+        {
+            m_grid.Update(source, m_shadow.position[source]);
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set relative: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+bool SourceCollection::IsSourceLooping(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+    if (IsSourceStreamed(source))
+    {
+        return m_sourceStreams.at(source).isLooping;
+    }
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "looping", (0 != m_shadow.isLooping[source]) == QuerySourceLooping(source));
+#endif
+
+    return 0 != m_shadow.isLooping[source];
+}
+
+bool SourceCollection::SetSourceLooping(SourceHandle source, bool flag)
+{
+    assert(IsValid(source));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeFlag(Command::Type::SourceLooping, source, flag));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set looping {}", source, flag);
+
+    // streams are looped by the decoder, OpenAL would loop queued chunks
+    if (IsSourceStreamed(source))
+    {
+        m_sourceStreams.at(source).isLooping = flag;
+
+        return true;
+    }
+
+    // procedural data has no end to loop from
+    if (IsSourceProcedural(source))
+    {
+        return true;
+    }
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcei(static_cast<ALuint>(source), AL_LOOPING, (flag ? AL_TRUE : AL_FALSE));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.isLooping[source] = static_cast<uint8_t>(flag);
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set looping: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+float SourceCollection::GetSourcePitch(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "pitch", m_shadow.pitch[source] == QuerySourcePitch(source));
+#endif
+
+    return m_shadow.pitch[source];
+}
+
+bool SourceCollection::SetSourcePitch(SourceHandle source, float value)
+{
+    assert(IsValid(source));
+
+    if (!IsValidScalar(value))
+    {
+        LOG_AUDIO->Warning("Source #{}: set pitch: invalid value {}", source, value);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::SourcePitch, source, value));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set pitch {}", source, value);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcef(static_cast<ALuint>(source), AL_PITCH, value);
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.pitch[source] = value;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set pitch: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+float SourceCollection::GetSourceGain(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "gain", m_shadow.gain[source] == QuerySourceGain(source));
+#endif
+
+    return m_shadow.gain[source];
+}
+
+bool SourceCollection::SetSourceGain(SourceHandle source, float value)
+{
+    assert(IsValid(source));
+
+    if (!IsValidScalar(value))
+    {
+        LOG_AUDIO->Warning("Source #{}: set gain: invalid value {}", source, value);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::SourceGain, source, value));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set gain {}", source, value);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcef(static_cast<ALuint>(source), AL_GAIN, value);
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.gain[source] = value;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set gain: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+std::array<float, 3> SourceCollection::GetSourcePosition(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "position", m_shadow.position[source] == QuerySourcePosition(source));
+#endif
+
+    return m_shadow.position[source];
+}
+
+bool SourceCollection::SetSourcePosition(SourceHandle source, std::array<float, 3> const& vec)
+{
+    assert(IsValid(source));
+
+    if (!IsValidVector(vec))
+    {
+        LOG_AUDIO->Warning("Source #{}: set position: invalid value {{ {}, {}, {} }}", source, vec[0], vec[1], vec[2]);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeVector(Command::Type::SourcePosition, source, vec.data(), 3));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set position {{ {}, {}, {} }}", source, vec[0], vec[1], vec[2]);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSource3f(static_cast<ALuint>(source), AL_POSITION, static_cast<ALfloat>(vec[0]), static_cast<ALfloat>(vec[1]), static_cast<ALfloat>(vec[2]));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.position[source] = vec;
+
+        if (0 == m_shadow.isRelative[source])
+        {
+            m_grid.Update(source, vec);
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set position: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+std::array<float, 3> SourceCollection::GetSourceVelocity(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "velocity", m_shadow.velocity[source] == QuerySourceVelocity(source));
+#endif
+
+    return m_shadow.velocity[source];
+}
+
+bool SourceCollection::SetSourceVelocity(SourceHandle source, std::array<float, 3> const& vec)
+{
+    assert(IsValid(source));
+
+    if (!IsValidVector(vec))
+    {
+        LOG_AUDIO->Warning("Source #{}: set velocity: invalid value {{ {}, {}, {} }}", source, vec[0], vec[1], vec[2]);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeVector(Command::Type::SourceVelocity, source, vec.data(), 3));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set velocity {{ {}, {}, {} }}", source, vec[0], vec[1], vec[2]);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSource3f(static_cast<ALuint>(source), AL_VELOCITY, static_cast<ALfloat>(vec[0]), static_cast<ALfloat>(vec[1]), static_cast<ALfloat>(vec[2]));
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.velocity[source] = vec;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set velocity: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+float SourceCollection::GetSourceReferenceDistance(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "reference distance", m_shadow.referenceDistance[source] == QuerySourceReferenceDistance(source));
+#endif
+
+    return m_shadow.referenceDistance[source];
+}
+
+bool SourceCollection::SetSourceReferenceDistance(SourceHandle source, float value)
+{
+    assert(IsValid(source));
+
+    if (!IsValidScalar(value))
+    {
+        LOG_AUDIO->Warning("Source #{}: set reference distance: invalid value {}", source, value);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::SourceReferenceDistance, source, value));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set reference distance {}", source, value);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcef(static_cast<ALuint>(source), AL_REFERENCE_DISTANCE, value);
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.referenceDistance[source] = value;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set reference distance: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+float SourceCollection::GetSourceMaxDistance(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "max distance", m_shadow.maxDistance[source] == QuerySourceMaxDistance(source));
+#endif
+
+    return m_shadow.maxDistance[source];
+}
+
+bool SourceCollection::SetSourceMaxDistance(SourceHandle source, float value)
+{
+    assert(IsValid(source));
+
+    if (!IsValidScalar(value))
+    {
+        LOG_AUDIO->Warning("Source #{}: set max distance: invalid value {}", source, value);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::SourceMaxDistance, source, value));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set max distance {}", source, value);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcef(static_cast<ALuint>(source), AL_MAX_DISTANCE, value);
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.maxDistance[source] = value;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set max distance: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+float SourceCollection::GetSourceRolloffFactor(SourceHandle source) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(source));
+
+#ifdef TULPAR_VERIFY_SHADOW_STATE
+    VerifySourceShadow(source, "rolloff factor", m_shadow.rolloffFactor[source] == QuerySourceRolloffFactor(source));
+#endif
+
+    return m_shadow.rolloffFactor[source];
+}
+
+bool SourceCollection::SetSourceRolloffFactor(SourceHandle source, float value)
+{
+    assert(IsValid(source));
+
+    if (!IsValidScalar(value))
+    {
+        LOG_AUDIO->Warning("Source #{}: set rolloff factor: invalid value {}", source, value);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::SourceRolloffFactor, source, value));
+
+        return true;
+    }
+
+    HotPath::Debug("Source #{}: set rolloff factor {}", source, value);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    alSourcef(static_cast<ALuint>(source), AL_ROLLOFF_FACTOR, value);
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        m_shadow.rolloffFactor[source] = value;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Source #{}: set rolloff factor: {:#x}", source, alErr);
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+bool SourceCollection::SetSourcesPosition(SourceHandle const* pSources
+    , uint32_t count
+    , float const* pX
+    , float const* pY
+    , float const* pZ
+)
+{
+    return SetSourcesVector(Command::Type::SourcePosition, AL_POSITION, "position", m_shadow.position, pSources, count, pX, pY, pZ);
+}
+
+bool SourceCollection::SetSourcesVelocity(SourceHandle const* pSources
+    , uint32_t count
+    , float const* pX
+    , float const* pY
+    , float const* pZ
+)
+{
+    return SetSourcesVector(Command::Type::SourceVelocity, AL_VELOCITY, "velocity", m_shadow.velocity, pSources, count, pX, pY, pZ);
+}
+
+void SourceCollection::GetSourcesInRadius(std::array<float, 3> const& center, float radius, Handles& result) const
+{
+    m_grid.Query(center, radius, result);
+}
+
+namespace
+{
+
+//! Cached source properties used to estimate audibility
+struct AudibilityInput
+{
+    float const* pGain;
+    float const* pReference;
+    float const* pMax;
+    float const* pRolloff;
+    uint8_t const* pRelative;
+    std::array<float, 3> const* pPosition;
+};
+
+/** @brief  Estimates gain of sources as heard by the listener
+ *
+ *  Each step is a single loop over @p count results. Cached properties of
+ *  the i-th result are read at index @p slot(i), so the loops run over
+ *  contiguous values for the full pass and gather them for a subset.
+ *
+ *  @param  input               cached source properties
+ *  @param  listenerPosition    listener position
+ *  @param  distanceModel       active distance model
+ *  @param  slot                maps result index to source handle
+ *  @param  count               number of results
+ *  @param  pResult             estimated gains
+ */
+template<typename Slot>
+    void EvaluateAudibility(AudibilityInput const& input
+        , std::array<float, 3> const& listenerPosition
+        , audio::Listener::DistanceModel distanceModel
+        , Slot slot
+        , size_t count
+        , float* pResult
+    )
+{
+    using DistanceModel = audio::Listener::DistanceModel;
+
+    if (DistanceModel::None == distanceModel)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t const source = slot(i);
+
+            pResult[i] = input.pGain[source];
+        }
+
+        return;
+    }
+
+    // relative sources are positioned around the listener
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t const source = slot(i);
+
+        float const isAbsolute = static_cast<float>(1 - input.pRelative[source]);
+
+        float const dx = input.pPosition[source][0] - listenerPosition[0] * isAbsolute;
+        float const dy = input.pPosition[source][1] - listenerPosition[1] * isAbsolute;
+        float const dz = input.pPosition[source][2] - listenerPosition[2] * isAbsolute;
+
+        pResult[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    if ((DistanceModel::InverseClamped == distanceModel)
+        || (DistanceModel::LinearClamped == distanceModel)
+        || (DistanceModel::ExponentClamped == distanceModel)
+    )
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t const source = slot(i);
+
+            pResult[i] = std::min(std::max(pResult[i], input.pReference[source]), input.pMax[source]);
+        }
+    }
+
+    switch (distanceModel)
+    {
+        case DistanceModel::Inverse:
+        case DistanceModel::InverseClamped:
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t const source = slot(i);
+
+                float const denominator = input.pReference[source] + input.pRolloff[source] * (pResult[i] - input.pReference[source]);
+
+                pResult[i] = (denominator > 0.0f) ? (input.pReference[source] / denominator) : 1.0f;
+            }
+            break;
+        }
+        case DistanceModel::Linear:
+        case DistanceModel::LinearClamped:
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t const source = slot(i);
+
+                float const range = input.pMax[source] - input.pReference[source];
+                float const distance = std::min(pResult[i], input.pMax[source]);
+
+                pResult[i] = (range > 0.0f)
+                    ? std::max(1.0f - input.pRolloff[source] * (distance - input.pReference[source]) / range, 0.0f)
+                    : 1.0f;
+            }
+            break;
+        }
+        case DistanceModel::Exponent:
+        case DistanceModel::ExponentClamped:
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t const source = slot(i);
+
+                pResult[i] = ((pResult[i] > 0.0f) && (input.pReference[source] > 0.0f))
+                    ? std::pow(pResult[i] / input.pReference[source], -input.pRolloff[source])
+                    : 1.0f;
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t const source = slot(i);
+
+        pResult[i] *= input.pGain[source];
+    }
+}
+
+}
+
+void SourceCollection::ComputeAudibility(std::array<float, 3> const& listenerPosition
+    , audio::Listener::DistanceModel distanceModel
+    , std::vector<float>& result
+) const
+{
+    size_t const count = m_shadow.gain.size();
+
+    result.resize(count);
+
+    AudibilityInput const input = {
+        m_shadow.gain.data()
+        , m_shadow.referenceDistance.data()
+        , m_shadow.maxDistance.data()
+        , m_shadow.rolloffFactor.data()
+        , m_shadow.isRelative.data()
+        , m_shadow.position.data()
+    };
+
+    EvaluateAudibility(input, listenerPosition, distanceModel
+        , [](size_t i) { return i; }
+        , count
+        , result.data()
+    );
+}
+
+void SourceCollection::ComputeAudibility(std::array<float, 3> const& listenerPosition
+    , audio::Listener::DistanceModel distanceModel
+    , Reference const* pSources
+    , uint32_t count
+    , float* pResult
+) const
+{
+    AudibilityInput const input = {
+        m_shadow.gain.data()
+        , m_shadow.referenceDistance.data()
+        , m_shadow.maxDistance.data()
+        , m_shadow.rolloffFactor.data()
+        , m_shadow.isRelative.data()
+        , m_shadow.position.data()
+    };
+
+    EvaluateAudibility(input, listenerPosition, distanceModel
+        , [this, pSources](size_t i) { return GetHandle(pSources[i]); }
+        , count
+        , pResult
+    );
+}
+
+void SourceCollection::CullSources(std::array<float, 3> const& listenerPosition
+    , audio::Listener::DistanceModel distanceModel
+    , float threshold
+    , std::chrono::nanoseconds elapsed
+)
+{
+    if (threshold <= 0.0f)
+    {
+        if (m_culledSources.empty())
+        {
+            return;
+        }
+    }
+    else
+    {
+        ComputeAudibility(listenerPosition, distanceModel, m_audibility);
+    }
+
+    for (auto culledIt = m_culledSources.begin(); culledIt != m_culledSources.end();)
+    {
+        SourceHandle const source = culledIt->first;
+        std::chrono::nanoseconds& clock = culledIt->second;
+
+        clock += std::chrono::nanoseconds(static_cast<int64_t>(
+            std::round(static_cast<double>(elapsed.count()) * static_cast<double>(m_shadow.pitch[source]))
+        ));
+
+        std::chrono::nanoseconds const duration = GetSourcePlaybackDuration(source);
+
+        if (clock >= duration)
+        {
+            if (IsSourceLooping(source) && (duration.count() > 0))
+            {
+                clock %= duration;
+            }
+            else
+            {
+                HotPath::Debug("Source #{}: culled playback is over", source);
+
+                culledIt = m_culledSources.erase(culledIt);
+
+                StopSource(source);
+                PushSourceEvent(audio::SourceEvent::Type::Stopped, source, 0);
+
+                continue;
+            }
+        }
+
+        ++culledIt;
+
+        if ((threshold <= 0.0f) || (m_audibility[source] >= threshold))
+        {
+            // only the restored entry is erased, so the iterator stays valid
+            RestoreCulledSource(source);
+        }
+    }
+
+    if (threshold <= 0.0f)
+    {
+        return;
+    }
+
+    for (SourceHandle source : m_used)
+    {
+        if (audio::Source::State::Playing != m_shadow.state[source]
+            || IsSourceProcedural(source)
+            || IsSourceCulled(source)
+            || (m_audibility[source] >= threshold))
+        {
+            continue;
+        }
+
+        // cached state might not have caught up with playback completion yet
+        if (audio::Source::State::Playing != GetSourceState(source))
+        {
+            continue;
+        }
+
+        std::chrono::nanoseconds const clock = GetSourcePlaybackPosition(source);
+
+        // clear error state
+        ALenum alErr = HotPath::GetError();
+
+        alSourcePause(static_cast<ALuint>(source));
+
+        alErr = HotPath::GetError();
+
+        if (AL_NO_ERROR != alErr)
+        {
+            LOG_AUDIO->Warning("Source #{}: cull: {:#x}", source, alErr);
+        }
+        else
+        {
+            HotPath::Debug("Source #{}: culled at {}ns", source, clock.count());
+
+            m_culledSources.emplace(source, clock);
+        }
+    }
+}
+
+audio::Source SourceCollection::CreateObject(SourceHandle source)
+{
+    assert(!IsValid(source));
+
+    m_sourceBuffers.erase(source);
+    m_sourceQueuedBuffers.erase(source);
+
+    ReserveSourceShadow(source);
+
+    // reclaimed sources keep their properties
+    if (0 == m_shadow.isRelative[source])
+    {
+        m_grid.Update(source, m_shadow.position[source]);
+    }
+
+    return audio::Source(std::make_shared<SourceHandle>(source)
+        , std::make_shared<SourceCollection*>(const_cast<SourceCollection*>(this))
+    );
+}
+
+bool SourceCollection::QuerySourceRelative(SourceHandle source) const
+{
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALint result = AL_FALSE;
+
+    alGetSourcei(static_cast<ALuint>(source), AL_SOURCE_RELATIVE, &result);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        result = AL_FALSE;
+        LOG_AUDIO->Warning("Source #{}: get relative: {:#x}", source, alErr);
+    }
+
+    return result == AL_TRUE;
+}
+
+bool SourceCollection::QuerySourceLooping(SourceHandle source) const
+{
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALint result = AL_FALSE;
+
+    alGetSourcei(static_cast<ALuint>(source), AL_LOOPING, &result);
+
+    alErr = alGetError();
 
     if (AL_NO_ERROR != alErr)
     {
-        LOG_AUDIO->Warning("Source #{}: set playback position: {:#x}", source, alErr);
+        result = AL_FALSE;
+        LOG_AUDIO->Warning("Source #{}: get looping: {:#x}", source, alErr);
     }
 
-    return AL_NO_ERROR == alErr;
+    return result == AL_TRUE;
 }
 
-float SourceCollection::GetSourcePlaybackProgress(SourceHandle source) const
+float SourceCollection::QuerySourcePitch(SourceHandle source) const
 {
-    assert(IsValid(source));
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
 
-    float result = 0.0f;
+    ALfloat result = 0.0f;
+
+    alGetSourcef(static_cast<ALuint>(source), AL_PITCH, &result);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        result = -1.0f;
+        LOG_AUDIO->Warning("Source #{}: get pitch: {:#x}", source, alErr);
+    }
+
+    return result;
+}
 
+float SourceCollection::QuerySourceGain(SourceHandle source) const
+{
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
-    ALint sampleOffset;
-    alGetSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, &sampleOffset);
+    ALfloat result = 0.0f;
+
+    alGetSourcef(static_cast<ALuint>(source), AL_GAIN, &result);
 
     alErr = alGetError();
 
-    if (AL_NO_ERROR == alErr)
+    if (AL_NO_ERROR != alErr)
     {
-        audio::Source::State const state = GetSourceState(source);
+        result = -1.0f;
+        LOG_AUDIO->Warning("Source #{}: get gain: {:#x}", source, alErr);
+    }
 
-        if (sampleOffset > 0
-            && ((audio::Source::State::Playing == state)
-                || (audio::Source::State::Paused == state))
-        )
-        {
-            result = static_cast<float>(sampleOffset) / static_cast<float>(m_sourceMeta.at(source).activeSampleCount);
-        }
+    return result;
+}
+
+std::array<float, 3> SourceCollection::QuerySourcePosition(SourceHandle source) const
+{
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALfloat x;
+    ALfloat y;
+    ALfloat z;
+
+    alGetSource3f(static_cast<ALuint>(source), AL_POSITION, &x, &y, &z);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: get position: {:#x}", source, alErr);
+
+        x = std::numeric_limits<float>::quiet_NaN();
+        y = std::numeric_limits<float>::quiet_NaN();
+        z = std::numeric_limits<float>::quiet_NaN();
     }
-    else
+
+    return {{ static_cast<float>(x), static_cast<float>(y), static_cast<float>(z) }};
+}
+
+std::array<float, 3> SourceCollection::QuerySourceVelocity(SourceHandle source) const
+{
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALfloat x;
+    ALfloat y;
+    ALfloat z;
+
+    alGetSource3f(static_cast<ALuint>(source), AL_VELOCITY, &x, &y, &z);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
     {
-        LOG_AUDIO->Warning("Source #{}: get playback progress: {:#x}", source, alErr);
+        LOG_AUDIO->Warning("Source #{}: get velocity: {:#x}", source, alErr);
+
+        x = std::numeric_limits<float>::quiet_NaN();
+        y = std::numeric_limits<float>::quiet_NaN();
+        z = std::numeric_limits<float>::quiet_NaN();
+    }
+
+    return {{ static_cast<float>(x), static_cast<float>(y), static_cast<float>(z) }};
+}
+
+float SourceCollection::QuerySourceReferenceDistance(SourceHandle source) const
+{
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
+
+    ALfloat result = 0.0f;
+
+    alGetSourcef(static_cast<ALuint>(source), AL_REFERENCE_DISTANCE, &result);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        result = -1.0f;
+        LOG_AUDIO->Warning("Source #{}: get reference distance: {:#x}", source, alErr);
     }
 
     return result;
 }
 
-bool SourceCollection::SetSourcePlaybackProgress(SourceHandle source, float value)
+float SourceCollection::QuerySourceMaxDistance(SourceHandle source) const
 {
-    assert(IsValid(source));
+    // clear error state
+    ALenum alErr = HotPath::ClearError();
 
-    LOG_AUDIO->Debug("Source #{}: set playback progress {}%", source, value);
+    ALfloat result = 0.0f;
+
+    alGetSourcef(static_cast<ALuint>(source), AL_MAX_DISTANCE, &result);
+
+    alErr = alGetError();
 
-    audio::Buffer buffer = GetSourceActiveBuffer(source);
+    if (AL_NO_ERROR != alErr)
+    {
+        result = -1.0f;
+        LOG_AUDIO->Warning("Source #{}: get max distance: {:#x}", source, alErr);
+    }
 
-    ALint sampleOffset = static_cast<ALint>(std::round(static_cast<float>(m_sourceMeta[source].activeSampleCount) * value));
+    return result;
+}
 
+float SourceCollection::QuerySourceRolloffFactor(SourceHandle source) const
+{
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
-    alSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, sampleOffset);
+    ALfloat result = 0.0f;
+
+    alGetSourcef(static_cast<ALuint>(source), AL_ROLLOFF_FACTOR, &result);
 
     alErr = alGetError();
 
     if (AL_NO_ERROR != alErr)
     {
-        LOG_AUDIO->Warning("Source #{}: set playback progress: {:#x}", source, alErr);
+        result = -1.0f;
+        LOG_AUDIO->Warning("Source #{}: get rolloff factor: {:#x}", source, alErr);
+    }
+
+    return result;
+}
+
+bool SourceCollection::SetSourcesVector(Command::Type type
+    , ALenum param
+    , char const* action
+    , std::vector<std::array<float, 3>>& shadow
+    , SourceHandle const* pSources
+    , uint32_t count
+    , float const* pX
+    , float const* pY
+    , float const* pZ
+)
+{
+    // accumulates to a non-finite value if any component is one, single branch for the batch
+    float sum = 0.0f;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        sum += (pX[i] - pX[i]) + (pY[i] - pY[i]) + (pZ[i] - pZ[i]);
+    }
+
+    if (!std::isfinite(sum))
+    {
+        LOG_AUDIO->Warning("Sources ({}): set {}: non-finite component", count, action);
+
+        return false;
+    }
+
+    if (IsDeferringCommands())
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float const vec[3] = { pX[i], pY[i], pZ[i] };
+
+            PushCommand(Command::MakeVector(type, pSources[i], vec, 3));
+        }
+
+        return true;
+    }
+
+    HotPath::Debug("Sources ({}): set {}", count, action);
+
+    // clear error state
+    ALenum alErr = HotPath::GetError();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        SourceHandle const source = pSources[i];
+
+        assert(IsValid(source));
+
+        alSource3f(static_cast<ALuint>(source), param, pX[i], pY[i], pZ[i]);
+    }
+
+    alErr = HotPath::GetError();
+
+    if (AL_NO_ERROR == alErr)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            shadow[pSources[i]] = {{ pX[i], pY[i], pZ[i] }};
+        }
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Sources ({}): set {}: {:#x}", count, action, alErr);
+
+        // the error does not tell which sources were updated, resync the batch from OpenAL
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            std::array<float, 3>& vec = shadow[pSources[i]];
+
+            alGetSource3f(static_cast<ALuint>(pSources[i]), param, &vec[0], &vec[1], &vec[2]);
+        }
+
+        // clear error state
+        alGetError();
+    }
+
+    if (AL_POSITION == param)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (0 == m_shadow.isRelative[pSources[i]])
+            {
+                m_grid.Update(pSources[i], m_shadow.position[pSources[i]]);
+            }
+        }
+    }
+
+    return AL_NO_ERROR == alErr;
+}
+
+void SourceCollection::ReserveSourceShadow(SourceHandle source)
+{
+    size_t const size = static_cast<size_t>(source) + 1;
+
+    // newly generated sources are reset to default values by OpenAVSourceHandler::Generate
+    if (m_shadow.pitch.size() < size)
+    {
+        m_shadow.pitch.resize(size, 1.0f);
+        m_shadow.gain.resize(size, 1.0f);
+        m_shadow.position.resize(size, {{ 0.0f, 0.0f, 0.0f }});
+        m_shadow.velocity.resize(size, {{ 0.0f, 0.0f, 0.0f }});
+        m_shadow.referenceDistance.resize(size, 1.0f);
+        m_shadow.maxDistance.resize(size, std::numeric_limits<float>::max());
+        m_shadow.rolloffFactor.resize(size, 1.0f);
+        m_shadow.isRelative.resize(size, 0);
+        m_shadow.isLooping.resize(size, 0);
+        m_shadow.state.resize(size, audio::Source::State::Initial);
+    }
+}
+
+void SourceCollection::VerifySourceShadow(SourceHandle source, char const* property, bool isMatching) const
+{
+    if (!isMatching)
+    {
+        LOG_AUDIO->Error("Source #{}: cached {} differs from OpenAL state", source, property);
     }
+}
+
+void SourceCollection::ResetSourceMeta(SourceHandle source)
+{
+    assert(IsValid(source));
+
+    LOG_AUDIO->Debug("Source #{}: reset meta", source);
+
+    ClearMeta(m_sourceMeta[source]);
+
+    m_sourceQueuedBuffers[source].clear();
+}
+
+void SourceCollection::ClearMeta(Meta& meta)
+{
+    using namespace std::chrono_literals;
+
+    meta.activeFrameCount = 0;
+    meta.activeTotalDuration = 0ns;
+
+    meta.frameStarts.assign(1, 0);
+    meta.timeStarts.assign(1, 0.0);
+    meta.frequencies.clear();
+}
+
+void SourceCollection::AppendMeta(Meta& meta, uint32_t frameCount, uint32_t frequencyHz)
+{
+    assert(!meta.frameStarts.empty() && !meta.timeStarts.empty());
+
+    // empty buffers do not contribute to playback
+    if (0 == frameCount || 0 == frequencyHz)
+    {
+        return;
+    }
+
+    double const timeNs = 1e9 * (static_cast<double>(frameCount) / static_cast<double>(frequencyHz));
+
+    meta.frameStarts.push_back(meta.frameStarts.back() + frameCount);
+    meta.timeStarts.push_back(meta.timeStarts.back() + timeNs);
+    meta.frequencies.push_back(frequencyHz);
+
+    meta.activeFrameCount = meta.frameStarts.back();
+    meta.activeTotalDuration = std::chrono::nanoseconds(static_cast<uint64_t>(std::round(meta.timeStarts.back())));
+}
+
+double SourceCollection::GetMetaTime(Meta const& meta, uint32_t frame)
+{
+    if (meta.frequencies.empty())
+    {
+        return 0.0;
+    }
+
+    frame = std::min(frame, meta.activeFrameCount);
+
+    // last buffer starting at or before given frame
+    size_t const index = std::min<size_t>(
+        std::upper_bound(meta.frameStarts.cbegin(), meta.frameStarts.cend(), frame) - meta.frameStarts.cbegin() - 1
+        , meta.frequencies.size() - 1
+    );
+
+    return meta.timeStarts[index]
+        + 1e9 * (static_cast<double>(frame - meta.frameStarts[index]) / static_cast<double>(meta.frequencies[index]));
+}
+
+uint32_t SourceCollection::GetMetaFrame(Meta const& meta, double timeNs)
+{
+    if (meta.frequencies.empty() || timeNs <= 0.0)
+    {
+        return 0;
+    }
+
+    // last buffer starting at or before given time
+    size_t const index = std::min<size_t>(
+        std::upper_bound(meta.timeStarts.cbegin(), meta.timeStarts.cend(), timeNs) - meta.timeStarts.cbegin() - 1
+        , meta.frequencies.size() - 1
+    );
+
+    uint32_t const frame = meta.frameStarts[index]
+        + static_cast<uint32_t>((timeNs - meta.timeStarts[index]) * 1e-9 * static_cast<double>(meta.frequencies[index]));
+
+    return std::min(frame, meta.activeFrameCount);
+}
+
+bool SourceCollection::FillStreamBuffer(Stream& stream, BufferHandle buffer)
+{
+    VorbisStream& vorbis = *stream.decoder;
+    uint32_t const channels = vorbis.GetChannelCount();
+
+    m_streamSamples.resize(m_streamBufferFrames * channels);
+
+    uint32_t frames = vorbis.Decode(m_streamSamples.data(), m_streamBufferFrames);
+
+    while (stream.isLooping && frames < m_streamBufferFrames && vorbis.Seek(0))
+    {
+        uint32_t const decoded = vorbis.Decode(m_streamSamples.data() + frames * channels, m_streamBufferFrames - frames);
+
+        if (0 == decoded)
+        {
+            break;
+        }
+
+        frames += decoded;
+    }
+
+    if (0 == frames)
+    {
+        return false;
+    }
+
+    ALenum const format = m_buffers.GetFormat(PcmData::Format::Int16, static_cast<uint8_t>(channels));
+
+    if (AL_NONE == format)
+    {
+        LOG_AUDIO->Warning("Buffer #{}: {} channel stream layout is not supported", buffer, channels);
+
+        return false;
+    }
+
+    alBufferData(static_cast<ALuint>(buffer)
+        , format
+        , m_streamSamples.data()
+        , (frames * channels * sizeof(ALshort))
+        , vorbis.GetFrequencyHz()
+    );
 
-    return AL_NO_ERROR == alErr;
+    stream.queuedFrames.push_back(frames);
+
+    return true;
 }
 
-audio::Source::State SourceCollection::GetSourceState(SourceHandle source) const
+bool SourceCollection::RestartSourceStream(SourceHandle source, uint32_t frame)
 {
-    assert(IsValid(source));
+    assert(IsSourceStreamed(source));
 
-    audio::Source::State state = audio::Source::State::Unknown;
+    LOG_AUDIO->Trace("Source #{}: restart stream from frame {}", source, frame);
+
+    ALuint const index = static_cast<ALuint>(source);
+    Stream& stream = m_sourceStreams.at(source);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
-    ALint alState;
-    alGetSourcei(static_cast<ALuint>(source), AL_SOURCE_STATE, &alState);
+    alSourceStop(index);
+    alSourcei(index, AL_BUFFER, 0);
 
-    alErr = alGetError();
+    stream.queuedFrames.clear();
+    stream.queueStartFrame = 0;
 
-    if (AL_NO_ERROR == alErr)
+    if (stream.decoder->Seek(frame))
     {
-        using audio::Source;
+        stream.queueStartFrame = frame;
+    }
+    else
+    {
+        stream.decoder->Seek(0);
+    }
 
-        switch (alState)
+    for (BufferHandle buffer : stream.buffers)
+    {
+        if (!FillStreamBuffer(stream, buffer))
         {
-            case AL_INITIAL:
-            {
-                state = Source::State::Initial;
-                break;
-            }
-            case AL_PLAYING:
-            {
-                state = Source::State::Playing;
-                break;
-            }
-            case AL_PAUSED:
-            {
-                state = Source::State::Paused;
-                break;
-            }
-            case AL_STOPPED:
-            {
-                state = Source::State::Stopped;
-                break;
-            }
-            default:
-            {
-                state = Source::State::Unknown;
-                break;
-            }
+            break;
         }
+
+        ALuint const alBuffer = static_cast<ALuint>(buffer);
+
+        alSourceQueueBuffers(index, 1, &alBuffer);
+    }
+
+    // get back to initial state so that playback starts from queued data
+    alSourceRewind(index);
+
+    alErr = alGetError();
+
+    if (AL_NO_ERROR != alErr)
+    {
+        LOG_AUDIO->Warning("Source #{}: restart stream: {:#x}", source, alErr);
     }
     else
     {
-        LOG_AUDIO->Warning("Source #{}: get state: {:#x}", source, alErr);
+        m_shadow.state[source] = audio::Source::State::Initial;
     }
 
-    return state;
+    stream.isPending = true;
+
+    return AL_NO_ERROR == alErr;
 }
 
-audio::Source::Type SourceCollection::GetSourceType(SourceHandle source) const
+bool SourceCollection::SeekSourceStream(SourceHandle source, uint32_t frame)
 {
-    assert(IsValid(source));
-
-    audio::Source::Type type = audio::Source::Type::Unknown;
-
-    // clear error type
-    ALenum alErr = alGetError();
-
-    ALint alType;
-    alGetSourcei(static_cast<ALuint>(source), AL_SOURCE_TYPE, &alType);
+    audio::Source::State const state = GetSourceState(source);
 
-    alErr = alGetError();
+    bool result = RestartSourceStream(source, frame);
 
-    if (AL_NO_ERROR == alErr)
+    if (result)
     {
-        using audio::Source;
+        ALuint const index = static_cast<ALuint>(source);
 
-        switch (alType)
+        switch (state)
         {
-            case AL_UNDETERMINED:
-            {
-                type = Source::Type::Undetermined;
-                break;
-            }
-            case AL_STATIC:
+            case audio::Source::State::Playing:
             {
-                type = Source::Type::Static;
+                alSourcePlay(index);
+                m_shadow.state[source] = state;
                 break;
             }
-            case AL_STREAMING:
+            case audio::Source::State::Paused:
             {
-                type = Source::Type::Streaming;
+                alSourcePlay(index);
+                alSourcePause(index);
+                m_shadow.state[source] = state;
                 break;
             }
             default:
             {
-                type = Source::Type::Unknown;
                 break;
             }
         }
     }
-    else
-    {
-        LOG_AUDIO->Warning("Source #{}: get type: {:#x}", source, alErr);
-    }
 
-    return type;
+    return result;
 }
 
-bool SourceCollection::IsSourceRelative(SourceHandle source) const
+uint32_t SourceCollection::GetSourceStreamFrame(SourceHandle source) const
 {
-    assert(IsValid(source));
-
-    // clear error state
-    ALenum alErr = alGetError();
-
-    ALint result = AL_FALSE;
-
-    alGetSourcei(static_cast<ALuint>(source), AL_SOURCE_RELATIVE, &result);
+    assert(IsSourceStreamed(source));
 
-    alErr = alGetError();
+    Stream const& stream = m_sourceStreams.at(source);
 
-    if (AL_NO_ERROR != alErr)
-    {
-        result = AL_FALSE;
-        LOG_AUDIO->Warning("Source #{}: get relative: {:#x}", source, alErr);
-    }
+    ALint sampleOffset = 0;
+    alGetSourcei(static_cast<ALuint>(source), AL_SAMPLE_OFFSET, &sampleOffset);
 
-    return result == AL_TRUE;
+    return (stream.queueStartFrame + static_cast<uint32_t>(std::max(sampleOffset, 0)))
+        % std::max(stream.decoder->GetFrameCount(), 1u);
 }
 
-bool SourceCollection::SetSourceRelative(SourceHandle source, bool flag)
+void SourceCollection::FillSourceCallbackQueue(SourceHandle source, CallbackStream& stream)
 {
-    assert(IsValid(source));
+    ALuint const index = static_cast<ALuint>(source);
 
-    LOG_AUDIO->Debug("Source #{}: set relative {}", source, flag);
+    m_callbackSamples.resize(m_streamBufferFrames * stream.frameSize);
 
-    // clear error state
-    ALenum alErr = alGetError();
+    while (!stream.freeBuffers.empty() && !stream.isDrained)
+    {
+        uint32_t const frames = std::min(stream.callback(m_callbackSamples.data(), m_streamBufferFrames), m_streamBufferFrames);
 
-    alSourcei(static_cast<ALuint>(source), AL_SOURCE_RELATIVE, (flag ? AL_TRUE : AL_FALSE));
+        stream.isDrained = (frames < m_streamBufferFrames);
 
-    alErr = alGetError();
+        if (0 == frames)
+        {
+            break;
+        }
 
-    if (AL_NO_ERROR != alErr)
-    {
-        LOG_AUDIO->Warning("Source #{}: set relative: {:#x}", source, alErr);
-    }
+        ALuint const buffer = static_cast<ALuint>(stream.freeBuffers.back());
 
-    return AL_NO_ERROR == alErr;
+        alBufferData(buffer
+            , stream.format
+            , m_callbackSamples.data()
+            , (frames * stream.frameSize)
+            , stream.frequencyHz
+        );
+        alSourceQueueBuffers(index, 1, &buffer);
+
+        stream.freeBuffers.pop_back();
+    }
 }
 
-bool SourceCollection::IsSourceLooping(SourceHandle source) const
+bool SourceCollection::IsSourceBufferRing(SourceHandle source) const
 {
-    assert(IsValid(source));
+    auto callbackIt = m_sourceCallbacks.find(source);
 
-    // clear error state
-    ALenum alErr = alGetError();
+    return (m_sourceCallbacks.cend() != callbackIt) && !callbackIt->second->isCallbackBuffer;
+}
 
-    ALint result = AL_FALSE;
+void SourceCollection::RestartSourceCallback(SourceHandle source)
+{
+    assert(IsSourceProcedural(source));
 
-    alGetSourcei(static_cast<ALuint>(source), AL_LOOPING, &result);
+    CallbackStream& stream = *m_sourceCallbacks.at(source);
 
-    alErr = alGetError();
+    stream.isPending = true;
 
-    if (AL_NO_ERROR != alErr)
+    if (stream.isCallbackBuffer)
     {
-        result = AL_FALSE;
-        LOG_AUDIO->Warning("Source #{}: get looping: {:#x}", source, alErr);
+        return;
     }
 
-    return result == AL_TRUE;
-}
+    audio::Source::State const state = GetSourceState(source);
 
-bool SourceCollection::SetSourceLooping(SourceHandle source, bool flag)
-{
-    assert(IsValid(source));
+    if (audio::Source::State::Playing == state || audio::Source::State::Paused == state)
+    {
+        return;
+    }
 
-    LOG_AUDIO->Debug("Source #{}: set looping {}", source, flag);
+    LOG_AUDIO->Trace("Source #{}: restart callback", source);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::ClearError();
 
-    alSourcei(static_cast<ALuint>(source), AL_LOOPING, (flag ? AL_TRUE : AL_FALSE));
+    alSourcei(static_cast<ALuint>(source), AL_BUFFER, 0);
+
+    stream.freeBuffers.assign(stream.buffers.cbegin(), stream.buffers.cend());
+    stream.isDrained = false;
+
+    FillSourceCallbackQueue(source, stream);
 
     alErr = alGetError();
 
     if (AL_NO_ERROR != alErr)
     {
-        LOG_AUDIO->Warning("Source #{}: set looping: {:#x}", source, alErr);
+        LOG_AUDIO->Warning("Source #{}: restart callback: {:#x}", source, alErr);
     }
-
-    return AL_NO_ERROR == alErr;
 }
 
-float SourceCollection::GetSourcePitch(SourceHandle source) const
+void SourceCollection::ReleaseSourceCallback(SourceHandle source)
 {
-    assert(IsValid(source));
+    auto callbackIt = m_sourceCallbacks.find(source);
 
-    // clear error state
-    ALenum alErr = alGetError();
+    if (m_sourceCallbacks.end() != callbackIt)
+    {
+        LOG_AUDIO->Trace("Source #{}: release callback", source);
 
-    ALfloat result = 0.0f;
+        std::vector<ALuint> alBuffers(callbackIt->second->buffers.cbegin(), callbackIt->second->buffers.cend());
 
-    alGetSourcef(static_cast<ALuint>(source), AL_PITCH, &result);
+        // clear error state
+        ALenum alErr = HotPath::ClearError();
 
-    alErr = alGetError();
+        // stop waits for the mixer, callback is not called afterwards
+        alSourceStop(static_cast<ALuint>(source));
+        alSourcei(static_cast<ALuint>(source), AL_BUFFER, 0);
+        alDeleteBuffers(alBuffers.size(), alBuffers.data());
 
-    if (AL_NO_ERROR != alErr)
-    {
-        result = -1.0f;
-        LOG_AUDIO->Warning("Source #{}: get pitch: {:#x}", source, alErr);
-    }
+        alErr = alGetError();
 
-    return result;
+        if (AL_NO_ERROR == alErr)
+        {
+            m_shadow.state[source] = audio::Source::State::Stopped;
+        }
+        else
+        {
+            LOG_AUDIO->Warning("Source #{}: release callback: {:#x}", source, alErr);
+        }
+
+        m_sourceCallbacks.erase(callbackIt);
+    }
 }
 
-bool SourceCollection::SetSourcePitch(SourceHandle source, float value)
+#ifdef AL_SOFT_callback_buffer
+ALsizei AL_APIENTRY SourceCollection::HandleBufferCallback(ALvoid* pUserData, ALvoid* pSamples, ALsizei byteCount)
 {
-    assert(IsValid(source));
+    CallbackStream& stream = *static_cast<CallbackStream*>(pUserData);
 
-    LOG_AUDIO->Debug("Source #{}: set pitch {}", source, value);
+    uint32_t const frameCount = static_cast<uint32_t>(byteCount) / stream.frameSize;
+    uint32_t const frames = std::min(stream.callback(pSamples, frameCount), frameCount);
 
-    // clear error state
-    ALenum alErr = alGetError();
-
-    alSourcef(static_cast<ALuint>(source), AL_PITCH, value);
+    return static_cast<ALsizei>(frames * stream.frameSize);
+}
+#endif
 
-    alErr = alGetError();
+void SourceCollection::RefreshSourceState(SourceHandle source)
+{
+    audio::Source::State const state = GetSourceState(source);
 
-    if (AL_NO_ERROR != alErr)
+    if (audio::Source::State::Playing == m_shadow.state[source] && audio::Source::State::Stopped == state)
     {
-        LOG_AUDIO->Warning("Source #{}: set pitch: {:#x}", source, alErr);
+        PushSourceEvent(audio::SourceEvent::Type::Stopped, source, 0);
     }
 
-    return AL_NO_ERROR == alErr;
+    m_shadow.state[source] = state;
 }
 
-float SourceCollection::GetSourceGain(SourceHandle source) const
+void SourceCollection::RestoreCulledSource(SourceHandle source)
 {
-    assert(IsValid(source));
-
-    // clear error state
-    ALenum alErr = alGetError();
-
-    ALfloat result = 0.0f;
-
-    alGetSourcef(static_cast<ALuint>(source), AL_GAIN, &result);
-
-    alErr = alGetError();
+    auto const culledIt = m_culledSources.find(source);
 
-    if (AL_NO_ERROR != alErr)
+    if (m_culledSources.end() == culledIt)
     {
-        result = -1.0f;
-        LOG_AUDIO->Warning("Source #{}: get gain: {:#x}", source, alErr);
+        return;
     }
 
-    return result;
-}
+    std::chrono::nanoseconds const clock = culledIt->second;
 
-bool SourceCollection::SetSourceGain(SourceHandle source, float value)
-{
-    assert(IsValid(source));
+    m_culledSources.erase(culledIt);
+
+    HotPath::Debug("Source #{}: restore culled at {}ns", source, clock.count());
 
-    LOG_AUDIO->Debug("Source #{}: set gain {}", source, value);
+    // streams are seeked by restarting their queue, which leaves them paused
+    SetSourcePlaybackPosition(source, clock);
 
     // clear error state
-    ALenum alErr = alGetError();
+    ALenum alErr = HotPath::GetError();
 
-    alSourcef(static_cast<ALuint>(source), AL_GAIN, value);
+    alSourcePlay(static_cast<ALuint>(source));
 
-    alErr = alGetError();
+    alErr = HotPath::GetError();
 
     if (AL_NO_ERROR != alErr)
     {
-        LOG_AUDIO->Warning("Source #{}: set gain: {:#x}", source, alErr);
+        LOG_AUDIO->Warning("Source #{}: restore culled: {:#x}", source, alErr);
+    }
+    else
+    {
+        m_shadow.state[source] = audio::Source::State::Playing;
     }
-
-    return AL_NO_ERROR == alErr;
 }
 
-std::array<float, 3> SourceCollection::GetSourcePosition(SourceHandle source) const
+void SourceCollection::PushSourceEvent(audio::SourceEvent::Type type, SourceHandle source, uint32_t count)
 {
-    assert(IsValid(source));
-
-    // clear error state
-    ALenum alErr = alGetError();
-
-    ALfloat x;
-    ALfloat y;
-    ALfloat z;
-
-    alGetSource3f(static_cast<ALuint>(source), AL_POSITION, &x, &y, &z);
-
-    alErr = alGetError();
-
-    if (AL_NO_ERROR != alErr)
+    if (s_maxSourceEvents <= m_events.size())
     {
-        LOG_AUDIO->Warning("Source #{}: get position: {:#x}", source, alErr);
+        LOG_AUDIO->Trace("Source #{}: event queue is full, dropping event", source);
 
-        x = std::numeric_limits<float>::quiet_NaN();
-        y = std::numeric_limits<float>::quiet_NaN();
-        z = std::numeric_limits<float>::quiet_NaN();
+        return;
     }
 
-    return {{ static_cast<float>(x), static_cast<float>(y), static_cast<float>(z) }};
+    audio::SourceEvent event;
+    event.type = type;
+    event.source = GetReference(source);
+    event.count = count;
+
+    m_events.push_back(event);
 }
 
-bool SourceCollection::SetSourcePosition(SourceHandle source, std::array<float, 3> const& vec)
+void SourceCollection::ReleaseSourceBuffers(SourceHandle source)
 {
-    assert(IsValid(source));
-
-    LOG_AUDIO->Debug("Source #{}: set position {{ {}, {}, {} }}", source, vec[0], vec[1], vec[2]);
+    auto bufferIt = m_sourceBuffers.find(source);
 
-    // clear error state
-    ALenum alErr = alGetError();
-
-    alSource3f(static_cast<ALuint>(source), AL_POSITION, static_cast<ALfloat>(vec[0]), static_cast<ALfloat>(vec[1]), static_cast<ALfloat>(vec[2]));
+    if (m_sourceBuffers.end() != bufferIt)
+    {
+        m_buffers.ReleaseBuffer(bufferIt->second);
+    }
 
-    alErr = alGetError();
+    auto queueIt = m_sourceQueuedBuffers.find(source);
 
-    if (AL_NO_ERROR != alErr)
+    if (m_sourceQueuedBuffers.end() != queueIt)
     {
-        LOG_AUDIO->Warning("Source #{}: set position: {:#x}", source, alErr);
+        for (BufferHandle buffer : queueIt->second)
+        {
+            m_buffers.ReleaseBuffer(buffer);
+        }
     }
-
-    return AL_NO_ERROR == alErr;
 }
 
-audio::Source SourceCollection::CreateObject(SourceHandle source)
+void SourceCollection::ReleaseSourceStream(SourceHandle source)
 {
-    assert(m_objects.cend() == m_objects.find(source));
+    auto streamIt = m_sourceStreams.find(source);
 
-    m_sourceBuffers.erase(source);
-    m_sourceQueuedBuffers.erase(source);
+    if (m_sourceStreams.end() != streamIt)
+    {
+        LOG_AUDIO->Trace("Source #{}: release stream", source);
 
-    return audio::Source(std::make_shared<SourceHandle>(source)
-        , std::make_shared<SourceCollection*>(const_cast<SourceCollection*>(this))
-    );
-}
+        std::vector<ALuint> alBuffers(streamIt->second.buffers.cbegin(), streamIt->second.buffers.cend());
 
-void SourceCollection::ResetSourceMeta(SourceHandle source)
-{
-    assert(IsValid(source));
+        // clear error state
+        ALenum alErr = HotPath::ClearError();
 
-    LOG_AUDIO->Debug("Source #{}: reset meta", source);
+        alSourceStop(static_cast<ALuint>(source));
+        alSourcei(static_cast<ALuint>(source), AL_BUFFER, 0);
+        alSourcei(static_cast<ALuint>(source), AL_LOOPING, (streamIt->second.isLooping ? AL_TRUE : AL_FALSE));
+        alDeleteBuffers(alBuffers.size(), alBuffers.data());
 
-    Meta& meta = m_sourceMeta[source];
+        alErr = alGetError();
 
-    {
-        using namespace std::chrono_literals;
+        if (AL_NO_ERROR == alErr)
+        {
+            m_shadow.isLooping[source] = static_cast<uint8_t>(streamIt->second.isLooping);
+            m_shadow.state[source] = audio::Source::State::Stopped;
+        }
+        else
+        {
+            LOG_AUDIO->Warning("Source #{}: release stream: {:#x}", source, alErr);
+        }
 
-        meta.activeSampleCount = 0;
-        meta.activeTotalDuration = 0ns;
+        m_sourceStreams.erase(streamIt);
     }
-
-    m_sourceQueuedBuffers[source].clear();
 }
 
 }
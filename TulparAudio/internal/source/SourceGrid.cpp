@@ -0,0 +1,252 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/SourceGrid.hpp>
+
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+
+//! Number of bits used per packed cell coordinate
+constexpr uint32_t s_coordinateBits = 21;
+
+//! Offset mapping signed cell coordinates to unsigned ones
+constexpr int32_t s_coordinateOffset = 1 << (s_coordinateBits - 1);
+
+//! Mask of a single packed cell coordinate
+constexpr uint64_t s_coordinateMask = (uint64_t(1) << s_coordinateBits) - 1;
+
+/** @brief  Converts given scaled position component to a cell coordinate
+ *
+ *  Coordinates are clamped to the packed range, non-finite values end up
+ *  in the border cells
+ */
+int32_t ToCoordinate(float value)
+{
+    float const low = static_cast<float>(-s_coordinateOffset);
+    float const high = static_cast<float>(s_coordinateOffset - 1);
+
+    value = std::floor(value);
+
+    if (!(value >= low))
+    {
+        value = low;
+    }
+    else if (value > high)
+    {
+        value = high;
+    }
+
+    return static_cast<int32_t>(value);
+}
+
+}
+
+namespace tulpar
+{
+namespace internal
+{
+
+SourceGrid::SourceGrid(float cellSize)
+    : m_cellSize(cellSize)
+    , m_entryCount(0)
+{
+    assert(cellSize > 0.0f);
+}
+
+void SourceGrid::SetCellSize(float cellSize)
+{
+    assert(cellSize > 0.0f);
+
+    m_cellSize = cellSize;
+    m_cells.clear();
+
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        Entry const& entry = m_entries[i];
+
+        if (entry.isStored)
+        {
+            Insert(static_cast<Handle>(i), MakeCellKey(GetCellCoordinates(entry.position)));
+        }
+    }
+}
+
+bool SourceGrid::Contains(Handle handle) const
+{
+    return (static_cast<size_t>(handle) < m_entries.size()) && m_entries[handle].isStored;
+}
+
+void SourceGrid::Update(Handle handle, std::array<float, 3> const& position)
+{
+    if (static_cast<size_t>(handle) >= m_entries.size())
+    {
+        m_entries.resize(static_cast<size_t>(handle) + 1);
+    }
+
+    Entry& entry = m_entries[handle];
+    CellKey const cell = MakeCellKey(GetCellCoordinates(position));
+
+    entry.position = position;
+
+    if (!entry.isStored)
+    {
+        entry.isStored = true;
+        ++m_entryCount;
+
+        Insert(handle, cell);
+    }
+    else if (entry.cell != cell)
+    {
+        Erase(handle);
+        Insert(handle, cell);
+    }
+}
+
+void SourceGrid::Remove(Handle handle)
+{
+    if (Contains(handle))
+    {
+        Erase(handle);
+
+        m_entries[handle].isStored = false;
+        --m_entryCount;
+    }
+}
+
+void SourceGrid::Query(std::array<float, 3> const& center, float radius, std::vector<Handle>& result) const
+{
+    if (!(radius >= 0.0f))
+    {
+        return;
+    }
+
+    float const radiusSq = radius * radius;
+
+    std::array<int32_t, 3> const low = GetCellCoordinates({{ center[0] - radius, center[1] - radius, center[2] - radius }});
+    std::array<int32_t, 3> const high = GetCellCoordinates({{ center[0] + radius, center[1] + radius, center[2] + radius }});
+
+    double const boxCellCount = (static_cast<double>(high[0] - low[0]) + 1.0)
+        * (static_cast<double>(high[1] - low[1]) + 1.0)
+        * (static_cast<double>(high[2] - low[2]) + 1.0);
+
+    if (boxCellCount > static_cast<double>(m_cells.size()))
+    {
+        for (auto const& cell : m_cells)
+        {
+            std::array<int32_t, 3> const coordinates = GetKeyCoordinates(cell.first);
+
+            if ((coordinates[0] >= low[0]) && (coordinates[0] <= high[0])
+                && (coordinates[1] >= low[1]) && (coordinates[1] <= high[1])
+                && (coordinates[2] >= low[2]) && (coordinates[2] <= high[2])
+            )
+            {
+                QueryCell(cell.second, center, radiusSq, result);
+            }
+        }
+
+        return;
+    }
+
+    for (int32_t x = low[0]; x <= high[0]; ++x)
+    {
+        for (int32_t y = low[1]; y <= high[1]; ++y)
+        {
+            for (int32_t z = low[2]; z <= high[2]; ++z)
+            {
+                auto const cellIt = m_cells.find(MakeCellKey({{ x, y, z }}));
+
+                if (m_cells.end() != cellIt)
+                {
+                    QueryCell(cellIt->second, center, radiusSq, result);
+                }
+            }
+        }
+    }
+}
+
+std::array<int32_t, 3> SourceGrid::GetCellCoordinates(std::array<float, 3> const& position) const
+{
+    return {{
+        ToCoordinate(position[0] / m_cellSize)
+        , ToCoordinate(position[1] / m_cellSize)
+        , ToCoordinate(position[2] / m_cellSize)
+    }};
+}
+
+SourceGrid::CellKey SourceGrid::MakeCellKey(std::array<int32_t, 3> const& coordinates)
+{
+    return (static_cast<uint64_t>(coordinates[0] + s_coordinateOffset) << (2 * s_coordinateBits))
+        | (static_cast<uint64_t>(coordinates[1] + s_coordinateOffset) << s_coordinateBits)
+        | static_cast<uint64_t>(coordinates[2] + s_coordinateOffset);
+}
+
+std::array<int32_t, 3> SourceGrid::GetKeyCoordinates(CellKey key)
+{
+    return {{
+        static_cast<int32_t>((key >> (2 * s_coordinateBits)) & s_coordinateMask) - s_coordinateOffset
+        , static_cast<int32_t>((key >> s_coordinateBits) & s_coordinateMask) - s_coordinateOffset
+        , static_cast<int32_t>(key & s_coordinateMask) - s_coordinateOffset
+    }};
+}
+
+void SourceGrid::QueryCell(std::vector<Handle> const& cell
+    , std::array<float, 3> const& center
+    , float radiusSq
+    , std::vector<Handle>& result
+) const
+{
+    for (Handle handle : cell)
+    {
+        std::array<float, 3> const& position = m_entries[handle].position;
+
+        float const dx = position[0] - center[0];
+        float const dy = position[1] - center[1];
+        float const dz = position[2] - center[2];
+
+        if ((dx * dx + dy * dy + dz * dz) <= radiusSq)
+        {
+            result.push_back(handle);
+        }
+    }
+}
+
+void SourceGrid::Insert(Handle handle, CellKey cell)
+{
+    std::vector<Handle>& handles = m_cells[cell];
+
+    Entry& entry = m_entries[handle];
+    entry.cell = cell;
+    entry.index = static_cast<uint32_t>(handles.size());
+
+    handles.push_back(handle);
+}
+
+void SourceGrid::Erase(Handle handle)
+{
+    Entry const& entry = m_entries[handle];
+
+    auto const cellIt = m_cells.find(entry.cell);
+    assert(m_cells.end() != cellIt);
+
+    std::vector<Handle>& handles = cellIt->second;
+    Handle const moved = handles.back();
+
+    handles[entry.index] = moved;
+    m_entries[moved].index = entry.index;
+
+    handles.pop_back();
+
+    if (handles.empty())
+    {
+        m_cells.erase(cellIt);
+    }
+}
+
+}
+}
@@ -0,0 +1,699 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/VoiceCollection.hpp>
+
+#include <tulpar/InternalLoggers.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace tulpar
+{
+namespace internal
+{
+
+void VirtualVoiceHandler::Reclaim(Collection<audio::Voice>::Handle /*handle*/)
+{
+
+}
+
+void VirtualVoiceHandler::Delete(Collection<audio::Voice>::Handles const& /*handles*/)
+{
+
+}
+
+VoiceCollection::VoiceCollection(SourceCollection& sources
+    , ListenerController const& listener
+    , Collection<audio::Voice>::HandleReclaimer reclaimer
+    , Collection<audio::Voice>::HandleDeleter deleter
+)
+    : Collection<audio::Voice>(nullptr, reclaimer, deleter)
+    , m_pSources(&sources)
+    , m_listener(listener)
+    , m_voiceLimit(0)
+    , m_realVoiceCount(0)
+    , m_nextHandle(0)
+{
+
+}
+
+VoiceCollection::~VoiceCollection()
+{
+    for (auto& voiceInfo : m_voiceInfo)
+    {
+        if (voiceInfo.second.source.IsValid())
+        {
+            voiceInfo.second.source.Reset();
+        }
+    }
+
+    for (audio::Source& source : m_freeSources)
+    {
+        if (source.IsValid())
+        {
+            source.Reset();
+        }
+    }
+}
+
+void VoiceCollection::SetVoiceLimit(uint32_t limit)
+{
+    LOG_AUDIO->Debug("Voices: limit = {}", limit);
+
+    m_voiceLimit = limit;
+}
+
+uint32_t VoiceCollection::GetRealVoiceCount() const
+{
+    return m_realVoiceCount;
+}
+
+void VoiceCollection::UpdateVoices(std::chrono::nanoseconds elapsed)
+{
+    m_candidates.clear();
+
+    // every used voice has its information stored
+    for (auto& voiceInfo : m_voiceInfo)
+    {
+        Handle const voice = voiceInfo.first;
+        VoiceInfo& info = voiceInfo.second;
+
+        if (audio::Source::State::Playing != info.state)
+        {
+            continue;
+        }
+
+        if (info.source.IsValid())
+        {
+            // real source is stopped only when playback is over
+            if (audio::Source::State::Stopped == m_pSources->GetSourceCachedState(*(info.source.GetSharedHandle())))
+            {
+                UnbindVoice(voice, false);
+
+                info.state = audio::Source::State::Stopped;
+                info.clock = std::chrono::nanoseconds(0);
+
+                continue;
+            }
+        }
+        else
+        {
+            int64_t const duration = info.duration.count();
+
+            info.clock += std::chrono::nanoseconds(
+                static_cast<int64_t>(std::round(static_cast<double>(elapsed.count()) * info.pitch))
+            );
+
+            if (info.clock.count() >= duration)
+            {
+                if (info.isLooping && 0 < duration)
+                {
+                    info.clock = std::chrono::nanoseconds(info.clock.count() % duration);
+                }
+                else
+                {
+                    info.state = audio::Source::State::Stopped;
+                    info.clock = std::chrono::nanoseconds(0);
+
+                    continue;
+                }
+            }
+        }
+
+        m_candidates.push_back(Candidate{ voice, &info, info.priority, ComputeAudibility(info) });
+    }
+
+    uint32_t const realCount = std::min(static_cast<uint32_t>(m_candidates.size()), m_voiceLimit);
+
+    std::partial_sort(m_candidates.begin(), m_candidates.begin() + realCount, m_candidates.end()
+        , [](Candidate const& lhs, Candidate const& rhs) -> bool
+        {
+            return (lhs.priority != rhs.priority)
+                ? (lhs.priority > rhs.priority)
+                : (lhs.audibility > rhs.audibility);
+        }
+    );
+
+    // virtualize voices that lost their place first to free real sources
+    for (uint32_t i = realCount; i < m_candidates.size(); ++i)
+    {
+        UnbindVoice(m_candidates[i].voice, true);
+    }
+
+    // release sources exceeding the limit
+    while (!m_freeSources.empty() && (m_realVoiceCount + m_freeSources.size()) > m_voiceLimit)
+    {
+        m_freeSources.back().Reset();
+        m_freeSources.pop_back();
+    }
+
+    for (uint32_t i = 0; i < realCount; ++i)
+    {
+        if (!m_candidates[i].pInfo->source.IsValid())
+        {
+            BindVoice(m_candidates[i].voice);
+        }
+    }
+}
+
+audio::Buffer VoiceCollection::GetVoiceBuffer(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).buffer;
+}
+
+bool VoiceCollection::SetVoiceBuffer(Handle voice, audio::Buffer buffer)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeHandle(Command::Type::VoiceBuffer, voice, *(buffer.GetSharedHandle())));
+
+        return true;
+    }
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    assert((audio::Source::State::Initial == info.state) || (audio::Source::State::Stopped == info.state));
+
+    LOG_AUDIO->Debug("Voice #{}: set buffer #{}", voice, *(buffer.GetSharedHandle()));
+
+    info.buffer = buffer;
+    info.clock = std::chrono::nanoseconds(0);
+    info.duration = buffer.IsValid() ? buffer.GetDuration() : std::chrono::nanoseconds(0);
+
+    return true;
+}
+
+void VoiceCollection::ResetVoice(Handle voice)
+{
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::VoiceReset, voice));
+
+        return;
+    }
+
+    LOG_AUDIO->Trace("Voice #{}: reset", voice);
+
+    UnbindVoice(voice, false);
+
+    Reclaim(voice);
+
+    m_voiceInfo.erase(voice);
+}
+
+bool VoiceCollection::PlayVoice(Handle voice)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::VoicePlay, voice));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Voice #{}: play", voice);
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    // buffer data might have been bound since the buffer was set
+    info.duration = GetVoicePlaybackDuration(voice);
+
+    if (0 == info.duration.count())
+    {
+        LOG_AUDIO->Warning("Voice #{}: play: no valid buffer", voice);
+
+        return false;
+    }
+
+    if (audio::Source::State::Playing == info.state)
+    {
+        return true;
+    }
+
+    if (audio::Source::State::Stopped == info.state)
+    {
+        info.clock = std::chrono::nanoseconds(0);
+    }
+
+    info.state = audio::Source::State::Playing;
+
+    // voices are ranked in UpdateVoices(), until then take a spare source if any
+    if (m_realVoiceCount < m_voiceLimit)
+    {
+        BindVoice(voice);
+    }
+
+    return true;
+}
+
+bool VoiceCollection::StopVoice(Handle voice)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::VoiceStop, voice));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Voice #{}: stop", voice);
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    UnbindVoice(voice, false);
+
+    info.state = audio::Source::State::Stopped;
+    info.clock = std::chrono::nanoseconds(0);
+
+    return true;
+}
+
+bool VoiceCollection::RewindVoice(Handle voice)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::VoiceRewind, voice));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Voice #{}: rewind", voice);
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    UnbindVoice(voice, false);
+
+    info.state = audio::Source::State::Initial;
+    info.clock = std::chrono::nanoseconds(0);
+
+    return true;
+}
+
+bool VoiceCollection::PauseVoice(Handle voice)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::Make(Command::Type::VoicePause, voice));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Voice #{}: pause", voice);
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    if (audio::Source::State::Playing == info.state)
+    {
+        UnbindVoice(voice, true);
+
+        info.state = audio::Source::State::Paused;
+    }
+
+    return true;
+}
+
+audio::Source::State VoiceCollection::GetVoiceState(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).state;
+}
+
+std::chrono::nanoseconds VoiceCollection::GetVoicePlaybackDuration(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    audio::Buffer const& buffer = m_voiceInfo.at(voice).buffer;
+
+    return buffer.IsValid() ? buffer.GetDuration() : std::chrono::nanoseconds(0);
+}
+
+std::chrono::nanoseconds VoiceCollection::GetVoicePlaybackPosition(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    VoiceInfo const& info = m_voiceInfo.at(voice);
+
+    if (info.source.IsValid())
+    {
+        return info.source.GetPlaybackPosition();
+    }
+
+    return info.clock;
+}
+
+bool VoiceCollection::SetVoicePlaybackPosition(Handle voice, std::chrono::nanoseconds offset)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeTime(Command::Type::VoicePlaybackPosition, voice, offset));
+
+        return true;
+    }
+
+    LOG_AUDIO->Debug("Voice #{}: set playback position {}ns", voice, offset.count());
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    info.clock = std::max(std::chrono::nanoseconds(0), std::min(offset, GetVoicePlaybackDuration(voice)));
+
+    return info.source.IsValid() ? info.source.SetPlaybackPosition(info.clock) : true;
+}
+
+int32_t VoiceCollection::GetVoicePriority(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).priority;
+}
+
+void VoiceCollection::SetVoicePriority(Handle voice, int32_t value)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeInteger(Command::Type::VoicePriority, voice, value));
+
+        return;
+    }
+
+    LOG_AUDIO->Debug("Voice #{}: set priority {}", voice, value);
+
+    m_voiceInfo.at(voice).priority = value;
+}
+
+float VoiceCollection::GetVoiceAudibility(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return ComputeAudibility(m_voiceInfo.at(voice));
+}
+
+bool VoiceCollection::IsVoiceVirtual(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return !m_voiceInfo.at(voice).source.IsValid();
+}
+
+bool VoiceCollection::IsVoiceRelative(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).isRelative;
+}
+
+bool VoiceCollection::SetVoiceRelative(Handle voice, bool flag)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeFlag(Command::Type::VoiceRelative, voice, flag));
+
+        return true;
+    }
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    info.isRelative = flag;
+
+    return info.source.IsValid() ? info.source.SetRelative(flag) : true;
+}
+
+bool VoiceCollection::IsVoiceLooping(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).isLooping;
+}
+
+bool VoiceCollection::SetVoiceLooping(Handle voice, bool flag)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeFlag(Command::Type::VoiceLooping, voice, flag));
+
+        return true;
+    }
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    info.isLooping = flag;
+
+    return info.source.IsValid() ? info.source.SetLooping(flag) : true;
+}
+
+float VoiceCollection::GetVoicePitch(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).pitch;
+}
+
+bool VoiceCollection::SetVoicePitch(Handle voice, float value)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::VoicePitch, voice, value));
+
+        return true;
+    }
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    info.pitch = value;
+
+    return info.source.IsValid() ? info.source.SetPitch(value) : true;
+}
+
+float VoiceCollection::GetVoiceGain(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).gain;
+}
+
+bool VoiceCollection::SetVoiceGain(Handle voice, float value)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeScalar(Command::Type::VoiceGain, voice, value));
+
+        return true;
+    }
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    info.gain = value;
+
+    return info.source.IsValid() ? info.source.SetGain(value) : true;
+}
+
+std::array<float, 3> VoiceCollection::GetVoicePosition(Handle voice) const
+{
+    ConsumerLock lock(m_pCommands);
+
+    assert(IsValid(voice));
+
+    return m_voiceInfo.at(voice).position;
+}
+
+bool VoiceCollection::SetVoicePosition(Handle voice, std::array<float, 3> const& vec)
+{
+    assert(IsValid(voice));
+
+    if (IsDeferringCommands())
+    {
+        PushCommand(Command::MakeVector(Command::Type::VoicePosition, voice, vec.data(), 3));
+
+        return true;
+    }
+
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    info.position = vec;
+
+    return info.source.IsValid() ? info.source.SetPosition(vec) : true;
+}
+
+audio::Voice VoiceCollection::CreateObject(Handle voice)
+{
+    assert(!IsValid(voice));
+
+    m_voiceInfo[voice] = VoiceInfo();
+
+    return audio::Voice(std::make_shared<Handle>(voice)
+        , std::make_shared<VoiceCollection*>(const_cast<VoiceCollection*>(this))
+    );
+}
+
+Collection<audio::Voice>::Handles VoiceCollection::GenerateHandles(uint32_t batchSize)
+{
+    LOG_AUDIO->Trace("Generating {} voices...", batchSize);
+
+    Handles result;
+    result.reserve(batchSize);
+
+    for (uint32_t i = 0; i < batchSize; ++i)
+    {
+        result.push_back(m_nextHandle++);
+    }
+
+    return result;
+}
+
+bool VoiceCollection::BindVoice(Handle voice)
+{
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    assert(!info.source.IsValid());
+
+    audio::Source source = AcquireSource();
+
+    if (!source.IsValid())
+    {
+        return false;
+    }
+
+    LOG_AUDIO->Trace("Voice #{}: bind source #{}", voice, *(source.GetSharedHandle()));
+
+    bool result = source.SetStaticBuffer(info.buffer);
+
+    result = source.SetRelative(info.isRelative) && result;
+    result = source.SetLooping(info.isLooping) && result;
+    result = source.SetPitch(info.pitch) && result;
+    result = source.SetGain(info.gain) && result;
+    result = source.SetPosition(info.position) && result;
+
+    if (0 != info.clock.count())
+    {
+        result = source.SetPlaybackPosition(info.clock) && result;
+    }
+
+    result = result && source.Play();
+
+    if (!result)
+    {
+        LOG_AUDIO->Warning("Voice #{}: couldn't bind source #{}", voice, *(source.GetSharedHandle()));
+
+        source.Stop();
+        source.ResetBuffer();
+
+        m_freeSources.push_back(source);
+
+        return false;
+    }
+
+    info.source = source;
+    ++m_realVoiceCount;
+
+    return true;
+}
+
+void VoiceCollection::UnbindVoice(Handle voice, bool saveClock)
+{
+    VoiceInfo& info = m_voiceInfo.at(voice);
+
+    if (!info.source.IsValid())
+    {
+        return;
+    }
+
+    LOG_AUDIO->Trace("Voice #{}: unbind source #{}", voice, *(info.source.GetSharedHandle()));
+
+    if (saveClock)
+    {
+        info.clock = info.source.GetPlaybackPosition();
+    }
+
+    info.source.Stop();
+    info.source.ResetBuffer();
+
+    m_freeSources.push_back(info.source);
+    info.source = audio::Source();
+
+    --m_realVoiceCount;
+}
+
+audio::Source VoiceCollection::AcquireSource()
+{
+    if (!m_freeSources.empty())
+    {
+        audio::Source source = m_freeSources.back();
+        m_freeSources.pop_back();
+
+        return source;
+    }
+
+    if ((m_realVoiceCount + m_freeSources.size()) < m_voiceLimit)
+    {
+        return m_pSources->Spawn();
+    }
+
+    return audio::Source();
+}
+
+float VoiceCollection::ComputeAudibility(VoiceInfo const& info) const
+{
+    std::array<float, 3> const origin = info.isRelative
+        ? std::array<float, 3>{{ 0.0f, 0.0f, 0.0f }}
+        : m_listener.GetListenerPosition();
+
+    float const dx = info.position[0] - origin[0];
+    float const dy = info.position[1] - origin[1];
+    float const dz = info.position[2] - origin[2];
+
+    float const distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    return info.gain / std::max(distance, 1.0f);
+}
+
+}
+}
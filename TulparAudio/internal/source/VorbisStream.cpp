@@ -0,0 +1,178 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/VorbisStream.hpp>
+
+#include <tulpar/InternalLoggers.hpp>
+
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+
+//! Vorbis channel index for each OpenAL 5.1 channel
+constexpr uint8_t s_vorbisOrder51[6] = { 0, 2, 1, 5, 3, 4 };
+
+//! Vorbis channel index for each OpenAL 7.1 channel
+constexpr uint8_t s_vorbisOrder71[8] = { 0, 2, 1, 7, 5, 6, 3, 4 };
+
+}
+
+namespace tulpar
+{
+namespace internal
+{
+
+VorbisStream::VorbisStream()
+    : m_asset()
+    , m_pVorbis(nullptr)
+    , m_channels(0)
+    , m_frequencyHz(0)
+    , m_frameCount(0)
+    , m_frameOffset(0)
+{
+
+}
+
+VorbisStream::~VorbisStream()
+{
+    Close();
+}
+
+bool VorbisStream::Open(mule::asset::Handler asset)
+{
+    Close();
+
+    LOG_AUDIO->Trace("VorbisStream: opening '{}'...", asset.GetName().c_str());
+
+    int error = 0;
+    mule::asset::Content const& content = asset.GetContent();
+
+    m_pVorbis = stb_vorbis_open_memory(content.GetBuffer().data(), content.GetSize(), &error, NULL);
+
+    if (VORBIS__no_error == error && nullptr != m_pVorbis)
+    {
+        stb_vorbis_info const vorbisInfo = stb_vorbis_get_info(m_pVorbis);
+
+        m_asset = asset;
+        m_channels = static_cast<uint8_t>(vorbisInfo.channels);
+        m_frequencyHz = vorbisInfo.sample_rate;
+        m_frameCount = stb_vorbis_stream_length_in_samples(m_pVorbis);
+        m_frameOffset = 0;
+
+        LOG_AUDIO->Debug(
+            "VorbisStream: '{}' channels: {}; frames: {}; rate: {}"
+            , asset.GetName().c_str()
+            , m_channels
+            , m_frameCount
+            , m_frequencyHz
+        );
+    }
+    else // if open_memory indicated some error, we don't have to close any resources
+    {
+        LOG_AUDIO->Error("VorbisStream: couldn't parse '{}' data", asset.GetName().c_str());
+
+        m_pVorbis = nullptr;
+    }
+
+    return IsOpen();
+}
+
+void VorbisStream::Close()
+{
+    if (IsOpen())
+    {
+        stb_vorbis_close(m_pVorbis);
+
+        m_pVorbis = nullptr;
+    }
+
+    m_asset = mule::asset::Handler();
+    m_channels = 0;
+    m_frequencyHz = 0;
+    m_frameCount = 0;
+    m_frameOffset = 0;
+}
+
+bool VorbisStream::Seek(uint32_t frame)
+{
+    assert(IsOpen());
+
+    bool const result = (0 == frame)
+        ? (0 != stb_vorbis_seek_start(m_pVorbis))
+        : ((frame < m_frameCount) && (0 != stb_vorbis_seek(m_pVorbis, frame)));
+
+    if (result)
+    {
+        m_frameOffset = frame;
+    }
+
+    return result;
+}
+
+uint32_t VorbisStream::Decode(int16_t* pSamples, uint32_t frameCount)
+{
+    assert(IsOpen());
+
+    uint32_t decoded = 0;
+
+    while (decoded < frameCount)
+    {
+        int const frames = stb_vorbis_get_samples_short_interleaved(m_pVorbis
+            , m_channels
+            , pSamples + decoded * m_channels
+            , (frameCount - decoded) * m_channels
+        );
+
+        if (frames <= 0)
+        {
+            break;
+        }
+
+        decoded += static_cast<uint32_t>(frames);
+    }
+
+    ReorderChannels(pSamples, decoded, m_channels);
+
+    m_frameOffset += decoded;
+
+    return decoded;
+}
+
+template<typename T>
+    void VorbisStream::ReorderChannels(T* pSamples, uint32_t frameCount, uint32_t channels)
+{
+    uint8_t const* pOrder = (6 == channels) ? s_vorbisOrder51 : ((8 == channels) ? s_vorbisOrder71 : nullptr);
+
+    if (nullptr == pOrder)
+    {
+        return;
+    }
+
+    T frame[8];
+
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        T* pFrame = pSamples + i * channels;
+
+        std::copy(pFrame, pFrame + channels, frame);
+
+        for (uint32_t channel = 0; channel < channels; ++channel)
+        {
+            pFrame[channel] = frame[pOrder[channel]];
+        }
+    }
+}
+
+template void VorbisStream::ReorderChannels<int16_t>(int16_t*, uint32_t, uint32_t);
+template void VorbisStream::ReorderChannels<float>(float*, uint32_t, uint32_t);
+
+}
+}
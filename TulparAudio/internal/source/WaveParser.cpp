@@ -0,0 +1,166 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/WaveParser.hpp>
+
+#include <tulpar/InternalLoggers.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+//! Size of RIFF header including WAVE identifier
+constexpr size_t s_riffHeaderSize = 12;
+
+//! Size of chunk header
+constexpr size_t s_chunkHeaderSize = 8;
+
+//! Minimal size of fmt chunk
+constexpr size_t s_formatChunkSize = 16;
+
+//! Size of fmt chunk with WAVE_FORMAT_EXTENSIBLE fields
+constexpr size_t s_extensibleChunkSize = 40;
+
+//! Integer PCM format tag
+constexpr uint16_t s_formatPcm = 0x0001;
+
+//! IEEE float format tag
+constexpr uint16_t s_formatFloat = 0x0003;
+
+//! Extensible format tag, actual tag is the head of subformat GUID
+constexpr uint16_t s_formatExtensible = 0xFFFE;
+
+//! Reads little-endian 16-bit value
+uint16_t ReadLittleEndian16(uint8_t const* pData)
+{
+    return static_cast<uint16_t>(pData[0] | (pData[1] << 8));
+}
+
+//! Reads little-endian 32-bit value
+uint32_t ReadLittleEndian32(uint8_t const* pData)
+{
+    return static_cast<uint32_t>(pData[0])
+        | (static_cast<uint32_t>(pData[1]) << 8)
+        | (static_cast<uint32_t>(pData[2]) << 16)
+        | (static_cast<uint32_t>(pData[3]) << 24);
+}
+
+//! Checks if chunk at given data has given identifier
+bool IsChunk(uint8_t const* pData, char const* id)
+{
+    return 0 == std::memcmp(pData, id, 4);
+}
+
+}
+
+namespace tulpar
+{
+namespace internal
+{
+
+bool WaveParser::IsWave(uint8_t const* pData, size_t size)
+{
+    return (size >= s_riffHeaderSize)
+        && IsChunk(pData, "RIFF")
+        && IsChunk(pData + 8, "WAVE");
+}
+
+bool WaveParser::Parse(uint8_t const* pData, size_t size, PcmData& pcm)
+{
+    if (!IsWave(pData, size))
+    {
+        return false;
+    }
+
+    uint8_t const* pFormat = nullptr;
+    uint8_t const* pSamples = nullptr;
+    size_t formatSize = 0;
+    size_t samplesSize = 0;
+
+    size_t offset = s_riffHeaderSize;
+
+    while ((offset + s_chunkHeaderSize) <= size)
+    {
+        uint8_t const* pChunk = pData + offset;
+        size_t const chunkSize = std::min<size_t>(ReadLittleEndian32(pChunk + 4), size - offset - s_chunkHeaderSize);
+
+        if (IsChunk(pChunk, "fmt "))
+        {
+            pFormat = pChunk + s_chunkHeaderSize;
+            formatSize = chunkSize;
+        }
+        else if (IsChunk(pChunk, "data"))
+        {
+            pSamples = pChunk + s_chunkHeaderSize;
+            samplesSize = chunkSize;
+        }
+
+        // chunks are padded to even size
+        offset += s_chunkHeaderSize + chunkSize + (chunkSize & 1);
+    }
+
+    if (nullptr == pFormat || formatSize < s_formatChunkSize || nullptr == pSamples)
+    {
+        LOG_AUDIO->Warning("Wave: missing fmt or data chunk");
+
+        return false;
+    }
+
+    uint16_t formatTag = ReadLittleEndian16(pFormat);
+    uint16_t const channels = ReadLittleEndian16(pFormat + 2);
+    uint32_t const frequencyHz = ReadLittleEndian32(pFormat + 4);
+    uint16_t const blockAlign = ReadLittleEndian16(pFormat + 12);
+    uint16_t const bitsPerSample = ReadLittleEndian16(pFormat + 14);
+
+    if (s_formatExtensible == formatTag && formatSize >= s_extensibleChunkSize)
+    {
+        formatTag = ReadLittleEndian16(pFormat + 24);
+    }
+
+    if (s_formatPcm == formatTag && 8 == bitsPerSample)
+    {
+        pcm.format = PcmData::Format::UInt8;
+    }
+    else if (s_formatPcm == formatTag && 16 == bitsPerSample)
+    {
+        pcm.format = PcmData::Format::Int16;
+    }
+    else if (s_formatFloat == formatTag && 32 == bitsPerSample)
+    {
+        pcm.format = PcmData::Format::Float32;
+    }
+    else
+    {
+        LOG_AUDIO->Warning("Wave: unsupported format {:#x} with {} bits per sample", formatTag, bitsPerSample);
+
+        return false;
+    }
+
+    // WAVE channel order matches OpenAL one for all supported layouts
+    if (!PcmData::IsLayoutSupported(channels)
+        || 0 == frequencyHz
+        || blockAlign != channels * PcmData::GetSampleSize(pcm.format))
+    {
+        LOG_AUDIO->Warning("Wave: unsupported layout, channels: {}; rate: {}; block: {}", channels, frequencyHz, blockAlign);
+
+        return false;
+    }
+
+    pcm.channels = static_cast<uint8_t>(channels);
+    pcm.frequencyHz = frequencyHz;
+    pcm.bytes.clear();
+    pcm.pContent = pSamples;
+
+    // drop trailing partial frame
+    pcm.contentSize = static_cast<uint32_t>(samplesSize - (samplesSize % blockAlign));
+
+    return true;
+}
+
+}
+}
@@ -0,0 +1,92 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/internal/WorkerPool.hpp>
+
+#include <tulpar/InternalLoggers.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace tulpar
+{
+namespace internal
+{
+
+WorkerPool::WorkerPool(uint32_t threadCount)
+    : m_isRunning(true)
+{
+    if (0 == threadCount)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    LOG_AUDIO->Debug("WorkerPool: starting {} threads", threadCount);
+
+    m_threads.reserve(threadCount);
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&WorkerPool::Run, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_isRunning = false;
+    }
+
+    m_condition.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+
+    LOG_AUDIO->Debug("WorkerPool: stopped {} threads", m_threads.size());
+}
+
+void WorkerPool::Submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_jobs.push(std::move(job));
+    }
+
+    m_condition.notify_one();
+}
+
+void WorkerPool::Run()
+{
+    for (;;)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_condition.wait(lock, [this]() -> bool { return !m_isRunning || !m_jobs.empty(); });
+
+            // finish queued jobs before stopping
+            if (m_jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+        }
+
+        job();
+    }
+}
+
+}
+}
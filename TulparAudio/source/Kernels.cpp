@@ -0,0 +1,725 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#include <tulpar/Kernels.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TULPAR_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TULPAR_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(TULPAR_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+//! Allows AVX2 intrinsics in a function without enabling them globally
+#define TULPAR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TULPAR_TARGET_AVX2
+#endif
+
+namespace
+{
+
+using tulpar::kernels::InstructionSet;
+
+//! Scale between normalized float and 16-bit samples
+constexpr float s_int16Scale = 32767.0f;
+
+//! Set of kernel implementations
+struct KernelTable
+{
+    InstructionSet set;
+    void (*int16ToFloat)(int16_t const*, float*, size_t);
+    void (*floatToInt16)(float const*, int16_t*, size_t);
+    void (*downmixFloat)(float const*, float*, size_t);
+    void (*downmixInt16)(int16_t const*, int16_t*, size_t);
+    void (*scaleGain)(float*, size_t, float);
+    void (*interleaveStereo)(float const*, float const*, size_t, float*);
+    void (*deinterleaveStereo)(float const*, size_t, float*, float*);
+};
+
+namespace scalar
+{
+
+void Int16ToFloat(int16_t const* pIn, float* pOut, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        pOut[i] = static_cast<float>(pIn[i]) * (1.0f / s_int16Scale);
+    }
+}
+
+void FloatToInt16(float const* pIn, int16_t* pOut, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float const value = std::max(-1.0f, std::min(1.0f, pIn[i]));
+
+        // round half to even as SIMD conversions do
+        pOut[i] = static_cast<int16_t>(std::lrint(value * s_int16Scale));
+    }
+}
+
+void DownmixFloat(float const* pIn, float* pOut, size_t frameCount)
+{
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        pOut[i] = (pIn[2 * i] + pIn[2 * i + 1]) * 0.5f;
+    }
+}
+
+void DownmixInt16(int16_t const* pIn, int16_t* pOut, size_t frameCount)
+{
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        pOut[i] = static_cast<int16_t>((static_cast<int32_t>(pIn[2 * i]) + static_cast<int32_t>(pIn[2 * i + 1])) >> 1);
+    }
+}
+
+void ScaleGain(float* pSamples, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        pSamples[i] *= gain;
+    }
+}
+
+void InterleaveStereo(float const* pLeft, float const* pRight, size_t frameCount, float* pOut)
+{
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        pOut[2 * i] = pLeft[i];
+        pOut[2 * i + 1] = pRight[i];
+    }
+}
+
+void DeinterleaveStereo(float const* pIn, size_t frameCount, float* pLeft, float* pRight)
+{
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        pLeft[i] = pIn[2 * i];
+        pRight[i] = pIn[2 * i + 1];
+    }
+}
+
+KernelTable const s_table = {
+    InstructionSet::Scalar
+    , Int16ToFloat
+    , FloatToInt16
+    , DownmixFloat
+    , DownmixInt16
+    , ScaleGain
+    , InterleaveStereo
+    , DeinterleaveStereo
+};
+
+}
+
+#ifdef TULPAR_KERNELS_X86
+namespace sse2
+{
+
+void Int16ToFloat(int16_t const* pIn, float* pOut, size_t count)
+{
+    __m128 const scale = _mm_set1_ps(1.0f / s_int16Scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i const samples = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pIn + i));
+
+        // duplicate into high halves and shift back to sign extend
+        __m128i const low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i const high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+
+        _mm_storeu_ps(pOut + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(pOut + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+
+    scalar::Int16ToFloat(pIn + i, pOut + i, count - i);
+}
+
+void FloatToInt16(float const* pIn, int16_t* pOut, size_t count)
+{
+    __m128 const scale = _mm_set1_ps(s_int16Scale);
+    __m128 const minimum = _mm_set1_ps(-1.0f);
+    __m128 const maximum = _mm_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128 const low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pIn + i), minimum), maximum);
+        __m128 const high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pIn + i + 4), minimum), maximum);
+
+        __m128i const packed = _mm_packs_epi32(
+            _mm_cvtps_epi32(_mm_mul_ps(low, scale))
+            , _mm_cvtps_epi32(_mm_mul_ps(high, scale))
+        );
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), packed);
+    }
+
+    scalar::FloatToInt16(pIn + i, pOut + i, count - i);
+}
+
+void DownmixFloat(float const* pIn, float* pOut, size_t frameCount)
+{
+    __m128 const half = _mm_set1_ps(0.5f);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4)
+    {
+        __m128 const a = _mm_loadu_ps(pIn + 2 * i);
+        __m128 const b = _mm_loadu_ps(pIn + 2 * i + 4);
+
+        __m128 const left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 const right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+        _mm_storeu_ps(pOut + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+    }
+
+    scalar::DownmixFloat(pIn + 2 * i, pOut + i, frameCount - i);
+}
+
+void DownmixInt16(int16_t const* pIn, int16_t* pOut, size_t frameCount)
+{
+    __m128i const ones = _mm_set1_epi16(1);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8)
+    {
+        // multiply-add by one sums each left and right pair into 32 bits
+        __m128i const low = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(pIn + 2 * i)), ones);
+        __m128i const high = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(pIn + 2 * i + 8)), ones);
+
+        __m128i const packed = _mm_packs_epi32(_mm_srai_epi32(low, 1), _mm_srai_epi32(high, 1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), packed);
+    }
+
+    scalar::DownmixInt16(pIn + 2 * i, pOut + i, frameCount - i);
+}
+
+void ScaleGain(float* pSamples, size_t count, float gain)
+{
+    __m128 const factor = _mm_set1_ps(gain);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(pSamples + i, _mm_mul_ps(_mm_loadu_ps(pSamples + i), factor));
+    }
+
+    scalar::ScaleGain(pSamples + i, count - i, gain);
+}
+
+void InterleaveStereo(float const* pLeft, float const* pRight, size_t frameCount, float* pOut)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4)
+    {
+        __m128 const left = _mm_loadu_ps(pLeft + i);
+        __m128 const right = _mm_loadu_ps(pRight + i);
+
+        _mm_storeu_ps(pOut + 2 * i, _mm_unpacklo_ps(left, right));
+        _mm_storeu_ps(pOut + 2 * i + 4, _mm_unpackhi_ps(left, right));
+    }
+
+    scalar::InterleaveStereo(pLeft + i, pRight + i, frameCount - i, pOut + 2 * i);
+}
+
+void DeinterleaveStereo(float const* pIn, size_t frameCount, float* pLeft, float* pRight)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4)
+    {
+        __m128 const a = _mm_loadu_ps(pIn + 2 * i);
+        __m128 const b = _mm_loadu_ps(pIn + 2 * i + 4);
+
+        _mm_storeu_ps(pLeft + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(pRight + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    scalar::DeinterleaveStereo(pIn + 2 * i, frameCount - i, pLeft + i, pRight + i);
+}
+
+KernelTable const s_table = {
+    InstructionSet::Sse2
+    , Int16ToFloat
+    , FloatToInt16
+    , DownmixFloat
+    , DownmixInt16
+    , ScaleGain
+    , InterleaveStereo
+    , DeinterleaveStereo
+};
+
+}
+
+namespace avx2
+{
+
+//! Restores order of 64-bit blocks after per-lane packing or horizontal add
+TULPAR_TARGET_AVX2 __m256i FixLanes(__m256i value)
+{
+    return _mm256_permute4x64_epi64(value, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+TULPAR_TARGET_AVX2 void Int16ToFloat(int16_t const* pIn, float* pOut, size_t count)
+{
+    __m256 const scale = _mm256_set1_ps(1.0f / s_int16Scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i const samples = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(pIn + i)));
+
+        _mm256_storeu_ps(pOut + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+
+    scalar::Int16ToFloat(pIn + i, pOut + i, count - i);
+}
+
+TULPAR_TARGET_AVX2 void FloatToInt16(float const* pIn, int16_t* pOut, size_t count)
+{
+    __m256 const scale = _mm256_set1_ps(s_int16Scale);
+    __m256 const minimum = _mm256_set1_ps(-1.0f);
+    __m256 const maximum = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256 const low = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pIn + i), minimum), maximum);
+        __m256 const high = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pIn + i + 8), minimum), maximum);
+
+        __m256i const packed = _mm256_packs_epi32(
+            _mm256_cvtps_epi32(_mm256_mul_ps(low, scale))
+            , _mm256_cvtps_epi32(_mm256_mul_ps(high, scale))
+        );
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + i), FixLanes(packed));
+    }
+
+    sse2::FloatToInt16(pIn + i, pOut + i, count - i);
+}
+
+TULPAR_TARGET_AVX2 void DownmixFloat(float const* pIn, float* pOut, size_t frameCount)
+{
+    __m256 const half = _mm256_set1_ps(0.5f);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8)
+    {
+        __m256 const sum = _mm256_hadd_ps(_mm256_loadu_ps(pIn + 2 * i), _mm256_loadu_ps(pIn + 2 * i + 8));
+        __m256 const ordered = _mm256_castsi256_ps(FixLanes(_mm256_castps_si256(sum)));
+
+        _mm256_storeu_ps(pOut + i, _mm256_mul_ps(ordered, half));
+    }
+
+    sse2::DownmixFloat(pIn + 2 * i, pOut + i, frameCount - i);
+}
+
+TULPAR_TARGET_AVX2 void DownmixInt16(int16_t const* pIn, int16_t* pOut, size_t frameCount)
+{
+    __m256i const ones = _mm256_set1_epi16(1);
+    size_t i = 0;
+
+    for (; i + 16 <= frameCount; i += 16)
+    {
+        __m256i const low = _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(pIn + 2 * i)), ones);
+        __m256i const high = _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(pIn + 2 * i + 16)), ones);
+
+        __m256i const packed = _mm256_packs_epi32(_mm256_srai_epi32(low, 1), _mm256_srai_epi32(high, 1));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + i), FixLanes(packed));
+    }
+
+    sse2::DownmixInt16(pIn + 2 * i, pOut + i, frameCount - i);
+}
+
+TULPAR_TARGET_AVX2 void ScaleGain(float* pSamples, size_t count, float gain)
+{
+    __m256 const factor = _mm256_set1_ps(gain);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(pSamples + i, _mm256_mul_ps(_mm256_loadu_ps(pSamples + i), factor));
+    }
+
+    scalar::ScaleGain(pSamples + i, count - i, gain);
+}
+
+TULPAR_TARGET_AVX2 void InterleaveStereo(float const* pLeft, float const* pRight, size_t frameCount, float* pOut)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8)
+    {
+        __m256 const left = _mm256_loadu_ps(pLeft + i);
+        __m256 const right = _mm256_loadu_ps(pRight + i);
+
+        // unpacking works within 128-bit lanes
+        __m256 const low = _mm256_unpacklo_ps(left, right);
+        __m256 const high = _mm256_unpackhi_ps(left, right);
+
+        _mm256_storeu_ps(pOut + 2 * i, _mm256_permute2f128_ps(low, high, 0x20));
+        _mm256_storeu_ps(pOut + 2 * i + 8, _mm256_permute2f128_ps(low, high, 0x31));
+    }
+
+    sse2::InterleaveStereo(pLeft + i, pRight + i, frameCount - i, pOut + 2 * i);
+}
+
+TULPAR_TARGET_AVX2 void DeinterleaveStereo(float const* pIn, size_t frameCount, float* pLeft, float* pRight)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8)
+    {
+        __m256 const a = _mm256_loadu_ps(pIn + 2 * i);
+        __m256 const b = _mm256_loadu_ps(pIn + 2 * i + 8);
+
+        __m256 const left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 const right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+        _mm256_storeu_ps(pLeft + i, _mm256_castsi256_ps(FixLanes(_mm256_castps_si256(left))));
+        _mm256_storeu_ps(pRight + i, _mm256_castsi256_ps(FixLanes(_mm256_castps_si256(right))));
+    }
+
+    sse2::DeinterleaveStereo(pIn + 2 * i, frameCount - i, pLeft + i, pRight + i);
+}
+
+KernelTable const s_table = {
+    InstructionSet::Avx2
+    , Int16ToFloat
+    , FloatToInt16
+    , DownmixFloat
+    , DownmixInt16
+    , ScaleGain
+    , InterleaveStereo
+    , DeinterleaveStereo
+};
+
+}
+#endif
+
+#ifdef TULPAR_KERNELS_NEON
+namespace neon
+{
+
+void Int16ToFloat(int16_t const* pIn, float* pOut, size_t count)
+{
+    float32x4_t const scale = vdupq_n_f32(1.0f / s_int16Scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t const samples = vld1q_s16(pIn + i);
+
+        vst1q_f32(pOut + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), scale));
+        vst1q_f32(pOut + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+    }
+
+    scalar::Int16ToFloat(pIn + i, pOut + i, count - i);
+}
+
+void FloatToInt16(float const* pIn, int16_t* pOut, size_t count)
+{
+    float32x4_t const scale = vdupq_n_f32(s_int16Scale);
+    float32x4_t const minimum = vdupq_n_f32(-1.0f);
+    float32x4_t const maximum = vdupq_n_f32(1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        float32x4_t const low = vminq_f32(vmaxq_f32(vld1q_f32(pIn + i), minimum), maximum);
+        float32x4_t const high = vminq_f32(vmaxq_f32(vld1q_f32(pIn + i + 4), minimum), maximum);
+
+        int16x8_t const packed = vcombine_s16(
+            vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(low, scale)))
+            , vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(high, scale)))
+        );
+
+        vst1q_s16(pOut + i, packed);
+    }
+
+    scalar::FloatToInt16(pIn + i, pOut + i, count - i);
+}
+
+void DownmixFloat(float const* pIn, float* pOut, size_t frameCount)
+{
+    float32x4_t const half = vdupq_n_f32(0.5f);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4)
+    {
+        float32x4x2_t const frames = vld2q_f32(pIn + 2 * i);
+
+        vst1q_f32(pOut + i, vmulq_f32(vaddq_f32(frames.val[0], frames.val[1]), half));
+    }
+
+    scalar::DownmixFloat(pIn + 2 * i, pOut + i, frameCount - i);
+}
+
+void DownmixInt16(int16_t const* pIn, int16_t* pOut, size_t frameCount)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8)
+    {
+        int16x8x2_t const frames = vld2q_s16(pIn + 2 * i);
+
+        // halving add rounds down as the scalar shift does
+        vst1q_s16(pOut + i, vhaddq_s16(frames.val[0], frames.val[1]));
+    }
+
+    scalar::DownmixInt16(pIn + 2 * i, pOut + i, frameCount - i);
+}
+
+void ScaleGain(float* pSamples, size_t count, float gain)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(pSamples + i, vmulq_n_f32(vld1q_f32(pSamples + i), gain));
+    }
+
+    scalar::ScaleGain(pSamples + i, count - i, gain);
+}
+
+void InterleaveStereo(float const* pLeft, float const* pRight, size_t frameCount, float* pOut)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4)
+    {
+        float32x4x2_t frames;
+        frames.val[0] = vld1q_f32(pLeft + i);
+        frames.val[1] = vld1q_f32(pRight + i);
+
+        vst2q_f32(pOut + 2 * i, frames);
+    }
+
+    scalar::InterleaveStereo(pLeft + i, pRight + i, frameCount - i, pOut + 2 * i);
+}
+
+void DeinterleaveStereo(float const* pIn, size_t frameCount, float* pLeft, float* pRight)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4)
+    {
+        float32x4x2_t const frames = vld2q_f32(pIn + 2 * i);
+
+        vst1q_f32(pLeft + i, frames.val[0]);
+        vst1q_f32(pRight + i, frames.val[1]);
+    }
+
+    scalar::DeinterleaveStereo(pIn + 2 * i, frameCount - i, pLeft + i, pRight + i);
+}
+
+KernelTable const s_table = {
+    InstructionSet::Neon
+    , Int16ToFloat
+    , FloatToInt16
+    , DownmixFloat
+    , DownmixInt16
+    , ScaleGain
+    , InterleaveStereo
+    , DeinterleaveStereo
+};
+
+}
+#endif
+
+#ifdef TULPAR_KERNELS_X86
+//! Checks if CPU and OS support AVX2
+bool IsAvx2Supported()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 0 != __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 1);
+
+    bool const isOsSaving = (0 != (info[2] & (1 << 27)));
+    bool const isAvx = (0 != (info[2] & (1 << 28)));
+
+    if (!isOsSaving || !isAvx || (6 != (_xgetbv(0) & 6)))
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+
+    return 0 != (info[1] & (1 << 5));
+#else
+    return false;
+#endif
+}
+#endif
+
+//! Returns kernels for given instruction set, @c nullptr if not compiled in
+KernelTable const* GetTable(InstructionSet set)
+{
+    switch (set)
+    {
+        case InstructionSet::Scalar:
+            return &scalar::s_table;
+#ifdef TULPAR_KERNELS_X86
+        case InstructionSet::Sse2:
+            return &sse2::s_table;
+        case InstructionSet::Avx2:
+            return IsAvx2Supported() ? &avx2::s_table : nullptr;
+#endif
+#ifdef TULPAR_KERNELS_NEON
+        case InstructionSet::Neon:
+            return &neon::s_table;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+//! Returns the best kernels supported by the CPU
+KernelTable const* SelectTable()
+{
+    InstructionSet const sets[] = { InstructionSet::Avx2, InstructionSet::Neon, InstructionSet::Sse2 };
+
+    for (InstructionSet set : sets)
+    {
+        if (KernelTable const* pTable = GetTable(set))
+        {
+            return pTable;
+        }
+    }
+
+    return &scalar::s_table;
+}
+
+//! Kernels calls are dispatched to
+std::atomic<KernelTable const*> s_pTable(nullptr);
+
+//! Returns kernels calls are dispatched to
+KernelTable const& GetTable()
+{
+    KernelTable const* pTable = s_pTable.load(std::memory_order_acquire);
+
+    if (nullptr == pTable)
+    {
+        // selection is idempotent, racing threads store the same value
+        pTable = SelectTable();
+
+        s_pTable.store(pTable, std::memory_order_release);
+    }
+
+    return *pTable;
+}
+
+}
+
+namespace tulpar
+{
+namespace kernels
+{
+
+InstructionSet GetInstructionSet()
+{
+    return GetTable().set;
+}
+
+bool IsInstructionSetSupported(InstructionSet set)
+{
+    return nullptr != GetTable(set);
+}
+
+bool SetInstructionSet(InstructionSet set)
+{
+    KernelTable const* pTable = GetTable(set);
+
+    if (nullptr != pTable)
+    {
+        s_pTable.store(pTable, std::memory_order_release);
+    }
+
+    return nullptr != pTable;
+}
+
+void ConvertInt16ToFloat(int16_t const* pIn, float* pOut, size_t count)
+{
+    GetTable().int16ToFloat(pIn, pOut, count);
+}
+
+void ConvertFloatToInt16(float const* pIn, int16_t* pOut, size_t count)
+{
+    GetTable().floatToInt16(pIn, pOut, count);
+}
+
+void DownmixStereoToMono(float const* pIn, float* pOut, size_t frameCount)
+{
+    GetTable().downmixFloat(pIn, pOut, frameCount);
+}
+
+void DownmixStereoToMono(int16_t const* pIn, int16_t* pOut, size_t frameCount)
+{
+    GetTable().downmixInt16(pIn, pOut, frameCount);
+}
+
+void ScaleGain(float* pSamples, size_t count, float gain)
+{
+    GetTable().scaleGain(pSamples, count, gain);
+}
+
+void Interleave(float const* const* ppPlanes, uint32_t channels, size_t frameCount, float* pOut)
+{
+    if (2 == channels)
+    {
+        GetTable().interleaveStereo(ppPlanes[0], ppPlanes[1], frameCount, pOut);
+
+        return;
+    }
+
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        for (uint32_t channel = 0; channel < channels; ++channel)
+        {
+            pOut[i * channels + channel] = ppPlanes[channel][i];
+        }
+    }
+}
+
+void Deinterleave(float const* pIn, uint32_t channels, size_t frameCount, float* const* ppPlanes)
+{
+    if (2 == channels)
+    {
+        GetTable().deinterleaveStereo(pIn, frameCount, ppPlanes[0], ppPlanes[1]);
+
+        return;
+    }
+
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        for (uint32_t channel = 0; channel < channels; ++channel)
+        {
+            ppPlanes[channel][i] = pIn[i * channels + channel];
+        }
+    }
+}
+
+}
+}
@@ -7,26 +7,121 @@
 #include <tulpar/TulparAudio.hpp>
 
 #include <tulpar/internal/BufferCollection.hpp>
+#include <tulpar/internal/CommandQueue.hpp>
 #include <tulpar/internal/Context.hpp>
 #include <tulpar/internal/Device.hpp>
 #include <tulpar/internal/ListenerController.hpp>
+#include <tulpar/internal/PcmCache.hpp>
 #include <tulpar/internal/SourceCollection.hpp>
+#include <tulpar/internal/VoiceCollection.hpp>
+#include <tulpar/internal/WorkerPool.hpp>
 
 #include <tulpar/InternalLoggers.hpp>
 #include <tulpar/Loggers.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <fstream>
+
+namespace
+{
+
+//! Number of sample frames rendered at once by TulparAudio::RenderToFile()
+constexpr uint32_t s_renderChunkFrames = 4096;
+
+//! Writes little-endian integer of given size
+void WriteLittleEndian(std::ostream& os, uint32_t value, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        os.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+//! Writes header of 16-bit PCM WAV file
+void WriteWavHeader(std::ostream& os, uint32_t frequencyHz, uint32_t channelCount, uint32_t frameCount)
+{
+    uint32_t const blockAlign = channelCount * sizeof(int16_t);
+    uint32_t const dataSize = frameCount * blockAlign;
+
+    os.write("RIFF", 4);
+    WriteLittleEndian(os, 36 + dataSize, 4);
+    os.write("WAVE", 4);
+
+    os.write("fmt ", 4);
+    WriteLittleEndian(os, 16, 4);
+    WriteLittleEndian(os, 1, 2);
+    WriteLittleEndian(os, channelCount, 2);
+    WriteLittleEndian(os, frequencyHz, 4);
+    WriteLittleEndian(os, frequencyHz * blockAlign, 4);
+    WriteLittleEndian(os, blockAlign, 2);
+    WriteLittleEndian(os, 16, 2);
+
+    os.write("data", 4);
+    WriteLittleEndian(os, dataSize, 4);
+}
+
+//! Writes 16-bit samples in little-endian order
+void WriteSamples(std::ostream& os, int16_t const* pSamples, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        WriteLittleEndian(os, static_cast<uint16_t>(pSamples[i]), 2);
+    }
+}
+
+//! Returns handles of given source objects
+tulpar::internal::SourceCollection::Handles GetSourceHandles(std::vector<tulpar::audio::Source> const& sources)
+{
+    tulpar::internal::SourceCollection::Handles result;
+    result.reserve(sources.size());
+
+    for (tulpar::audio::Source const& source : sources)
+    {
+        assert(source.IsValid());
+
+        result.push_back(*source.GetSharedHandle());
+    }
+
+    return result;
+}
+
+}
 
 namespace tulpar
 {
 
+TulparAudio::UpdateBatch::UpdateBatch(TulparAudio& audio)
+    : m_audio(audio)
+{
+    m_audio.BeginFrame();
+}
+
+TulparAudio::UpdateBatch::~UpdateBatch()
+{
+    m_audio.EndFrame();
+}
+
 TulparAudio::TulparAudio()
     : m_isInitialized(false)
+    , m_frameDepth(0)
     , m_device(nullptr)
     , m_context(nullptr)
     , m_listener(new internal::ListenerController())
+    , m_workers(nullptr)
+    , m_pcmCache(nullptr)
     , m_buffers(nullptr)
     , m_sources(nullptr)
+    , m_voices(nullptr)
+    , m_cullThreshold(0.0f)
+    , m_lastUpdate()
+    , m_renderedTime(0)
+    , m_commands(nullptr)
+    , m_thread()
+    , m_threadMutex()
+    , m_isThreadRunning(false)
+    , m_threadPeriod(0)
 {
 
 }
@@ -54,13 +149,41 @@ bool TulparAudio::Initialize(TulparConfigurator const& config)
         {
             m_context->MakeCurrent();
 
+            m_workers = std::make_shared<internal::WorkerPool>(config.decoderThreads);
+            m_pcmCache = std::make_shared<internal::PcmCache>(config.pcmCacheBudget);
+
             m_buffers.reset(new internal::BufferCollection());
             m_buffers->Initialize(config.bufferBatch);
+            m_buffers->QueryFormatSupport();
+            m_buffers->SetWorkerPool(m_workers);
+            m_buffers->SetPcmCache((0 != config.pcmCacheBudget) ? m_pcmCache : nullptr);
+            m_buffers->SetStereoDownmix(config.isStereoDownmixed);
+            m_buffers->SetBudget(config.bufferBudget);
 
             m_sources.reset(new internal::SourceCollection(*m_buffers));
             m_sources->Initialize(config.sourceBatch);
+            m_sources->SetStreamSettings(config.streamBufferCount, config.streamBufferFrames);
+            m_sources->QueryCallbackSupport();
+            m_sources->SetEventDriven(m_context->SetEventHandler(&internal::SourceCollection::HandleEvent, m_sources.get()));
+            m_sources->SetGridCellSize(config.gridCellSize);
+
+            m_voices.reset(new internal::VoiceCollection(*m_sources, *m_listener));
+            m_voices->Initialize(config.sourceBatch);
+            m_voices->SetVoiceLimit(config.voiceLimit);
+
+            m_cullThreshold = config.cullThreshold;
+
+            m_lastUpdate = std::chrono::steady_clock::now();
 
             m_isInitialized = true;
+
+            if (config.isThreaded)
+            {
+                m_commands = std::make_shared<internal::CommandQueue>(config.commandQueueSize);
+                m_threadPeriod = std::chrono::milliseconds(config.threadPeriodMs);
+
+                StartThread();
+            }
         }
     }
 
@@ -87,8 +210,13 @@ bool TulparAudio::Reinitialize(TulparConfigurator const& config)
 
     LOG->Trace("TulparAudio::Reinitialize({}) started", config);
 
+    StopThread();
+
     internal::Device* pDevice = internal::Device::Create(config.device);
 
+    m_pcmCache->SetBudget(config.pcmCacheBudget);
+    m_cullThreshold = config.cullThreshold;
+
     if (nullptr != pDevice)
     {
         // check if device changed
@@ -98,14 +226,30 @@ bool TulparAudio::Reinitialize(TulparConfigurator const& config)
 
             if (nullptr != pContext)
             {
+                // upload pending data and apply deferred changes while old context is still current
+                m_buffers->FinishPendingData();
+
+                if (0 != m_frameDepth)
+                {
+                    m_context->ProcessUpdates();
+                }
+
                 pContext->MakeCurrent();
 
                 std::shared_ptr<internal::BufferCollection> newBuffers = std::make_shared<internal::BufferCollection>();
                 newBuffers->Initialize(config.bufferBatch);
+                newBuffers->QueryFormatSupport();
+                newBuffers->SetWorkerPool(m_workers);
+                newBuffers->SetPcmCache((0 != config.pcmCacheBudget) ? m_pcmCache : nullptr);
+                newBuffers->SetStereoDownmix(config.isStereoDownmixed);
+                newBuffers->SetBudget(config.bufferBudget);
                 internal::BufferCollection::MigrationMapping bufferMapping = newBuffers->InheritCollection(*m_buffers);
 
                 std::shared_ptr<internal::SourceCollection> newSources = std::make_shared<internal::SourceCollection>(*newBuffers);
                 newSources->Initialize(config.sourceBatch);
+                newSources->SetStreamSettings(config.streamBufferCount, config.streamBufferFrames);
+                newSources->QueryCallbackSupport();
+                newSources->SetGridCellSize(config.gridCellSize);
                 newSources->InheritCollection(
                     *m_sources.get()
                     , bufferMapping
@@ -115,14 +259,33 @@ bool TulparAudio::Reinitialize(TulparConfigurator const& config)
 
                 m_context->MakeCurrent();
 
+                // old sources are released along with the old context
+                m_context->SetEventHandler(nullptr, nullptr);
+
+                m_voices->SetSourceCollection(*newSources);
+                m_voices->SetVoiceLimit(config.voiceLimit);
+
                 m_sources = newSources;
                 m_buffers = newBuffers;
 
                 m_context.reset(pContext);
                 m_device.reset(pDevice);
 
+                // time spent on the previous device is not elapsed on the new one
+                m_lastUpdate = std::chrono::steady_clock::now();
+                m_renderedTime = std::chrono::nanoseconds(0);
+
                 pContext->MakeCurrent();
 
+                m_sources->SetEventDriven(m_context->SetEventHandler(&internal::SourceCollection::HandleEvent, m_sources.get()));
+
+                m_listener->ApplyListenerState();
+
+                if (0 != m_frameDepth)
+                {
+                    m_context->DeferUpdates();
+                }
+
                 m_isInitialized = true;
             }
             else
@@ -135,7 +298,13 @@ bool TulparAudio::Reinitialize(TulparConfigurator const& config)
             LOG->Trace("TulparAudio::Reinitialize() device unchanged");
 
             m_buffers->Initialize(config.bufferBatch);
+            m_buffers->SetPcmCache((0 != config.pcmCacheBudget) ? m_pcmCache : nullptr);
+            m_buffers->SetStereoDownmix(config.isStereoDownmixed);
+            m_buffers->SetBudget(config.bufferBudget);
             m_sources->Initialize(config.sourceBatch);
+            m_sources->SetStreamSettings(config.streamBufferCount, config.streamBufferFrames);
+            m_sources->SetGridCellSize(config.gridCellSize);
+            m_voices->SetVoiceLimit(config.voiceLimit);
         }
     }
     else
@@ -143,6 +312,18 @@ bool TulparAudio::Reinitialize(TulparConfigurator const& config)
         LOG->Error("TulparAudio::Reinitialize() failed to initialize new device");
     }
 
+    if (true == m_isInitialized && config.isThreaded)
+    {
+        if (nullptr == m_commands.get() || m_commands->GetCapacity() < config.commandQueueSize)
+        {
+            m_commands = std::make_shared<internal::CommandQueue>(config.commandQueueSize);
+        }
+
+        m_threadPeriod = std::chrono::milliseconds(config.threadPeriodMs);
+
+        StartThread();
+    }
+
     if (false == m_isInitialized)
     {
         LOG->Error("TulparAudio::Reinitialize() failed");
@@ -164,52 +345,987 @@ void TulparAudio::Deinitialize()
     {
         LOG->Trace("TulparAudio::Deinitialize() started");
 
+        StopThread();
+        m_commands.reset();
+
+        if (nullptr != m_context.get())
+        {
+            m_context->SetEventHandler(nullptr, nullptr);
+        }
+
+        m_voices.reset();
         m_sources.reset();
         m_buffers.reset();
+        m_workers.reset();
+        m_pcmCache.reset();
         m_listener.reset();
 
         m_context.reset();
         m_device.reset();
 
+        m_frameDepth = 0;
         m_isInitialized = false;
 
         LOG->Debug("TulparAudio::Deinitialize() done");
     }
 }
 
-audio::Listener TulparAudio::GetListener() const
+void TulparAudio::Update()
 {
     assert(true == m_isInitialized);
 
-    return m_listener->Get();
+    if (m_thread.joinable())
+    {
+        return;
+    }
+
+    UpdateCollections();
 }
 
-audio::Source TulparAudio::GetSource(audio::Source::Handle handle) const
+void TulparAudio::BeginFrame()
 {
     assert(true == m_isInitialized);
 
-    return m_sources->Get(handle);
+    if (IsDeferringCommands())
+    {
+        m_commands->Push(internal::Command::Make(internal::Command::Type::FrameBegin));
+
+        return;
+    }
+
+    if (0 == m_frameDepth++)
+    {
+        m_context->DeferUpdates();
+    }
 }
 
-audio::Source TulparAudio::SpawnSource()
+void TulparAudio::EndFrame()
 {
     assert(true == m_isInitialized);
 
-    return m_sources->Spawn();
+    if (IsDeferringCommands())
+    {
+        m_commands->Push(internal::Command::Make(internal::Command::Type::FrameEnd));
+
+        return;
+    }
+
+    assert(0 != m_frameDepth);
+
+    if (0 == --m_frameDepth)
+    {
+        m_context->ProcessUpdates();
+    }
 }
 
-audio::Buffer TulparAudio::GetBuffer(audio::Buffer::Handle handle) const
+bool TulparAudio::IsDeferringCommands() const
 {
-    assert(true == m_isInitialized);
+    return m_thread.joinable() && m_commands->IsProducerThread();
+}
 
-    return m_buffers->Get(handle);
+bool TulparAudio::ResolveSourceRef(audio::SourceRef reference, char const* action, uint32_t& handle) const
+{
+    // lock is released before commands are pushed, full queue waits for the audio thread
+    internal::ConsumerLock lock = LockThread();
+
+    if (!m_sources->IsValid(reference))
+    {
+        LOG->Warning("TulparAudio: {}: invalid source reference", action);
+
+        return false;
+    }
+
+    handle = m_sources->GetHandle(reference);
+
+    return true;
 }
 
-audio::Buffer TulparAudio::SpawnBuffer()
+bool TulparAudio::ResolveSourceRefs(audio::SourceRef const* pSources
+    , uint32_t count
+    , std::vector<uint32_t>& handles
+) const
 {
-    assert(true == m_isInitialized);
+    // lock is released before commands are pushed, full queue waits for the audio thread
+    internal::ConsumerLock lock = LockThread();
 
-    return m_buffers->Spawn();
+    handles.resize(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!m_sources->IsValid(pSources[i]))
+        {
+            LOG->Warning("TulparAudio: invalid source reference at {} of {}", i, count);
+
+            return false;
+        }
+
+        handles[i] = m_sources->GetHandle(pSources[i]);
+    }
+
+    return true;
+}
+
+internal::ConsumerLock TulparAudio::LockThread() const
+{
+    return internal::ConsumerLock(m_thread.joinable() ? m_commands.get() : nullptr);
+}
+
+void TulparAudio::UpdateCollections()
+{
+    m_context->CheckErrors();
+
+    m_buffers->UploadPendingData();
+
+    // deferred state changes are not visible to queries confirming events
+    if (0 == m_frameDepth)
+    {
+        m_sources->UpdateSourceEvents();
+    }
+
+    m_sources->UpdateSourceStreams();
+
+    std::chrono::nanoseconds const elapsed = ConsumeElapsedTime();
+
+    m_sources->CullSources(m_listener->GetListenerPosition(), m_listener->GetListenerDistanceModel(), m_cullThreshold, elapsed);
+
+    m_voices->UpdateVoices(elapsed);
+}
+
+std::chrono::nanoseconds TulparAudio::ConsumeElapsedTime()
+{
+    std::chrono::nanoseconds result(0);
+
+    if (m_device->IsLoopback())
+    {
+        std::swap(result, m_renderedTime);
+    }
+    else
+    {
+        std::chrono::steady_clock::time_point const now = std::chrono::steady_clock::now();
+
+        result = now - m_lastUpdate;
+        m_lastUpdate = now;
+    }
+
+    return result;
+}
+
+void TulparAudio::StartThread()
+{
+    assert(!m_thread.joinable());
+
+    LOG->Debug("TulparAudio: starting audio thread");
+
+    // audio thread waits until calls are routed to the queue
+    std::lock_guard<std::mutex> lock(m_threadMutex);
+
+    m_isThreadRunning.store(true, std::memory_order_release);
+    m_thread = std::thread(&TulparAudio::RunThread, this);
+
+    m_commands->SetConsumerThread(m_thread.get_id());
+    m_commands->SetConsumerMutex(&m_threadMutex);
+
+    m_buffers->SetCommandQueue(m_commands.get());
+    m_sources->SetCommandQueue(m_commands.get());
+    m_voices->SetCommandQueue(m_commands.get());
+    m_listener->SetCommandQueue(m_commands.get());
+}
+
+void TulparAudio::StopThread()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+
+    LOG->Debug("TulparAudio: stopping audio thread");
+
+    m_isThreadRunning.store(false, std::memory_order_release);
+    m_thread.join();
+
+    m_buffers->SetCommandQueue(nullptr);
+    m_sources->SetCommandQueue(nullptr);
+    m_voices->SetCommandQueue(nullptr);
+    m_listener->SetCommandQueue(nullptr);
+
+    m_commands->SetConsumerMutex(nullptr);
+
+    m_context->MakeCurrent();
+}
+
+void TulparAudio::RunThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+
+        m_context->MakeCurrent();
+    }
+
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_threadMutex);
+
+            // commands pushed before stop request are still applied
+            bool const isRunning = m_isThreadRunning.load(std::memory_order_acquire);
+
+            ProcessCommands();
+
+            if (!isRunning)
+            {
+                break;
+            }
+
+            UpdateCollections();
+        }
+
+        std::this_thread::sleep_for(m_threadPeriod);
+    }
+}
+
+void TulparAudio::ProcessCommands()
+{
+    internal::Command command;
+
+    if (!m_commands->Pop(command))
+    {
+        return;
+    }
+
+    // apply commands at once unless user frame is already open
+    if (0 == m_frameDepth)
+    {
+        m_context->DeferUpdates();
+    }
+
+    // bound by capacity so that busy producers can't stall the audio thread
+    uint32_t count = 0;
+
+    do
+    {
+        ApplyCommand(command);
+    }
+    while ((++count < m_commands->GetCapacity()) && m_commands->Pop(command));
+
+    if (0 == m_frameDepth)
+    {
+        m_context->ProcessUpdates();
+    }
+}
+
+void TulparAudio::ApplyCommand(internal::Command const& command)
+{
+    using Type = internal::Command::Type;
+
+    uint32_t const handle = command.handle;
+    internal::Command::Payload const& payload = command.payload;
+
+    switch (command.type)
+    {
+        case Type::ListenerGain:
+        case Type::ListenerPosition:
+        case Type::ListenerOrientation:
+        case Type::ListenerDistanceModel:
+        case Type::SourcesPlay:
+        case Type::SourcesStop:
+        case Type::SourcesRewind:
+        case Type::SourcesPause:
+        case Type::FrameBegin:
+        case Type::FrameEnd:
+        {
+            break;
+        }
+        case Type::BufferReset:
+        {
+            if (!m_buffers->IsValid(handle, command.generation))
+            {
+                LOG->Warning("TulparAudio: dropping command {} for buffer #{}", static_cast<uint32_t>(command.type), handle);
+
+                return;
+            }
+
+            break;
+        }
+        case Type::VoiceReset:
+        case Type::VoiceBuffer:
+        case Type::VoicePlay:
+        case Type::VoiceStop:
+        case Type::VoiceRewind:
+        case Type::VoicePause:
+        case Type::VoicePlaybackPosition:
+        case Type::VoicePriority:
+        case Type::VoiceRelative:
+        case Type::VoiceLooping:
+        case Type::VoicePitch:
+        case Type::VoiceGain:
+        case Type::VoicePosition:
+        {
+            if (!m_voices->IsValid(handle, command.generation))
+            {
+                LOG->Warning("TulparAudio: dropping command {} for voice #{}", static_cast<uint32_t>(command.type), handle);
+
+                return;
+            }
+
+            break;
+        }
+        default:
+        {
+            if (!m_sources->IsValid(handle, command.generation))
+            {
+                LOG->Warning("TulparAudio: dropping command {} for source #{}", static_cast<uint32_t>(command.type), handle);
+
+                if (Type::SourceQueueBuffers == command.type
+                    || Type::SourceStream == command.type
+                    || Type::SourceCallback == command.type
+                )
+                {
+                    m_sources->DiscardSourceBind(payload.handle);
+                }
+
+                return;
+            }
+
+            break;
+        }
+    }
+
+    std::array<float, 3> const vec{{ payload.vector[0], payload.vector[1], payload.vector[2] }};
+
+    switch (command.type)
+    {
+        case Type::SourceReset:
+        {
+            m_sources->ResetSource(handle);
+            break;
+        }
+        case Type::SourcePlay:
+        {
+            m_sources->PlaySource(handle);
+            break;
+        }
+        case Type::SourceStop:
+        {
+            m_sources->StopSource(handle);
+            break;
+        }
+        case Type::SourceRewind:
+        {
+            m_sources->RewindSource(handle);
+            break;
+        }
+        case Type::SourcePause:
+        {
+            m_sources->PauseSource(handle);
+            break;
+        }
+        case Type::SourcesPlay:
+        case Type::SourcesStop:
+        case Type::SourcesRewind:
+        case Type::SourcesPause:
+        {
+            m_sources->ApplySourceBatch(command.type, payload.handle);
+            break;
+        }
+        case Type::SourceStaticBuffer:
+        {
+            m_sources->SetSourceStaticBuffer(handle, payload.handle);
+            break;
+        }
+        case Type::SourceQueueBuffers:
+        case Type::SourceStream:
+        case Type::SourceCallback:
+        {
+            m_sources->ApplySourceBind(handle, payload.handle);
+            break;
+        }
+        case Type::SourcePlaybackPosition:
+        {
+            m_sources->SetSourcePlaybackPosition(handle, std::chrono::nanoseconds(payload.nanoseconds));
+            break;
+        }
+        case Type::SourcePlaybackProgress:
+        {
+            m_sources->SetSourcePlaybackProgress(handle, payload.scalar);
+            break;
+        }
+        case Type::SourceRelative:
+        {
+            m_sources->SetSourceRelative(handle, payload.flag);
+            break;
+        }
+        case Type::SourceLooping:
+        {
+            m_sources->SetSourceLooping(handle, payload.flag);
+            break;
+        }
+        case Type::SourcePitch:
+        {
+            m_sources->SetSourcePitch(handle, payload.scalar);
+            break;
+        }
+        case Type::SourceGain:
+        {
+            m_sources->SetSourceGain(handle, payload.scalar);
+            break;
+        }
+        case Type::SourcePosition:
+        {
+            m_sources->SetSourcePosition(handle, vec);
+            break;
+        }
+        case Type::SourceVelocity:
+        {
+            m_sources->SetSourceVelocity(handle, vec);
+            break;
+        }
+        case Type::SourceReferenceDistance:
+        {
+            m_sources->SetSourceReferenceDistance(handle, payload.scalar);
+            break;
+        }
+        case Type::SourceMaxDistance:
+        {
+            m_sources->SetSourceMaxDistance(handle, payload.scalar);
+            break;
+        }
+        case Type::SourceRolloffFactor:
+        {
+            m_sources->SetSourceRolloffFactor(handle, payload.scalar);
+            break;
+        }
+        case Type::ListenerGain:
+        {
+            m_listener->SetListenerGain(payload.scalar);
+            break;
+        }
+        case Type::ListenerPosition:
+        {
+            m_listener->SetListenerPosition(vec);
+            break;
+        }
+        case Type::ListenerOrientation:
+        {
+            audio::Listener::Orientation const orientation{
+                vec
+                , {{ payload.vector[3], payload.vector[4], payload.vector[5] }}
+            };
+
+            m_listener->SetListenerOrientation(orientation);
+            break;
+        }
+        case Type::ListenerDistanceModel:
+        {
+            m_listener->SetListenerDistanceModel(static_cast<audio::Listener::DistanceModel>(payload.integer));
+            break;
+        }
+        case Type::BufferReset:
+        {
+            m_buffers->ResetBuffer(handle);
+            break;
+        }
+        case Type::VoiceReset:
+        {
+            m_voices->ResetVoice(handle);
+            break;
+        }
+        case Type::VoiceBuffer:
+        {
+            m_voices->SetVoiceBuffer(handle
+                , m_buffers->IsValid(payload.handle) ? m_buffers->Get(payload.handle) : audio::Buffer()
+            );
+            break;
+        }
+        case Type::VoicePlay:
+        {
+            m_voices->PlayVoice(handle);
+            break;
+        }
+        case Type::VoiceStop:
+        {
+            m_voices->StopVoice(handle);
+            break;
+        }
+        case Type::VoiceRewind:
+        {
+            m_voices->RewindVoice(handle);
+            break;
+        }
+        case Type::VoicePause:
+        {
+            m_voices->PauseVoice(handle);
+            break;
+        }
+        case Type::VoicePlaybackPosition:
+        {
+            m_voices->SetVoicePlaybackPosition(handle, std::chrono::nanoseconds(payload.nanoseconds));
+            break;
+        }
+        case Type::VoicePriority:
+        {
+            m_voices->SetVoicePriority(handle, payload.integer);
+            break;
+        }
+        case Type::VoiceRelative:
+        {
+            m_voices->SetVoiceRelative(handle, payload.flag);
+            break;
+        }
+        case Type::VoiceLooping:
+        {
+            m_voices->SetVoiceLooping(handle, payload.flag);
+            break;
+        }
+        case Type::VoicePitch:
+        {
+            m_voices->SetVoicePitch(handle, payload.scalar);
+            break;
+        }
+        case Type::VoiceGain:
+        {
+            m_voices->SetVoiceGain(handle, payload.scalar);
+            break;
+        }
+        case Type::VoicePosition:
+        {
+            m_voices->SetVoicePosition(handle, vec);
+            break;
+        }
+        case Type::FrameBegin:
+        {
+            BeginFrame();
+            break;
+        }
+        case Type::FrameEnd:
+        {
+            EndFrame();
+            break;
+        }
+    }
+}
+
+bool TulparAudio::RenderSamples(int16_t* pSamples, uint32_t frameCount)
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    if (!m_device->RenderSamples(pSamples, frameCount))
+    {
+        return false;
+    }
+
+    m_renderedTime += std::chrono::nanoseconds(
+        (static_cast<uint64_t>(frameCount) * 1000000000ULL) / m_device->GetFrequencyHz()
+    );
+
+    return true;
+}
+
+bool TulparAudio::RenderToFile(std::string const& path, std::chrono::nanoseconds duration)
+{
+    assert(true == m_isInitialized);
+
+    if (!m_device->IsLoopback())
+    {
+        LOG->Warning("TulparAudio::RenderToFile({}) requires loopback device", path.c_str());
+
+        return false;
+    }
+
+    uint32_t const channelCount = m_device->GetChannelCount();
+    uint32_t const frequencyHz = m_device->GetFrequencyHz();
+    uint32_t const frameCount = static_cast<uint32_t>((duration.count() * frequencyHz) / 1000000000LL);
+
+    std::ofstream file(path, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        LOG->Warning("TulparAudio::RenderToFile({}) failed to open file", path.c_str());
+
+        return false;
+    }
+
+    WriteWavHeader(file, frequencyHz, channelCount, frameCount);
+
+    std::vector<int16_t> samples(s_renderChunkFrames * channelCount);
+
+    for (uint32_t frame = 0; frame < frameCount; frame += s_renderChunkFrames)
+    {
+        uint32_t const chunkFrames = std::min(s_renderChunkFrames, frameCount - frame);
+
+        if (!RenderSamples(samples.data(), chunkFrames))
+        {
+            return false;
+        }
+
+        WriteSamples(file, samples.data(), chunkFrames * channelCount);
+
+        Update();
+    }
+
+    LOG->Debug("TulparAudio::RenderToFile({}) rendered {} frames", path.c_str(), frameCount);
+
+    return file.good();
+}
+
+audio::Listener TulparAudio::GetListener() const
+{
+    assert(true == m_isInitialized);
+
+    return m_listener->Get();
+}
+
+audio::Source TulparAudio::GetSource(audio::Source::Handle handle) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->Get(handle);
+}
+
+audio::Source TulparAudio::SpawnSource()
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->Spawn();
+}
+
+audio::SourceRef TulparAudio::GetSourceRef(audio::Source const& source) const
+{
+    assert(true == m_isInitialized);
+    assert(source.IsValid());
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->GetReference(*source.GetSharedHandle());
+}
+
+bool TulparAudio::IsValid(audio::SourceRef reference) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->IsValid(reference);
+}
+
+audio::Source TulparAudio::GetSource(audio::SourceRef reference) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->Resolve(reference);
+}
+
+bool TulparAudio::PlaySource(audio::SourceRef reference)
+{
+    assert(true == m_isInitialized);
+
+    uint32_t handle;
+
+    if (!ResolveSourceRef(reference, "play", handle))
+    {
+        return false;
+    }
+
+    return m_sources->PlaySource(handle);
+}
+
+bool TulparAudio::StopSource(audio::SourceRef reference)
+{
+    assert(true == m_isInitialized);
+
+    uint32_t handle;
+
+    if (!ResolveSourceRef(reference, "stop", handle))
+    {
+        return false;
+    }
+
+    return m_sources->StopSource(handle);
+}
+
+audio::Source::State TulparAudio::GetSourceState(audio::SourceRef reference) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->GetSourceState(m_sources->GetHandle(reference));
+}
+
+float TulparAudio::GetSourceGain(audio::SourceRef reference) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->GetSourceGain(m_sources->GetHandle(reference));
+}
+
+bool TulparAudio::SetSourceGain(audio::SourceRef reference, float value)
+{
+    assert(true == m_isInitialized);
+
+    uint32_t handle;
+
+    if (!ResolveSourceRef(reference, "set gain", handle))
+    {
+        return false;
+    }
+
+    return m_sources->SetSourceGain(handle, value);
+}
+
+std::array<float, 3> TulparAudio::GetSourcePosition(audio::SourceRef reference) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->GetSourcePosition(m_sources->GetHandle(reference));
+}
+
+bool TulparAudio::SetSourcePosition(audio::SourceRef reference, std::array<float, 3> vec)
+{
+    assert(true == m_isInitialized);
+
+    uint32_t handle;
+
+    if (!ResolveSourceRef(reference, "set position", handle))
+    {
+        return false;
+    }
+
+    return m_sources->SetSourcePosition(handle, vec);
+}
+
+std::vector<audio::SourceEvent> TulparAudio::PollSourceEvents()
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_sources->ConsumeSourceEvents();
+}
+
+bool TulparAudio::PlaySources(std::vector<audio::Source> const& sources)
+{
+    assert(true == m_isInitialized);
+
+    return m_sources->PlaySources(GetSourceHandles(sources));
+}
+
+bool TulparAudio::StopSources(std::vector<audio::Source> const& sources)
+{
+    assert(true == m_isInitialized);
+
+    return m_sources->StopSources(GetSourceHandles(sources));
+}
+
+bool TulparAudio::RewindSources(std::vector<audio::Source> const& sources)
+{
+    assert(true == m_isInitialized);
+
+    return m_sources->RewindSources(GetSourceHandles(sources));
+}
+
+bool TulparAudio::PauseSources(std::vector<audio::Source> const& sources)
+{
+    assert(true == m_isInitialized);
+
+    return m_sources->PauseSources(GetSourceHandles(sources));
+}
+
+bool TulparAudio::SetSourcesPosition(audio::SourceRef const* pSources
+    , uint32_t count
+    , float const* pX
+    , float const* pY
+    , float const* pZ
+)
+{
+    assert(true == m_isInitialized);
+
+    internal::SourceCollection::Handles handles;
+
+    if (!ResolveSourceRefs(pSources, count, handles))
+    {
+        return false;
+    }
+
+    UpdateBatch batch(*this);
+
+    return m_sources->SetSourcesPosition(handles.data(), count, pX, pY, pZ);
+}
+
+bool TulparAudio::SetSourcesVelocity(audio::SourceRef const* pSources
+    , uint32_t count
+    , float const* pX
+    , float const* pY
+    , float const* pZ
+)
+{
+    assert(true == m_isInitialized);
+
+    internal::SourceCollection::Handles handles;
+
+    if (!ResolveSourceRefs(pSources, count, handles))
+    {
+        return false;
+    }
+
+    UpdateBatch batch(*this);
+
+    return m_sources->SetSourcesVelocity(handles.data(), count, pX, pY, pZ);
+}
+
+std::vector<audio::SourceRef> TulparAudio::GetSourcesInRadius(std::array<float, 3> const& center, float radius) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    internal::SourceCollection::Handles handles;
+    m_sources->GetSourcesInRadius(center, radius, handles);
+
+    std::vector<audio::SourceRef> result;
+    result.reserve(handles.size());
+
+    for (audio::Source::Handle handle : handles)
+    {
+        result.push_back(m_sources->GetReference(handle));
+    }
+
+    return result;
+}
+
+bool TulparAudio::ComputeAudibility(audio::SourceRef const* pSources, uint32_t count, float* pResult) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!m_sources->IsValid(pSources[i]))
+        {
+            LOG->Warning("TulparAudio: invalid source reference at {} of {}", i, count);
+
+            return false;
+        }
+    }
+
+    m_sources->ComputeAudibility(m_listener->GetListenerPosition()
+        , m_listener->GetListenerDistanceModel()
+        , pSources
+        , count
+        , pResult
+    );
+
+    return true;
+}
+
+audio::Voice TulparAudio::GetVoice(audio::Voice::Handle handle) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_voices->Get(handle);
+}
+
+audio::Voice TulparAudio::SpawnVoice()
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_voices->Spawn();
+}
+
+audio::Buffer TulparAudio::GetBuffer(audio::Buffer::Handle handle) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_buffers->Get(handle);
+}
+
+audio::Buffer TulparAudio::SpawnBuffer()
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_buffers->Spawn();
+}
+
+audio::BufferRef TulparAudio::GetBufferRef(audio::Buffer const& buffer) const
+{
+    assert(true == m_isInitialized);
+    assert(buffer.IsValid());
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_buffers->GetReference(*buffer.GetSharedHandle());
+}
+
+uint64_t TulparAudio::GetResidentBufferSize() const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_buffers->GetResidentSize();
+}
+
+bool TulparAudio::IsValid(audio::BufferRef reference) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_buffers->IsValid(reference);
+}
+
+audio::Buffer TulparAudio::GetBuffer(audio::BufferRef reference) const
+{
+    assert(true == m_isInitialized);
+
+    internal::ConsumerLock lock = LockThread();
+
+    return m_buffers->Resolve(reference);
+}
+
+std::future<bool> TulparAudio::BindBuffersDataAsync(
+    std::vector<audio::Buffer> const& buffers
+    , std::vector<mule::asset::Handler> const& assets
+    , audio::Buffer::Downmix downmix
+)
+{
+    assert(true == m_isInitialized);
+
+    assert(buffers.size() == assets.size());
+
+    internal::ConsumerLock lock = LockThread();
+
+    internal::BufferCollection::Handles handles;
+    handles.reserve(buffers.size());
+
+    for (audio::Buffer const& buffer : buffers)
+    {
+        assert(buffer.IsValid());
+
+        handles.push_back(*buffer.GetSharedHandle());
+    }
+
+    return m_buffers->SetBuffersDataAsync(handles, assets, downmix);
 }
 
 }
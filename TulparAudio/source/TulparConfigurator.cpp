@@ -16,6 +16,18 @@ namespace tulpar
 TulparConfigurator::TulparConfigurator()
     : bufferBatch(32)
     , sourceBatch(32)
+    , streamBufferCount(4)
+    , streamBufferFrames(8192)
+    , decoderThreads(0)
+    , pcmCacheBudget(0)
+    , bufferBudget(0)
+    , isStereoDownmixed(false)
+    , voiceLimit(64)
+    , cullThreshold(0.0f)
+    , gridCellSize(32.0f)
+    , isThreaded(false)
+    , commandQueueSize(4096)
+    , threadPeriodMs(5)
     , device()
 {
 
@@ -60,9 +72,24 @@ std::ostream& operator<<(std::ostream& os, TulparConfigurator const& config)
     return os << "TulparConfigurator { "
         << "bufferBatch: " << config.bufferBatch
         << ", sourceBatch: " << config.sourceBatch
+        << ", streamBufferCount: " << config.streamBufferCount
+        << ", streamBufferFrames: " << config.streamBufferFrames
+        << ", decoderThreads: " << config.decoderThreads
+        << ", pcmCacheBudget: " << config.pcmCacheBudget
+        << ", bufferBudget: " << config.bufferBudget
+        << ", isStereoDownmixed: " << (config.isStereoDownmixed ? "true" : "false")
+        << ", voiceLimit: " << config.voiceLimit
+        << ", cullThreshold: " << config.cullThreshold
+        << ", gridCellSize: " << config.gridCellSize
+        << ", isThreaded: " << (config.isThreaded ? "true" : "false")
+        << ", commandQueueSize: " << config.commandQueueSize
+        << ", threadPeriodMs: " << config.threadPeriodMs
         << ", device: { "
         << " name: \"" << config.device.name.c_str() << "\""
         << ", default: " << (config.device.isDefault ? "true" : "false")
+        << ", loopback: " << (config.device.isLoopback ? "true" : "false")
+        << ", loopbackFrequencyHz: " << config.device.loopbackFrequencyHz
+        << ", loopbackChannelCount: " << static_cast<uint32_t>(config.device.loopbackChannelCount)
         << " } }";
 }
 
@@ -26,6 +26,7 @@
 
 #include <spdlog/sinks/ansicolor_sink.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <iostream>
@@ -271,6 +272,69 @@ void SeekPlayback(tulpar::TulparAudio& audio, tulpar::audio::Buffer& buffer)
     source.Reset();
 }
 
+void StreamPlayback(tulpar::TulparAudio& audio, mule::asset::Handler& handler)
+{
+    using namespace std::chrono_literals;
+
+    tulpar::audio::Source source = audio.SpawnSource();
+
+    source.SetLooping(false);
+    source.BindStream(handler);
+
+    source.Play();
+
+    // completion is detected by Update(), no need to query OpenAL every iteration
+    while (tulpar::audio::Source::State::Stopped != source.GetCachedState())
+    {
+        audio.Update();
+
+        print(source);
+
+        std::this_thread::sleep_for(20ms);
+    }
+
+    source.Reset();
+}
+
+void ProceduralPlayback(tulpar::TulparAudio& audio)
+{
+    using namespace std::chrono_literals;
+
+    constexpr uint32_t frequencyHz = 44100;
+    constexpr uint32_t toneFrames = frequencyHz;
+
+    tulpar::audio::Source source = audio.SpawnSource();
+
+    // one second of 440Hz tone, callback owns its state as it may run on the mixing thread
+    source.BindCallback(
+        [frame = uint32_t(0)](void* pSamples, uint32_t frameCount) mutable -> uint32_t
+        {
+            int16_t* pOut = static_cast<int16_t*>(pSamples);
+            uint32_t const count = std::min(frameCount, toneFrames - frame);
+
+            for (uint32_t i = 0; i < count; ++i, ++frame)
+            {
+                pOut[i] = static_cast<int16_t>(8192.0 * std::sin(g_tau * 440.0 * frame / frequencyHz));
+            }
+
+            return count;
+        }
+        , 1
+        , frequencyHz
+    );
+
+    source.Play();
+
+    while (tulpar::audio::Source::State::Stopped != source.GetCachedState())
+    {
+        audio.Update();
+
+        std::this_thread::sleep_for(20ms);
+    }
+
+    source.Reset();
+}
+
 void MovingListener(tulpar::TulparAudio& audio, tulpar::audio::Buffer& buffer)
 {
     using namespace std::chrono_literals;
@@ -499,6 +563,8 @@ int main()
             StopPlayback(audio, buffer);
             MovingSource(audio, buffer);
             SeekPlayback(audio, buffer);
+            StreamPlayback(audio, handler);
+            ProceduralPlayback(audio);
             MovingListener(audio, buffer);
             RotatingListener(audio, buffer);
             SwitchingDevice(audio, buffer);
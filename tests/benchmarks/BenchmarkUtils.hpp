@@ -0,0 +1,135 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_TESTS_BENCHMARKS_BENCHMARK_UTILS_HPP
+#define TULPAR_TESTS_BENCHMARKS_BENCHMARK_UTILS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tulpar
+{
+namespace tests
+{
+namespace benchmarks
+{
+
+//! Measurement of a single benchmark
+struct Result
+{
+    //! Benchmark name
+    std::string name;
+
+    //! Number of measured iterations
+    uint64_t iterations;
+
+    //! Wall clock time per iteration in nanoseconds
+    double realTime;
+
+    //! Processor time per iteration in nanoseconds
+    double cpuTime;
+
+    //! Additional named values, e.g. bytes_per_second
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+/** @brief  Measures given benchmark body
+ *
+ *  @param  name        benchmark name
+ *  @param  iterations  number of iterations passed to @p body
+ *  @param  body        functor executing given number of iterations
+ *
+ *  @return measurement result
+ */
+template<typename Body>
+    Result Measure(std::string const& name, uint64_t iterations, Body body)
+{
+    std::clock_t const cpuStart = std::clock();
+    std::chrono::steady_clock::time_point const realStart = std::chrono::steady_clock::now();
+
+    body(iterations);
+
+    std::chrono::steady_clock::time_point const realEnd = std::chrono::steady_clock::now();
+    std::clock_t const cpuEnd = std::clock();
+
+    double const realTotal = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(realEnd - realStart).count());
+    double const cpuTotal = 1e9 * static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+
+    std::cerr << name << "\t" << iterations << "\t" << (realTotal / iterations) << "ns" << std::endl;
+
+    return Result{ name, iterations, realTotal / iterations, cpuTotal / iterations, {} };
+}
+
+//! Writes string escaped for JSON
+inline void WriteJsonString(std::ostream& os, std::string const& value)
+{
+    os << '"';
+
+    for (char c : value)
+    {
+        if ('"' == c || '\\' == c)
+        {
+            os << '\\';
+        }
+
+        os << c;
+    }
+
+    os << '"';
+}
+
+/** @brief  Writes results in Google Benchmark JSON format
+ *
+ *  @param  os      output stream
+ *  @param  results benchmark results
+ */
+inline void WriteJson(std::ostream& os, std::vector<Result> const& results)
+{
+    os << "{\n"
+        << "  \"context\": {\n"
+        << "    \"library\": \"Tulpar\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+        << "  },\n"
+        << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        Result const& result = results[i];
+
+        os << ((0 == i) ? "\n" : ",\n")
+            << "    {\n"
+            << "      \"name\": ";
+        WriteJsonString(os, result.name);
+        os << ",\n"
+            << "      \"iterations\": " << result.iterations << ",\n"
+            << "      \"real_time\": " << result.realTime << ",\n"
+            << "      \"cpu_time\": " << result.cpuTime << ",\n"
+            << "      \"time_unit\": \"ns\"";
+
+        for (auto const& counter : result.counters)
+        {
+            os << ",\n      ";
+            WriteJsonString(os, counter.first);
+            os << ": " << counter.second;
+        }
+
+        os << "\n    }";
+    }
+
+    os << "\n  ]\n}\n";
+}
+
+}
+}
+}
+
+#endif // TULPAR_TESTS_BENCHMARKS_BENCHMARK_UTILS_HPP
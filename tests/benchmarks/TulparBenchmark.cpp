@@ -0,0 +1,415 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#ifndef TULPAR_BENCHMARK_DATA_DIR
+#define TULPAR_BENCHMARK_DATA_DIR
+#endif
+
+#include "BenchmarkUtils.hpp"
+#include "../internal/CollectionTestUtils.hpp"
+
+#include <tulpar/Kernels.hpp>
+#include <tulpar/TulparAudio.hpp>
+#include <tulpar/TulparConfigurator.hpp>
+
+#include <tulpar/internal/BufferCollection.hpp>
+
+#include <tulpar/Loggers.hpp>
+
+#include <mule/MuleUtilities.hpp>
+#include <mule/asset/Storage.hpp>
+#include <mule/Loggers.hpp>
+
+#include <spdlog/sinks/ansicolor_sink.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using tulpar::tests::benchmarks::Measure;
+using tulpar::tests::benchmarks::Result;
+
+static std::string const s_testFile(TULPAR_BENCHMARK_DATA_DIR"ding_02.ogg");
+
+//! Number of operations measured for every collection size
+constexpr uint64_t s_collectionOperations = 100000;
+
+//! Number of calls measured for every source setter
+constexpr uint64_t s_setterCalls = 100000;
+
+//! Number of decoded assets
+constexpr uint64_t s_decodeCount = 20;
+
+//! Number of samples processed by a single kernel call
+constexpr uint64_t s_kernelSamples = 1 << 16;
+
+//! Number of measured kernel calls
+constexpr uint64_t s_kernelCalls = 200;
+
+void SetupLoggers()
+{
+    auto ansiSink = std::make_shared<spdlog::sinks::ansicolor_stderr_sink_mt>();
+    ansiSink->set_level(mule::LogLevel::warn);
+
+    mule::Loggers::Instance().SetDefaultSettings(
+        mule::Loggers::Settings{
+            std::string()
+            , std::string("%+")
+            , mule::LogLevel::warn
+            , { ansiSink }
+        }
+    );
+
+    mule::MuleUtilities::Initialize();
+
+    tulpar::Loggers::Instance().SetDefaultSettings(
+        mule::Loggers::Settings{
+            std::string()
+            , std::string("%+")
+            , mule::LogLevel::warn
+            , { ansiSink }
+        }
+    );
+
+    tulpar::Loggers::Instance().Reinitialize();
+}
+
+//! Measures Spawn, Get and Reclaim of a collection holding @p size objects
+void BenchmarkCollection(uint32_t size, std::vector<Result>& results)
+{
+    using T = tulpar::audio::Buffer;
+
+    uint64_t const rounds = std::max<uint64_t>(1, s_collectionOperations / size);
+    std::string const suffix = "/" + std::to_string(size);
+
+    std::vector<std::unique_ptr<tulpar::internal::BufferCollection>> collections;
+    std::vector<std::vector<T>> objects(rounds);
+
+    for (uint64_t i = 0; i < rounds; ++i)
+    {
+        collections.emplace_back(new tulpar::internal::BufferCollection(
+            tulpar::tests::internal::IncrementGenerator<T>
+            , tulpar::tests::internal::DummyReclaimer<T>
+            , tulpar::tests::internal::DummyDeleter<T>
+        ));
+
+        // generate all handles up front so only Spawn is measured
+        tulpar::tests::internal::s_incrementIndex = 0;
+        collections.back()->Initialize(size);
+        objects[i].reserve(size);
+    }
+
+    results.push_back(Measure("Collection/Spawn" + suffix, rounds * size, [&](uint64_t)
+    {
+        for (uint64_t i = 0; i < rounds; ++i)
+        {
+            for (uint32_t j = 0; j < size; ++j)
+            {
+                objects[i].push_back(collections[i]->Spawn());
+            }
+        }
+    }));
+
+    uint32_t validCount = 0;
+
+    results.push_back(Measure("Collection/Get" + suffix, rounds * size, [&](uint64_t)
+    {
+        for (uint64_t i = 0; i < rounds; ++i)
+        {
+            for (T const& object : objects[i])
+            {
+                validCount += collections[i]->Get(*object.GetSharedHandle()).IsValid() ? 1 : 0;
+            }
+        }
+    }));
+
+    results.back().counters.emplace_back("valid", static_cast<double>(validCount));
+
+    results.push_back(Measure("Collection/Reclaim" + suffix, rounds * size, [&](uint64_t)
+    {
+        for (uint64_t i = 0; i < rounds; ++i)
+        {
+            // reclaim from the front to exercise the swap-and-pop path on every call
+            for (uint32_t j = 0; j < size; ++j)
+            {
+                objects[i][j].Reset();
+            }
+        }
+    }));
+}
+
+//! Measures synchronous Vorbis decoding and upload
+void BenchmarkDecode(tulpar::TulparAudio& audio, std::vector<Result>& results)
+{
+    mule::asset::Handler asset = mule::asset::Storage::Instance().Get(s_testFile);
+
+    std::vector<tulpar::audio::Buffer> buffers;
+
+    for (uint64_t i = 0; i < s_decodeCount; ++i)
+    {
+        buffers.push_back(audio.SpawnBuffer());
+    }
+
+    bool isBound = true;
+
+    results.push_back(Measure("BufferCollection/SetBufferData", s_decodeCount, [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            isBound = buffers[i].BindData(asset) && isBound;
+        }
+    }));
+
+    Result& result = results.back();
+
+    double const seconds = result.realTime * 1e-9;
+    double const encodedBytes = static_cast<double>(asset.GetContent().GetSize());
+    double const decodedBytes = static_cast<double>(buffers.front().GetSampleCount()) * sizeof(int16_t);
+
+    result.counters.emplace_back("bytes_per_second", encodedBytes / seconds);
+    result.counters.emplace_back("decoded_MB_per_second", decodedBytes / seconds / (1024.0 * 1024.0));
+    result.counters.emplace_back("success", isBound ? 1.0 : 0.0);
+
+    for (tulpar::audio::Buffer& buffer : buffers)
+    {
+        buffer.Reset();
+    }
+}
+
+//! Measures conversion kernels per sample for every supported instruction set
+void BenchmarkKernels(std::vector<Result>& results)
+{
+    using tulpar::kernels::InstructionSet;
+
+    std::pair<InstructionSet, std::string> const sets[] = {
+        { InstructionSet::Scalar, "Scalar" }
+        , { InstructionSet::Sse2, "Sse2" }
+        , { InstructionSet::Avx2, "Avx2" }
+        , { InstructionSet::Neon, "Neon" }
+    };
+
+    InstructionSet const defaultSet = tulpar::kernels::GetInstructionSet();
+
+    std::vector<int16_t> shorts(s_kernelSamples);
+    std::vector<float> floats(s_kernelSamples);
+    std::vector<float> left(s_kernelSamples / 2);
+    std::vector<float> right(s_kernelSamples / 2);
+
+    for (uint64_t i = 0; i < s_kernelSamples; ++i)
+    {
+        shorts[i] = static_cast<int16_t>((i * 7919) & 0xFFFF);
+        floats[i] = static_cast<float>(shorts[i]) / 32767.0f;
+    }
+
+    uint64_t const iterations = s_kernelCalls * s_kernelSamples;
+
+    for (auto const& set : sets)
+    {
+        if (!tulpar::kernels::SetInstructionSet(set.first))
+        {
+            continue;
+        }
+
+        std::string const suffix = "/" + set.second;
+
+        results.push_back(Measure("Kernels/ConvertInt16ToFloat" + suffix, iterations, [&](uint64_t)
+        {
+            for (uint64_t i = 0; i < s_kernelCalls; ++i)
+            {
+                tulpar::kernels::ConvertInt16ToFloat(shorts.data(), floats.data(), s_kernelSamples);
+            }
+        }));
+
+        results.push_back(Measure("Kernels/ConvertFloatToInt16" + suffix, iterations, [&](uint64_t)
+        {
+            for (uint64_t i = 0; i < s_kernelCalls; ++i)
+            {
+                tulpar::kernels::ConvertFloatToInt16(floats.data(), shorts.data(), s_kernelSamples);
+            }
+        }));
+
+        results.push_back(Measure("Kernels/DownmixStereoToMono" + suffix, iterations, [&](uint64_t)
+        {
+            for (uint64_t i = 0; i < s_kernelCalls; ++i)
+            {
+                tulpar::kernels::DownmixStereoToMono(floats.data(), left.data(), s_kernelSamples / 2);
+            }
+        }));
+
+        results.push_back(Measure("Kernels/ScaleGain" + suffix, iterations, [&](uint64_t)
+        {
+            for (uint64_t i = 0; i < s_kernelCalls; ++i)
+            {
+                tulpar::kernels::ScaleGain(floats.data(), s_kernelSamples, 1.0f);
+            }
+        }));
+
+        results.push_back(Measure("Kernels/Deinterleave" + suffix, iterations, [&](uint64_t)
+        {
+            float* const planes[] = { left.data(), right.data() };
+
+            for (uint64_t i = 0; i < s_kernelCalls; ++i)
+            {
+                tulpar::kernels::Deinterleave(floats.data(), 2, s_kernelSamples / 2, planes);
+            }
+        }));
+    }
+
+    tulpar::kernels::SetInstructionSet(defaultSet);
+}
+
+//! Measures per-call overhead of source setters
+void BenchmarkSourceSetters(tulpar::TulparAudio& audio, std::vector<Result>& results)
+{
+    tulpar::audio::Source source = audio.SpawnSource();
+
+    results.push_back(Measure("Source/SetGain", s_setterCalls, [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            source.SetGain(static_cast<float>(i & 1));
+        }
+    }));
+
+    results.push_back(Measure("Source/SetPitch", s_setterCalls, [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            source.SetPitch(1.0f + static_cast<float>(i & 1));
+        }
+    }));
+
+    results.push_back(Measure("Source/SetPosition", s_setterCalls, [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            source.SetPosition({{ static_cast<float>(i & 7), 0.0f, 0.0f }});
+        }
+    }));
+
+    results.push_back(Measure("Source/SetLooping", s_setterCalls, [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            source.SetLooping(0 != (i & 1));
+        }
+    }));
+
+    source.Reset();
+}
+
+//! Measures migration of @p count sources and buffers to a new device
+void BenchmarkReinitialize(tulpar::TulparAudio& audio
+    , tulpar::TulparConfigurator const& config
+    , uint32_t count
+    , std::vector<Result>& results
+)
+{
+    std::vector<tulpar::audio::Buffer> buffers;
+    std::vector<tulpar::audio::Source> sources;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        buffers.push_back(audio.SpawnBuffer());
+        sources.push_back(audio.SpawnSource());
+    }
+
+    bool isReinitialized = true;
+
+    // loopback device is opened anew so all objects are migrated
+    results.push_back(Measure("TulparAudio/Reinitialize/" + std::to_string(count), 1, [&](uint64_t)
+    {
+        isReinitialized = audio.Reinitialize(config);
+    }));
+
+    results.back().counters.emplace_back("objects", 2.0 * count);
+    results.back().counters.emplace_back("success", isReinitialized ? 1.0 : 0.0);
+
+    if (isReinitialized)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            sources[i].Reset();
+            buffers[i].Reset();
+        }
+    }
+}
+
+}
+
+/** @brief  Runs Tulpar benchmarks
+ *
+ *  Results are written in Google Benchmark JSON format to standard output
+ *  or to the file given with --benchmark_out=<path>
+ */
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const argument(argv[i]);
+        std::string const option("--benchmark_out=");
+
+        if (0 == argument.compare(0, option.size(), option))
+        {
+            outputPath = argument.substr(option.size());
+        }
+    }
+
+    SetupLoggers();
+
+    std::vector<Result> results;
+
+    for (uint32_t size : { 10u, 1000u, 100000u })
+    {
+        BenchmarkCollection(size, results);
+    }
+
+    BenchmarkKernels(results);
+
+    tulpar::TulparConfigurator config;
+    config.device = tulpar::TulparConfigurator::Device::Loopback();
+
+    tulpar::TulparAudio audio;
+
+    if (audio.Initialize(config))
+    {
+        BenchmarkDecode(audio, results);
+        BenchmarkSourceSetters(audio, results);
+
+        for (uint32_t count : { 10u, 100u, 1000u })
+        {
+            BenchmarkReinitialize(audio, config, count, results);
+        }
+
+        audio.Deinitialize();
+    }
+    else
+    {
+        std::cerr << "Loopback device is not available, skipping OpenAL benchmarks" << std::endl;
+    }
+
+    if (outputPath.empty())
+    {
+        tulpar::tests::benchmarks::WriteJson(std::cout, results);
+    }
+    else
+    {
+        std::ofstream file(outputPath);
+        tulpar::tests::benchmarks::WriteJson(file, results);
+    }
+
+    return 0;
+}
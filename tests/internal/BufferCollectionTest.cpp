@@ -9,21 +9,35 @@
 #include "CollectionTestUtils.hpp"
 
 #include <tulpar/internal/BufferCollection.hpp>
+#include <tulpar/internal/MappedFile.hpp>
+#include <tulpar/internal/PcmCache.hpp>
+#include <tulpar/internal/VorbisStream.hpp>
+#include <tulpar/internal/WaveParser.hpp>
 
 #include <tulpar/Loggers.hpp>
 
 #include <mule/MuleUtilities.hpp>
 #include <mule/Loggers.hpp>
+#include <mule/asset/Storage.hpp>
 
 #include <spdlog/sinks/ansicolor_sink.h>
 
 #include <catch.hpp>
 
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace
 {
 static std::shared_ptr<tulpar::internal::BufferCollection> s_bufferCollection(nullptr);
+
+using tulpar::tests::internal::MakeWave;
 }
 
 void Setup()
@@ -159,6 +173,154 @@ TEST_CASE("Buffer collection resize", "[resize][collection]")
     }
 }
 
+TEST_CASE("Buffer handle generations", "[generation][collection]")
+{
+    using T = tulpar::audio::Buffer;
+
+    Setup();
+
+    GIVEN("collection with batch size of 1")
+    {
+        s_bufferCollection->Initialize(1);
+
+        WHEN("handle is reclaimed and spawned again")
+        {
+            T object = s_bufferCollection->Spawn();
+
+            uint32_t const handle = *(object.GetSharedHandle());
+            auto const generation = s_bufferCollection->GetGeneration(handle);
+
+            REQUIRE(true == s_bufferCollection->IsValid(handle, generation));
+
+            object.Reset();
+
+            REQUIRE(false == s_bufferCollection->IsValid(handle, generation));
+
+            T reused = s_bufferCollection->Spawn();
+
+            THEN("old generation is stale while handle is reused")
+            {
+                REQUIRE(handle == *(reused.GetSharedHandle()));
+                REQUIRE(true == s_bufferCollection->IsValid(handle));
+                REQUIRE(false == s_bufferCollection->IsValid(handle, generation));
+                REQUIRE(true == s_bufferCollection->IsValid(handle, s_bufferCollection->GetGeneration(handle)));
+            }
+        }
+        WHEN("objects are reclaimed out of order")
+        {
+            T object0 = s_bufferCollection->Spawn();
+            T object1 = s_bufferCollection->Spawn();
+            T object2 = s_bufferCollection->Spawn();
+
+            object0.Reset();
+
+            THEN("remaining objects are still accessible")
+            {
+                REQUIRE(2 == s_bufferCollection->GetSize());
+
+                REQUIRE(true == object1.IsValid());
+                REQUIRE(true == object2.IsValid());
+
+                REQUIRE(*(object1.GetSharedHandle()) == *(s_bufferCollection->Get(*(object1.GetSharedHandle())).GetSharedHandle()));
+                REQUIRE(*(object2.GetSharedHandle()) == *(s_bufferCollection->Get(*(object2.GetSharedHandle())).GetSharedHandle()));
+            }
+        }
+    }
+}
+
+TEST_CASE("Buffer asynchronous data", "[async][buffer]")
+{
+    Setup();
+
+    GIVEN("collection with worker pool")
+    {
+        s_bufferCollection->Initialize(1);
+        s_bufferCollection->SetWorkerPool(std::make_shared<tulpar::internal::WorkerPool>(2));
+
+        WHEN("empty batch is requested")
+        {
+            std::future<bool> result = s_bufferCollection->SetBuffersDataAsync({}, {});
+
+            THEN("request is completed immediately")
+            {
+                REQUIRE(std::future_status::ready == result.wait_for(std::chrono::seconds(0)));
+                REQUIRE(true == result.get());
+            }
+        }
+    }
+
+    s_bufferCollection.reset();
+
+    GIVEN("collection with worker pool and 100 ms wave file")
+    {
+        using tulpar::internal::BufferCollection;
+
+        tulpar::tests::internal::LoopbackContext context;
+        BufferCollection buffers;
+
+        REQUIRE(true == context.IsValid());
+
+        std::string const path("BufferAsyncTest.wav");
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(path, MakeWave(1, 1, 16, 4410)));
+
+        buffers.Initialize(1);
+        buffers.SetWorkerPool(std::make_shared<tulpar::internal::WorkerPool>(2));
+
+        tulpar::audio::Buffer object = buffers.Spawn();
+        BufferCollection::Handle const handle = *(object.GetSharedHandle());
+
+        WHEN("file is set asynchronously")
+        {
+            std::future<bool> result = buffers.SetBufferFileAsync(handle, path);
+
+            THEN("decoded data is uploaded by the thread owning the context")
+            {
+                REQUIRE(std::future_status::timeout == result.wait_for(std::chrono::seconds(0)));
+                REQUIRE(0 == buffers.GetBufferSampleCount(handle));
+
+                buffers.FinishPendingData();
+
+                REQUIRE(std::future_status::ready == result.wait_for(std::chrono::seconds(0)));
+                REQUIRE(true == result.get());
+                REQUIRE(0 < buffers.GetBufferSampleCount(handle));
+                REQUIRE(std::chrono::milliseconds(100) == buffers.GetBufferDuration(handle));
+            }
+        }
+        WHEN("buffer handle is reused before upload")
+        {
+            std::future<bool> result = buffers.SetBufferFileAsync(handle, path);
+
+            object.Reset();
+            object = buffers.Spawn();
+
+            REQUIRE(handle == *(object.GetSharedHandle()));
+
+            buffers.FinishPendingData();
+
+            THEN("decoded data is discarded")
+            {
+                REQUIRE(false == result.get());
+                REQUIRE(0 == buffers.GetBufferSampleCount(handle));
+            }
+        }
+        WHEN("file does not exist")
+        {
+            std::future<bool> result = buffers.SetBufferFileAsync(handle, "BufferAsyncMissingTest.wav");
+
+            THEN("request fails immediately")
+            {
+                REQUIRE(std::future_status::ready == result.wait_for(std::chrono::seconds(0)));
+                REQUIRE(false == result.get());
+            }
+        }
+
+        buffers.FinishPendingData();
+
+        std::remove(path.c_str());
+    }
+}
+
 TEST_CASE("Buffer handling", "[buffer]")
 {
     using T = tulpar::audio::Buffer;
@@ -224,3 +386,469 @@ TEST_CASE("Buffer handling", "[buffer]")
         }
     }
 }
+
+TEST_CASE("Buffer budget", "[budget][buffer]")
+{
+    using T = tulpar::audio::Buffer;
+    using tulpar::internal::BufferCollection;
+
+    Setup();
+
+    tulpar::tests::internal::LoopbackContext context;
+    BufferCollection buffers;
+
+    REQUIRE(true == context.IsValid());
+
+    GIVEN("budget of two buffers and three files")
+    {
+        // 100 ms of mono 16-bit samples
+        uint32_t const size = 4410;
+        std::string const paths[3] = { "BufferBudgetTest0.wav", "BufferBudgetTest1.wav", "BufferBudgetTest2.wav" };
+
+        for (std::string const& path : paths)
+        {
+            REQUIRE(true == tulpar::tests::internal::WriteFile(path, MakeWave(1, 1, 16, size)));
+        }
+
+        buffers.Initialize(1);
+        buffers.SetBudget(2 * size);
+
+        T objects[3] = { buffers.Spawn(), buffers.Spawn(), buffers.Spawn() };
+        BufferCollection::Handle const handles[3] = {
+            *(objects[0].GetSharedHandle()), *(objects[1].GetSharedHandle()), *(objects[2].GetSharedHandle())
+        };
+
+        auto load = [&](uint32_t index)
+        {
+            return buffers.SetBufferFile(handles[index], paths[index]);
+        };
+
+        WHEN("all files are loaded")
+        {
+            REQUIRE(true == load(0));
+            REQUIRE(true == load(1));
+            REQUIRE(true == load(2));
+
+            THEN("least recently used buffer is evicted")
+            {
+                REQUIRE(2 * size == buffers.GetResidentSize());
+                REQUIRE(0 == buffers.GetBufferResidentSize(handles[0]));
+                REQUIRE(size == buffers.GetBufferResidentSize(handles[1]));
+                REQUIRE(size == buffers.GetBufferResidentSize(handles[2]));
+                REQUIRE(size / 2 == buffers.GetBufferSampleCount(handles[0]));
+            }
+            THEN("evicted buffer is reloaded when attached")
+            {
+                REQUIRE(true == buffers.AcquireBuffer(handles[0]));
+
+                REQUIRE(2 * size == buffers.GetResidentSize());
+                REQUIRE(size == buffers.GetBufferResidentSize(handles[0]));
+                REQUIRE(0 == buffers.GetBufferResidentSize(handles[1]));
+
+                buffers.ReleaseBuffer(handles[0]);
+            }
+            THEN("evicted buffer can't be attached once its file is gone")
+            {
+                std::remove(paths[0].c_str());
+
+                REQUIRE(false == buffers.AcquireBuffer(handles[0]));
+                REQUIRE(0 == buffers.GetBufferResidentSize(handles[0]));
+            }
+        }
+        WHEN("least recently used buffer is attached")
+        {
+            REQUIRE(true == load(0));
+            REQUIRE(true == load(1));
+            REQUIRE(true == buffers.AcquireBuffer(handles[0]));
+            REQUIRE(true == load(2));
+
+            THEN("it stays resident")
+            {
+                REQUIRE(size == buffers.GetBufferResidentSize(handles[0]));
+                REQUIRE(0 == buffers.GetBufferResidentSize(handles[1]));
+            }
+            THEN("budget is enforced once it is released")
+            {
+                REQUIRE(true == buffers.AcquireBuffer(handles[2]));
+                REQUIRE(true == load(1));
+
+                REQUIRE(3 * size == buffers.GetResidentSize());
+
+                buffers.ReleaseBuffer(handles[0]);
+
+                REQUIRE(2 * size == buffers.GetResidentSize());
+                REQUIRE(0 == buffers.GetBufferResidentSize(handles[1]));
+            }
+        }
+
+        for (std::string const& path : paths)
+        {
+            std::remove(path.c_str());
+        }
+    }
+}
+
+TEST_CASE("PCM cache", "[cache][buffer]")
+{
+    using tulpar::internal::PcmCache;
+    using tulpar::internal::PcmData;
+
+    Setup();
+
+    GIVEN("budget of two entries and three assets")
+    {
+        uint64_t const size = 64;
+        std::string const paths[3] = { "PcmCacheTest0.wav", "PcmCacheTest1.wav", "PcmCacheTest2.wav" };
+
+        mule::asset::Handler assets[3];
+        std::shared_ptr<PcmData const> pcms[3];
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            REQUIRE(true == tulpar::tests::internal::WriteFile(paths[i], MakeWave(1, 1, 16, 2)));
+
+            assets[i] = mule::asset::Storage::Instance().Get(paths[i]);
+
+            std::shared_ptr<PcmData> pcm = std::make_shared<PcmData>();
+            pcm->bytes.resize(size);
+            pcms[i] = pcm;
+        }
+
+        PcmCache cache(2 * size);
+
+        cache.Insert(assets[0], pcms[0]);
+        cache.Insert(assets[1], pcms[1]);
+
+        REQUIRE(2 * size == cache.GetSize());
+        REQUIRE(2 == cache.GetEntryCount());
+
+        WHEN("another entry is inserted")
+        {
+            cache.Insert(assets[2], pcms[2]);
+
+            THEN("least recently inserted entry is evicted")
+            {
+                REQUIRE(2 * size == cache.GetSize());
+                REQUIRE(2 == cache.GetEntryCount());
+                REQUIRE(nullptr == cache.Find(assets[0]));
+                REQUIRE(pcms[1] == cache.Find(assets[1]));
+                REQUIRE(pcms[2] == cache.Find(assets[2]));
+            }
+        }
+        WHEN("oldest entry is found before another one is inserted")
+        {
+            REQUIRE(pcms[0] == cache.Find(assets[0]));
+
+            cache.Insert(assets[2], pcms[2]);
+
+            THEN("least recently found entry is evicted")
+            {
+                REQUIRE(pcms[0] == cache.Find(assets[0]));
+                REQUIRE(nullptr == cache.Find(assets[1]));
+                REQUIRE(pcms[2] == cache.Find(assets[2]));
+            }
+        }
+        WHEN("cached asset is inserted again")
+        {
+            std::shared_ptr<PcmData> pcm = std::make_shared<PcmData>();
+            pcm->bytes.resize(size / 2);
+
+            cache.Insert(assets[0], pcm);
+
+            THEN("entry is replaced")
+            {
+                REQUIRE(size + size / 2 == cache.GetSize());
+                REQUIRE(2 == cache.GetEntryCount());
+                REQUIRE(pcm == cache.Find(assets[0]));
+            }
+        }
+        WHEN("data exceeds budget")
+        {
+            std::shared_ptr<PcmData> pcm = std::make_shared<PcmData>();
+            pcm->bytes.resize(2 * size + 1);
+
+            cache.Insert(assets[2], pcm);
+
+            THEN("it is not cached and nothing is evicted")
+            {
+                REQUIRE(nullptr == cache.Find(assets[2]));
+                REQUIRE(2 * size == cache.GetSize());
+                REQUIRE(2 == cache.GetEntryCount());
+            }
+        }
+        WHEN("budget is lowered")
+        {
+            cache.SetBudget(size);
+
+            THEN("least recently used entries are evicted")
+            {
+                REQUIRE(size == cache.GetBudget());
+                REQUIRE(size == cache.GetSize());
+                REQUIRE(1 == cache.GetEntryCount());
+                REQUIRE(nullptr == cache.Find(assets[0]));
+                REQUIRE(pcms[1] == cache.Find(assets[1]));
+            }
+        }
+        WHEN("cache is cleared")
+        {
+            cache.Clear();
+
+            THEN("it is empty")
+            {
+                REQUIRE(0 == cache.GetSize());
+                REQUIRE(0 == cache.GetEntryCount());
+                REQUIRE(nullptr == cache.Find(assets[0]));
+                REQUIRE(nullptr == cache.Find(assets[1]));
+            }
+        }
+
+        for (std::string const& path : paths)
+        {
+            std::remove(path.c_str());
+        }
+    }
+
+    s_bufferCollection.reset();
+}
+
+TEST_CASE("Buffer references", "[reference][collection]")
+{
+    using T = tulpar::audio::Buffer;
+
+    Setup();
+
+    GIVEN("collection with batch size of 1")
+    {
+        s_bufferCollection->Initialize(1);
+
+        WHEN("reference is created")
+        {
+            T object = s_bufferCollection->Spawn();
+
+            tulpar::audio::BufferRef reference = s_bufferCollection->GetReference(*(object.GetSharedHandle()));
+
+            THEN("it resolves to the same object")
+            {
+                REQUIRE(true == s_bufferCollection->IsValid(reference));
+                REQUIRE(*(object.GetSharedHandle()) == s_bufferCollection->GetHandle(reference));
+                REQUIRE(*(object.GetSharedHandle()) == *(s_bufferCollection->Resolve(reference).GetSharedHandle()));
+            }
+            THEN("it becomes stale after the object is reset")
+            {
+                object.Reset();
+
+                REQUIRE(false == s_bufferCollection->IsValid(reference));
+
+                T other = s_bufferCollection->Spawn();
+
+                tulpar::audio::BufferRef otherReference = s_bufferCollection->GetReference(*(other.GetSharedHandle()));
+
+                REQUIRE(false == s_bufferCollection->IsValid(reference));
+                REQUIRE(true == s_bufferCollection->IsValid(otherReference));
+                REQUIRE(reference != otherReference);
+            }
+        }
+        WHEN("reference is default constructed")
+        {
+            THEN("it is invalid")
+            {
+                REQUIRE(false == s_bufferCollection->IsValid(tulpar::audio::BufferRef()));
+            }
+        }
+    }
+}
+
+TEST_CASE("Wave parsing", "[wave][buffer]")
+{
+    using tulpar::internal::PcmData;
+    using tulpar::internal::WaveParser::IsWave;
+    using tulpar::internal::WaveParser::Parse;
+
+    GIVEN("stereo 16-bit data")
+    {
+        std::vector<uint8_t> const data = MakeWave(1, 2, 16, 64);
+
+        THEN("samples are borrowed from content")
+        {
+            PcmData pcm;
+
+            REQUIRE(true == IsWave(data.data(), data.size()));
+            REQUIRE(true == Parse(data.data(), data.size(), pcm));
+
+            REQUIRE(true == pcm.IsBorrowed());
+            REQUIRE(PcmData::Format::Int16 == pcm.format);
+            REQUIRE(2 == pcm.channels);
+            REQUIRE(22050 == pcm.frequencyHz);
+            REQUIRE(64 == pcm.GetSize());
+            REQUIRE(32 == pcm.GetSampleCount());
+            REQUIRE(data.data() + data.size() - 64 == pcm.GetData());
+        }
+    }
+    GIVEN("mono 8-bit and float data")
+    {
+        std::vector<uint8_t> const data8 = MakeWave(1, 1, 8, 10);
+        std::vector<uint8_t> const dataFloat = MakeWave(3, 1, 32, 18);
+
+        THEN("formats are detected and partial frames dropped")
+        {
+            PcmData pcm8;
+            PcmData pcmFloat;
+
+            REQUIRE(true == Parse(data8.data(), data8.size(), pcm8));
+            REQUIRE(PcmData::Format::UInt8 == pcm8.format);
+            REQUIRE(10 == pcm8.GetSampleCount());
+
+            REQUIRE(true == Parse(dataFloat.data(), dataFloat.size(), pcmFloat));
+            REQUIRE(PcmData::Format::Float32 == pcmFloat.format);
+            REQUIRE(4 == pcmFloat.GetSampleCount());
+        }
+    }
+    GIVEN("5.1 float data")
+    {
+        std::vector<uint8_t> const data = MakeWave(3, 6, 32, 48);
+
+        THEN("layout is accepted")
+        {
+            PcmData pcm;
+
+            REQUIRE(true == Parse(data.data(), data.size(), pcm));
+            REQUIRE(6 == pcm.channels);
+            REQUIRE(12 == pcm.GetSampleCount());
+        }
+    }
+    GIVEN("unsupported or truncated data")
+    {
+        std::vector<uint8_t> const data24 = MakeWave(1, 2, 24, 12);
+        std::vector<uint8_t> const data3 = MakeWave(1, 3, 16, 12);
+        std::vector<uint8_t> const truncated = MakeWave(1, 2, 16, 64);
+
+        THEN("parsing fails")
+        {
+            PcmData pcm;
+
+            REQUIRE(false == Parse(data24.data(), data24.size(), pcm));
+            REQUIRE(false == Parse(data3.data(), data3.size(), pcm));
+            REQUIRE(false == IsWave(truncated.data(), 8));
+            REQUIRE(false == Parse(truncated.data(), 40, pcm));
+        }
+    }
+}
+
+TEST_CASE("Stereo down-mix", "[downmix][buffer]")
+{
+    using tulpar::internal::PcmData;
+    using tulpar::internal::WaveParser::Parse;
+
+    GIVEN("stereo 16-bit and 8-bit data")
+    {
+        std::vector<uint8_t> data16 = MakeWave(1, 2, 16, 8);
+        std::vector<uint8_t> data8 = MakeWave(1, 2, 8, 4);
+
+        int16_t const samples16[] = { 1000, 3000, -32768, -32768 };
+        uint8_t const samples8[] = { 0, 255, 128, 130 };
+
+        std::memcpy(data16.data() + data16.size() - sizeof(samples16), samples16, sizeof(samples16));
+        std::memcpy(data8.data() + data8.size() - sizeof(samples8), samples8, sizeof(samples8));
+
+        WHEN("data is down-mixed to mono")
+        {
+            PcmData stereo16;
+            PcmData stereo8;
+
+            REQUIRE(true == Parse(data16.data(), data16.size(), stereo16));
+            REQUIRE(true == Parse(data8.data(), data8.size(), stereo8));
+
+            PcmData const mono16 = PcmData::DownmixToMono(stereo16);
+            PcmData const mono8 = PcmData::DownmixToMono(stereo8);
+
+            THEN("channels are averaged into owned samples")
+            {
+                int16_t const* pMono16 = static_cast<int16_t const*>(mono16.GetData());
+                uint8_t const* pMono8 = static_cast<uint8_t const*>(mono8.GetData());
+
+                REQUIRE(false == mono16.IsBorrowed());
+                REQUIRE(true == mono16.isDownmixed);
+                REQUIRE(1 == mono16.channels);
+                REQUIRE(22050 == mono16.frequencyHz);
+                REQUIRE(PcmData::Format::Int16 == mono16.format);
+                REQUIRE(2 == mono16.GetSampleCount());
+                REQUIRE(2000 == pMono16[0]);
+                REQUIRE(-32768 == pMono16[1]);
+
+                REQUIRE(PcmData::Format::UInt8 == mono8.format);
+                REQUIRE(2 == mono8.GetSampleCount());
+                REQUIRE(127 == pMono8[0]);
+                REQUIRE(129 == pMono8[1]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Vorbis channel order", "[vorbis][buffer]")
+{
+    using tulpar::internal::VorbisStream;
+
+    GIVEN("5.1 and 7.1 frames in Vorbis order")
+    {
+        // FL, FC, FR, RL, RR, LFE
+        int16_t samples51[12] = { 0, 2, 1, 4, 5, 3, 10, 12, 11, 14, 15, 13 };
+
+        // FL, FC, FR, SL, SR, RL, RR, LFE
+        float samples71[8] = { 0.0f, 2.0f, 1.0f, 6.0f, 7.0f, 4.0f, 5.0f, 3.0f };
+
+        // stereo is left as is
+        int16_t samples20[2] = { 1, 0 };
+
+        THEN("they are reordered to OpenAL order")
+        {
+            VorbisStream::ReorderChannels(samples51, 2, 6);
+            VorbisStream::ReorderChannels(samples71, 1, 8);
+            VorbisStream::ReorderChannels(samples20, 1, 2);
+
+            for (int16_t i = 0; i < 6; ++i)
+            {
+                REQUIRE(i == samples51[i]);
+                REQUIRE(i + 10 == samples51[i + 6]);
+            }
+
+            for (int i = 0; i < 8; ++i)
+            {
+                REQUIRE(static_cast<float>(i) == samples71[i]);
+            }
+
+            REQUIRE(1 == samples20[0]);
+            REQUIRE(0 == samples20[1]);
+        }
+    }
+}
+
+TEST_CASE("Mapped file", "[file][buffer]")
+{
+    using tulpar::internal::MappedFile;
+
+    Setup();
+
+    GIVEN("existing file")
+    {
+        std::unique_ptr<MappedFile> file(MappedFile::Create(__FILE__));
+
+        THEN("its content is mapped")
+        {
+            REQUIRE(nullptr != file);
+            REQUIRE(__FILE__ == file->GetPath());
+            REQUIRE(file->GetSize() > 2);
+            REQUIRE(0 == std::memcmp(file->GetData(), "/*", 2));
+        }
+    }
+    GIVEN("missing file")
+    {
+        std::unique_ptr<MappedFile> file(MappedFile::Create(std::string(__FILE__) + ".missing"));
+
+        THEN("mapping fails")
+        {
+            REQUIRE(nullptr == file);
+        }
+    }
+
+    s_bufferCollection.reset();
+}
@@ -8,9 +8,16 @@
 #define TULPAR_TESTS_INTERNAL_COLLECTION_TEST_UTILS_HPP
 
 #include <tulpar/internal/Collection.hpp>
+#include <tulpar/internal/Context.hpp>
+#include <tulpar/internal/Device.hpp>
+
+#include <tulpar/TulparConfigurator.hpp>
 
 #include <cstdint>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace tulpar
 {
@@ -48,6 +55,99 @@ template<typename T>
 
 }
 
+//! Appends little endian integer of given size in bytes
+inline void AppendLittleEndian(std::vector<uint8_t>& data, uint32_t value, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+//! Appends four character chunk identifier
+inline void AppendId(std::vector<uint8_t>& data, char const* id)
+{
+    data.insert(data.end(), id, id + 4);
+}
+
+//! Creates 22050 Hz RIFF/WAVE content with silent samples
+inline std::vector<uint8_t> MakeWave(uint16_t formatTag, uint16_t channels, uint16_t bitsPerSample, uint32_t dataSize)
+{
+    uint16_t const blockAlign = channels * bitsPerSample / 8;
+
+    std::vector<uint8_t> data;
+    AppendId(data, "RIFF");
+    AppendLittleEndian(data, 4 + 26 + 16 + 8 + dataSize, 4);
+    AppendId(data, "WAVE");
+
+    // odd-sized chunk that has to be skipped
+    AppendId(data, "LIST");
+    AppendLittleEndian(data, 1, 4);
+    data.push_back(0);
+    data.push_back(0);
+
+    AppendId(data, "fmt ");
+    AppendLittleEndian(data, 16, 4);
+    AppendLittleEndian(data, formatTag, 2);
+    AppendLittleEndian(data, channels, 2);
+    AppendLittleEndian(data, 22050, 4);
+    AppendLittleEndian(data, 22050 * blockAlign, 4);
+    AppendLittleEndian(data, blockAlign, 2);
+    AppendLittleEndian(data, bitsPerSample, 2);
+
+    AppendId(data, "data");
+    AppendLittleEndian(data, dataSize, 4);
+    data.resize(data.size() + dataSize, 0);
+
+    return data;
+}
+
+//! Writes given content to a file, returns @c true if it was written
+inline bool WriteFile(std::string const& path, std::vector<uint8_t> const& data)
+{
+    std::ofstream file(path, std::ios::binary);
+
+    file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    return file.good();
+}
+
+/** @brief  Current OpenAL context of a mono loopback device
+ *
+ *  Lets tests call OpenAL without audio output, the context is current
+ *  for the lifetime of the object
+ */
+class LoopbackContext
+{
+public:
+    //! Creates loopback device and makes its context current
+    explicit LoopbackContext(uint32_t frequencyHz = 44100)
+        : m_device(tulpar::internal::Device::Create(tulpar::TulparConfigurator::Device::Loopback(frequencyHz, 1)))
+        , m_context((nullptr != m_device) ? tulpar::internal::Context::Create(*m_device) : nullptr)
+    {
+        if (nullptr != m_context)
+        {
+            m_context->MakeCurrent();
+        }
+    }
+
+    //! Returns @c true if context was created
+    bool IsValid() const { return nullptr != m_context; }
+
+    //! Returns loopback device
+    tulpar::internal::Device& GetDevice() { return *m_device; }
+
+    //! Returns current context
+    tulpar::internal::Context& GetContext() { return *m_context; }
+
+private:
+    //! Loopback device
+    std::unique_ptr<tulpar::internal::Device> m_device;
+
+    //! Context of the loopback device
+    std::unique_ptr<tulpar::internal::Context> m_context;
+};
+
 }
 }
 }
@@ -0,0 +1,174 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#define CATCH_CONFIG_MAIN
+
+#include <tulpar/internal/CommandQueue.hpp>
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Command queue order", "[queue]")
+{
+    using tulpar::internal::Command;
+    using tulpar::internal::CommandQueue;
+
+    GIVEN("queue with capacity of 3")
+    {
+        CommandQueue queue(3);
+
+        THEN("capacity is rounded up to the power of two")
+        {
+            REQUIRE(4 == queue.GetCapacity());
+        }
+        WHEN("queue is filled")
+        {
+            for (uint32_t i = 0; i < queue.GetCapacity(); ++i)
+            {
+                REQUIRE(true == queue.TryPush(Command::MakeScalar(Command::Type::SourceGain, i, 0.5f)));
+            }
+
+            THEN("no more commands can be pushed")
+            {
+                REQUIRE(false == queue.TryPush(Command::Make(Command::Type::SourcePlay, 0)));
+            }
+            THEN("commands are popped in push order")
+            {
+                Command command;
+
+                for (uint32_t i = 0; i < queue.GetCapacity(); ++i)
+                {
+                    REQUIRE(true == queue.Pop(command));
+                    REQUIRE(Command::Type::SourceGain == command.type);
+                    REQUIRE(i == command.handle);
+                    REQUIRE(0.5f == command.payload.scalar);
+                }
+
+                REQUIRE(false == queue.Pop(command));
+                REQUIRE(true == queue.TryPush(Command::Make(Command::Type::SourcePlay, 0)));
+            }
+        }
+    }
+}
+
+TEST_CASE("Command queue producers", "[queue]")
+{
+    using tulpar::internal::Command;
+    using tulpar::internal::CommandQueue;
+
+    GIVEN("queue smaller than the number of pushed commands")
+    {
+        uint32_t const producerCount = 4;
+        uint32_t const commandCount = 10000;
+
+        CommandQueue queue(64);
+
+        WHEN("several threads push commands")
+        {
+            std::vector<std::thread> producers;
+
+            for (uint32_t i = 0; i < producerCount; ++i)
+            {
+                producers.emplace_back([&queue, i]()
+                {
+                    for (uint32_t j = 0; j < commandCount; ++j)
+                    {
+                        queue.Push(Command::MakeInteger(Command::Type::VoicePriority, i, static_cast<int32_t>(j)));
+                    }
+                });
+            }
+
+            std::vector<int32_t> lastValues(producerCount, -1);
+            uint32_t popCount = 0;
+            bool isOrdered = true;
+
+            while (popCount < producerCount * commandCount)
+            {
+                Command command;
+
+                if (queue.Pop(command))
+                {
+                    isOrdered = isOrdered && (lastValues[command.handle] + 1 == command.payload.integer);
+                    lastValues[command.handle] = command.payload.integer;
+
+                    ++popCount;
+                }
+            }
+
+            for (std::thread& producer : producers)
+            {
+                producer.join();
+            }
+
+            THEN("every command is popped once in per-producer order")
+            {
+                Command command;
+
+                REQUIRE(true == isOrdered);
+                REQUIRE(false == queue.Pop(command));
+            }
+        }
+    }
+}
+
+TEST_CASE("Command queue consumer lock", "[queue]")
+{
+    using tulpar::internal::CommandQueue;
+    using tulpar::internal::ConsumerLock;
+
+    GIVEN("queue consumed by another thread")
+    {
+        std::mutex mutex;
+
+        CommandQueue queue(4);
+        queue.SetConsumerMutex(&mutex);
+
+        WHEN("producer takes nested locks")
+        {
+            ConsumerLock outer(&queue);
+            ConsumerLock inner(&queue);
+
+            THEN("consumer mutex is locked once")
+            {
+                bool isLocked = true;
+
+                std::thread([&]() { isLocked = !mutex.try_lock(); }).join();
+
+                REQUIRE(true == isLocked);
+            }
+        }
+        WHEN("producer releases the lock")
+        {
+            {
+                ConsumerLock lock(&queue);
+            }
+
+            THEN("consumer mutex is unlocked")
+            {
+                REQUIRE(true == mutex.try_lock());
+
+                mutex.unlock();
+            }
+        }
+        WHEN("lock is taken on the consumer thread")
+        {
+            queue.SetConsumerThread(std::this_thread::get_id());
+
+            std::lock_guard<std::mutex> consumerLock(mutex);
+
+            THEN("it does not wait for the mutex")
+            {
+                ConsumerLock lock(&queue);
+
+                REQUIRE(false == queue.IsProducerThread());
+            }
+        }
+    }
+}
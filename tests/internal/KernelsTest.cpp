@@ -0,0 +1,139 @@
+/*
+* Copyright (C) 2018 by Godlike
+* This code is licensed under the MIT license (MIT)
+* (http://opensource.org/licenses/MIT)
+*/
+
+#define CATCH_CONFIG_MAIN
+
+#include <tulpar/Kernels.hpp>
+
+#include <catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using tulpar::kernels::InstructionSet;
+
+//! Odd size so that both vector bodies and scalar tails are covered
+constexpr size_t s_sampleCount = 2 * 67;
+
+std::vector<float> MakeFloats()
+{
+    std::vector<float> result(s_sampleCount);
+
+    for (size_t i = 0; i < s_sampleCount; ++i)
+    {
+        result[i] = -1.25f + 2.5f * static_cast<float>(i) / static_cast<float>(s_sampleCount - 1);
+    }
+
+    result[1] = 0.5f / 32767.0f;
+    result[3] = 1.5f / 32767.0f;
+
+    return result;
+}
+
+std::vector<int16_t> MakeShorts()
+{
+    std::vector<int16_t> result(s_sampleCount);
+
+    for (size_t i = 0; i < s_sampleCount; ++i)
+    {
+        result[i] = static_cast<int16_t>(-32768 + static_cast<int32_t>(i * 65535 / (s_sampleCount - 1)));
+    }
+
+    return result;
+}
+}
+
+TEST_CASE("Kernels match scalar implementation", "[kernels]")
+{
+    InstructionSet const defaultSet = tulpar::kernels::GetInstructionSet();
+
+    std::vector<float> const floats = MakeFloats();
+    std::vector<int16_t> const shorts = MakeShorts();
+
+    REQUIRE(true == tulpar::kernels::SetInstructionSet(InstructionSet::Scalar));
+
+    std::vector<float> expectedFloats(s_sampleCount);
+    std::vector<int16_t> expectedShorts(s_sampleCount);
+    std::vector<float> expectedMono(s_sampleCount / 2);
+    std::vector<int16_t> expectedMonoShorts(s_sampleCount / 2);
+    std::vector<float> expectedScaled(floats);
+
+    tulpar::kernels::ConvertInt16ToFloat(shorts.data(), expectedFloats.data(), s_sampleCount);
+    tulpar::kernels::ConvertFloatToInt16(floats.data(), expectedShorts.data(), s_sampleCount);
+    tulpar::kernels::DownmixStereoToMono(floats.data(), expectedMono.data(), s_sampleCount / 2);
+    tulpar::kernels::DownmixStereoToMono(shorts.data(), expectedMonoShorts.data(), s_sampleCount / 2);
+    tulpar::kernels::ScaleGain(expectedScaled.data(), s_sampleCount, 0.25f);
+
+    GIVEN("scalar implementation")
+    {
+        THEN("conversions are clamped, rounded to even and symmetric")
+        {
+            REQUIRE(-32767 == expectedShorts[0]);
+            REQUIRE(0 == expectedShorts[1]);
+            REQUIRE(2 == expectedShorts[3]);
+            REQUIRE(32767 == expectedShorts[s_sampleCount - 1]);
+
+            REQUIRE(1.0f == expectedFloats[s_sampleCount - 1]);
+        }
+    }
+
+    for (InstructionSet set : { InstructionSet::Sse2, InstructionSet::Avx2, InstructionSet::Neon })
+    {
+        if (!tulpar::kernels::SetInstructionSet(set))
+        {
+            continue;
+        }
+
+        GIVEN("instruction set " << static_cast<int>(set))
+        {
+            THEN("conversions match")
+            {
+                std::vector<float> actualFloats(s_sampleCount);
+                std::vector<int16_t> actualShorts(s_sampleCount);
+
+                tulpar::kernels::ConvertInt16ToFloat(shorts.data(), actualFloats.data(), s_sampleCount);
+                tulpar::kernels::ConvertFloatToInt16(floats.data(), actualShorts.data(), s_sampleCount);
+
+                REQUIRE(expectedFloats == actualFloats);
+                REQUIRE(expectedShorts == actualShorts);
+            }
+            THEN("down-mix and gain match")
+            {
+                std::vector<float> actualMono(s_sampleCount / 2);
+                std::vector<int16_t> actualMonoShorts(s_sampleCount / 2);
+                std::vector<float> actualScaled(floats);
+
+                tulpar::kernels::DownmixStereoToMono(floats.data(), actualMono.data(), s_sampleCount / 2);
+                tulpar::kernels::DownmixStereoToMono(shorts.data(), actualMonoShorts.data(), s_sampleCount / 2);
+                tulpar::kernels::ScaleGain(actualScaled.data(), s_sampleCount, 0.25f);
+
+                REQUIRE(expectedMono == actualMono);
+                REQUIRE(expectedMonoShorts == actualMonoShorts);
+                REQUIRE(expectedScaled == actualScaled);
+            }
+            THEN("interleaving round trips")
+            {
+                std::vector<float> left(s_sampleCount / 2);
+                std::vector<float> right(s_sampleCount / 2);
+                std::vector<float> interleaved(s_sampleCount);
+
+                float* const planes[] = { left.data(), right.data() };
+                float const* const constPlanes[] = { left.data(), right.data() };
+
+                tulpar::kernels::Deinterleave(floats.data(), 2, s_sampleCount / 2, planes);
+                tulpar::kernels::Interleave(constPlanes, 2, s_sampleCount / 2, interleaved.data());
+
+                REQUIRE(floats[0] == left[0]);
+                REQUIRE(floats[s_sampleCount - 1] == right[s_sampleCount / 2 - 1]);
+                REQUIRE(floats == interleaved);
+            }
+        }
+    }
+
+    tulpar::kernels::SetInstructionSet(defaultSet);
+}
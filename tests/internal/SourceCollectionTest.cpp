@@ -9,10 +9,15 @@
 #include "CollectionTestUtils.hpp"
 
 #include <tulpar/internal/BufferCollection.hpp>
+#include <tulpar/internal/HotPath.hpp>
+#include <tulpar/internal/ListenerController.hpp>
 #include <tulpar/internal/SourceCollection.hpp>
+#include <tulpar/internal/VoiceCollection.hpp>
 
 #include <tulpar/Loggers.hpp>
+#include <tulpar/TulparAudio.hpp>
 
+#include <mule/asset/Storage.hpp>
 #include <mule/MuleUtilities.hpp>
 #include <mule/Loggers.hpp>
 
@@ -20,12 +25,37 @@
 
 #include <catch.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 
 namespace
 {
 static std::shared_ptr<tulpar::internal::SourceCollection> s_sourceCollection(nullptr);
 static std::shared_ptr<tulpar::internal::BufferCollection> s_bufferCollection(nullptr);
+
+//! Ogg Vorbis file used by streaming tests
+static std::string const s_streamFile(TULPAR_TEST_DATA_DIR"ding_02.ogg");
+
+//! Collections backed by OpenAL context of a loopback device
+struct LoopbackCollections
+{
+    LoopbackCollections()
+        : buffers()
+        , sources(buffers)
+    {
+        buffers.Initialize(1);
+        sources.Initialize(1);
+    }
+
+    //! Context has to outlive the collections
+    tulpar::tests::internal::LoopbackContext context;
+
+    tulpar::internal::BufferCollection buffers;
+    tulpar::internal::SourceCollection sources;
+};
 }
 
 void Setup()
@@ -233,3 +263,1554 @@ TEST_CASE("Source handling", "[source]")
         }
     }
 }
+
+TEST_CASE("Voice virtualization", "[collection]")
+{
+    using T = tulpar::audio::Voice;
+
+    Setup();
+
+    s_sourceCollection->Initialize(1);
+
+    tulpar::internal::ListenerController listener;
+    tulpar::internal::VoiceCollection voiceCollection(*s_sourceCollection.get(), listener);
+
+    GIVEN("collection with voice limit of 0")
+    {
+        voiceCollection.Initialize(1);
+        voiceCollection.SetVoiceLimit(0);
+
+        WHEN("voice is created")
+        {
+            T voice = voiceCollection.Spawn();
+
+            THEN("it is valid and virtual")
+            {
+                REQUIRE(true == voice.IsValid());
+                REQUIRE(true == voice.IsVirtual());
+                REQUIRE(tulpar::audio::Source::State::Initial == voice.GetState());
+            }
+            THEN("it can't be played without buffer")
+            {
+                REQUIRE(false == voice.Play());
+                REQUIRE(tulpar::audio::Source::State::Initial == voice.GetState());
+            }
+            THEN("its properties are stored without real source")
+            {
+                voice.SetPriority(3);
+                REQUIRE(true == voice.SetGain(0.5f));
+                REQUIRE(true == voice.SetPosition({{ 4.0f, 0.0f, 0.0f }}));
+
+                voiceCollection.UpdateVoices(std::chrono::milliseconds(16));
+
+                REQUIRE(3 == voice.GetPriority());
+                REQUIRE(0.5f == voice.GetGain());
+                REQUIRE(0.125f == voice.GetAudibility());
+                REQUIRE(true == voice.IsVirtual());
+                REQUIRE(0 == voiceCollection.GetRealVoiceCount());
+            }
+        }
+        WHEN("voice is reset")
+        {
+            T voice = voiceCollection.Spawn();
+
+            voice.Reset();
+
+            THEN("it becomes invalid")
+            {
+                REQUIRE(false == voice.IsValid());
+            }
+        }
+    }
+}
+
+TEST_CASE("Voice ranking", "[loopback][collection]")
+{
+    using T = tulpar::audio::Voice;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    tulpar::internal::ListenerController listener;
+    tulpar::internal::VoiceCollection voiceCollection(al.sources, listener);
+
+    voiceCollection.Initialize(1);
+
+    GIVEN("two voices playing 1 s of data with a single real source")
+    {
+        std::string const path("VoiceRankingTest.wav");
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(path, tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 22050)));
+
+        tulpar::audio::Buffer buffer = al.buffers.Spawn();
+
+        REQUIRE(true == al.buffers.SetBufferFile(*(buffer.GetSharedHandle()), path));
+
+        std::remove(path.c_str());
+
+        voiceCollection.SetVoiceLimit(1);
+
+        T quiet = voiceCollection.Spawn();
+        T loud = voiceCollection.Spawn();
+
+        REQUIRE(true == quiet.SetBuffer(buffer));
+        REQUIRE(true == quiet.SetGain(0.25f));
+        REQUIRE(true == quiet.Play());
+
+        REQUIRE(true == loud.SetBuffer(buffer));
+        REQUIRE(true == loud.Play());
+
+        THEN("handles are generated by the collection")
+        {
+            REQUIRE(0 == *(quiet.GetSharedHandle()));
+            REQUIRE(1 == *(loud.GetSharedHandle()));
+        }
+        THEN("spare source is taken before ranking")
+        {
+            REQUIRE(false == quiet.IsVirtual());
+            REQUIRE(true == loud.IsVirtual());
+        }
+        WHEN("voices are updated")
+        {
+            voiceCollection.UpdateVoices(std::chrono::milliseconds(200));
+
+            THEN("more audible voice is promoted from its advanced clock")
+            {
+                REQUIRE(true == quiet.IsVirtual());
+                REQUIRE(false == loud.IsVirtual());
+                REQUIRE(1 == voiceCollection.GetRealVoiceCount());
+
+                REQUIRE(loud.GetPlaybackPosition() > std::chrono::milliseconds(199));
+                REQUIRE(loud.GetPlaybackPosition() < std::chrono::milliseconds(201));
+            }
+            THEN("higher priority wins over audibility")
+            {
+                quiet.SetPriority(1);
+
+                voiceCollection.UpdateVoices(std::chrono::milliseconds(100));
+
+                REQUIRE(false == quiet.IsVirtual());
+                REQUIRE(true == loud.IsVirtual());
+
+                REQUIRE(loud.GetPlaybackPosition() > std::chrono::milliseconds(199));
+                REQUIRE(loud.GetPlaybackPosition() < std::chrono::milliseconds(201));
+
+                voiceCollection.UpdateVoices(std::chrono::milliseconds(100));
+
+                REQUIRE(loud.GetPlaybackPosition() > std::chrono::milliseconds(299));
+                REQUIRE(loud.GetPlaybackPosition() < std::chrono::milliseconds(301));
+            }
+            THEN("virtual voice stops when its clock passes buffer duration")
+            {
+                voiceCollection.UpdateVoices(std::chrono::milliseconds(1100));
+
+                REQUIRE(tulpar::audio::Source::State::Stopped == quiet.GetState());
+                REQUIRE(tulpar::audio::Source::State::Playing == loud.GetState());
+            }
+        }
+        WHEN("buffer data is bound after the buffer is set")
+        {
+            REQUIRE(true == tulpar::tests::internal::WriteFile(path, tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 2205)));
+
+            tulpar::audio::Buffer late = al.buffers.Spawn();
+            T voice = voiceCollection.Spawn();
+
+            REQUIRE(true == voice.SetBuffer(late));
+            REQUIRE(true == voice.SetGain(0.125f));
+            REQUIRE(true == al.buffers.SetBufferFile(*(late.GetSharedHandle()), path));
+
+            std::remove(path.c_str());
+
+            THEN("virtual voice plays for the duration of bound data")
+            {
+                REQUIRE(true == voice.Play());
+                REQUIRE(true == voice.IsVirtual());
+
+                voiceCollection.UpdateVoices(std::chrono::milliseconds(50));
+
+                REQUIRE(tulpar::audio::Source::State::Playing == voice.GetState());
+
+                voiceCollection.UpdateVoices(std::chrono::milliseconds(50));
+
+                REQUIRE(tulpar::audio::Source::State::Stopped == voice.GetState());
+            }
+        }
+    }
+}
+
+TEST_CASE("Source events", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::internal::Context;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    GIVEN("event driven collection")
+    {
+        s_sourceCollection->Initialize(1);
+        s_sourceCollection->SetEventDriven(true);
+
+        T object = s_sourceCollection->Spawn();
+        SourceCollection::SourceHandle const handle = *(object.GetSharedHandle());
+
+        WHEN("buffer completion is received")
+        {
+            SourceCollection::HandleEvent(Context::EventType::BufferCompleted, static_cast<ALuint>(handle), 2, s_sourceCollection.get());
+
+            THEN("event is collected during update")
+            {
+                REQUIRE(true == s_sourceCollection->ConsumeSourceEvents().empty());
+
+                s_sourceCollection->UpdateSourceEvents();
+
+                std::vector<tulpar::audio::SourceEvent> const events = s_sourceCollection->ConsumeSourceEvents();
+
+                REQUIRE(1 == events.size());
+                REQUIRE(tulpar::audio::SourceEvent::Type::BufferCompleted == events[0].type);
+                REQUIRE(s_sourceCollection->GetReference(handle) == events[0].source);
+                REQUIRE(2 == events[0].count);
+
+                REQUIRE(true == s_sourceCollection->ConsumeSourceEvents().empty());
+            }
+        }
+        WHEN("source is reset before update")
+        {
+            SourceCollection::HandleEvent(Context::EventType::BufferCompleted, static_cast<ALuint>(handle), 1, s_sourceCollection.get());
+
+            object.Reset();
+
+            THEN("event is dropped")
+            {
+                s_sourceCollection->UpdateSourceEvents();
+
+                REQUIRE(true == s_sourceCollection->ConsumeSourceEvents().empty());
+            }
+        }
+        WHEN("source is reset and its handle is reused before update")
+        {
+            SourceCollection::HandleEvent(Context::EventType::BufferCompleted, static_cast<ALuint>(handle), 1, s_sourceCollection.get());
+
+            object.Reset();
+            object = s_sourceCollection->Spawn();
+
+            THEN("event is not delivered to the new source")
+            {
+                REQUIRE(handle == *(object.GetSharedHandle()));
+
+                s_sourceCollection->UpdateSourceEvents();
+
+                REQUIRE(true == s_sourceCollection->ConsumeSourceEvents().empty());
+            }
+        }
+    }
+}
+
+TEST_CASE("Procedural sources", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("collection with stream ring of 3 buffers")
+    {
+        al.sources.SetStreamSettings(3, 64);
+
+        T object = al.sources.Spawn();
+        SourceCollection::SourceHandle const handle = *(object.GetSharedHandle());
+
+        uint32_t calls = 0;
+        uint32_t available = 1000;
+
+        auto callback = [&](void* pSamples, uint32_t frameCount) -> uint32_t
+        {
+            uint32_t const count = std::min(frameCount, available);
+
+            std::fill_n(static_cast<int16_t*>(pSamples), count, int16_t(0));
+
+            available -= count;
+            ++calls;
+
+            return count;
+        };
+
+        WHEN("callback is bound")
+        {
+            bool const isBound = al.sources.SetSourceCallback(handle, callback, 1, 44100, T::SampleFormat::Int16);
+
+            THEN("source is procedural and data is pulled on play")
+            {
+                REQUIRE(true == isBound);
+                REQUIRE(true == al.sources.IsSourceProcedural(handle));
+                REQUIRE(false == al.sources.IsSourceStreamed(handle));
+                REQUIRE(0 == calls);
+
+                al.sources.PlaySource(handle);
+
+                REQUIRE(3 == calls);
+                REQUIRE(1000 - 3 * 64 == available);
+            }
+            THEN("pulling stops at the end of data")
+            {
+                available = 100;
+
+                al.sources.PlaySource(handle);
+
+                REQUIRE(2 == calls);
+                REQUIRE(0 == available);
+            }
+            THEN("reset releases callback")
+            {
+                object.Reset();
+
+                REQUIRE(false == al.sources.IsSourceProcedural(handle));
+            }
+        }
+    }
+}
+
+TEST_CASE("Streamed sources", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("collection with stream ring of 3 buffers")
+    {
+        al.sources.SetStreamSettings(3, 256);
+
+        T object = al.sources.Spawn();
+        SourceCollection::SourceHandle const handle = *(object.GetSharedHandle());
+
+        WHEN("Ogg Vorbis stream is bound")
+        {
+            mule::asset::Handler asset = mule::asset::Storage::Instance().Get(s_streamFile);
+
+            REQUIRE(true == al.sources.SetSourceStream(handle, asset));
+
+            THEN("source is streamed")
+            {
+                REQUIRE(true == al.sources.IsSourceStreamed(handle));
+                REQUIRE(false == al.sources.IsSourceProcedural(handle));
+                REQUIRE(T::State::Initial == al.sources.GetSourceState(handle));
+            }
+            THEN("processed buffers are refilled while playing")
+            {
+                REQUIRE(true == al.sources.SetSourceRelative(handle, true));
+                REQUIRE(true == al.sources.PlaySource(handle));
+
+                std::vector<int16_t> rendered(256, 0);
+
+                for (uint32_t i = 0; i < 8; ++i)
+                {
+                    REQUIRE(true == al.context.GetDevice().RenderSamples(rendered.data(), 256));
+
+                    al.sources.UpdateSourceStreams();
+                }
+
+                REQUIRE(T::State::Playing == al.sources.GetSourceState(handle));
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) > std::chrono::milliseconds(30));
+            }
+            THEN("reset releases stream")
+            {
+                object.Reset();
+
+                REQUIRE(false == al.sources.IsSourceStreamed(handle));
+            }
+            THEN("culled stream resumes from its clock")
+            {
+                using DistanceModel = tulpar::audio::Listener::DistanceModel;
+
+                std::array<float, 3> const listener{{ 0.0f, 0.0f, 0.0f }};
+
+                REQUIRE(true == al.sources.SetSourcePosition(handle, {{ 1000.0f, 0.0f, 0.0f }}));
+                REQUIRE(true == al.sources.PlaySource(handle));
+
+                al.sources.CullSources(listener, DistanceModel::InverseClamped, 0.01f, std::chrono::nanoseconds(0));
+
+                REQUIRE(true == al.sources.IsSourceCulled(handle));
+                REQUIRE(T::State::Playing == al.sources.GetSourceState(handle));
+
+                al.sources.CullSources(listener, DistanceModel::InverseClamped, 0.0f, std::chrono::milliseconds(100));
+
+                REQUIRE(false == al.sources.IsSourceCulled(handle));
+                REQUIRE(T::State::Playing == al.sources.GetSourceState(handle));
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) >= std::chrono::milliseconds(99));
+
+                al.sources.CullSources(listener, DistanceModel::InverseClamped, 0.01f, std::chrono::nanoseconds(0));
+
+                REQUIRE(true == al.sources.IsSourceCulled(handle));
+            }
+        }
+        WHEN("asset is not Ogg Vorbis")
+        {
+            THEN("stream is not bound")
+            {
+                REQUIRE(false == al.sources.SetSourceStream(handle, mule::asset::Handler()));
+                REQUIRE(false == al.sources.IsSourceStreamed(handle));
+            }
+        }
+    }
+}
+
+TEST_CASE("Culled source migration", "[loopback][source]")
+{
+    using tulpar::audio::Source;
+
+    Setup();
+
+    GIVEN("library instance with inaudible source culled for 500 ms")
+    {
+        std::string const path("CulledSourceMigrationTest.wav");
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(path, tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 22050)));
+
+        tulpar::TulparConfigurator config;
+        config.device = tulpar::TulparConfigurator::Device::Loopback(44100, 1);
+        config.cullThreshold = 0.01f;
+
+        tulpar::TulparAudio audio;
+
+        REQUIRE(true == audio.Initialize(config));
+
+        tulpar::audio::Buffer buffer = audio.SpawnBuffer();
+        Source source = audio.SpawnSource();
+
+        REQUIRE(true == buffer.BindFile(path));
+        REQUIRE(true == source.SetStaticBuffer(buffer));
+        REQUIRE(true == source.SetPosition({{ 1000.0f, 0.0f, 0.0f }}));
+        REQUIRE(true == source.Play());
+
+        std::vector<int16_t> rendered(22050, 0);
+
+        audio.Update();
+
+        REQUIRE(true == audio.RenderSamples(rendered.data(), 22050));
+
+        audio.Update();
+
+        REQUIRE(std::chrono::milliseconds(500) == source.GetPlaybackPosition());
+
+        WHEN("library instance is reinitialized")
+        {
+            REQUIRE(true == audio.Reinitialize(config));
+
+            THEN("source keeps its culled clock")
+            {
+                REQUIRE(Source::State::Playing == source.GetState());
+                REQUIRE(std::chrono::milliseconds(500) == source.GetPlaybackPosition());
+            }
+            THEN("source resumes from its clock once audible")
+            {
+                REQUIRE(true == source.SetPosition({{ 0.0f, 0.0f, 0.0f }}));
+
+                audio.Update();
+
+                REQUIRE(Source::State::Playing == source.GetState());
+                REQUIRE(source.GetPlaybackPosition() > std::chrono::milliseconds(499));
+                REQUIRE(source.GetPlaybackPosition() < std::chrono::milliseconds(501));
+            }
+        }
+
+        // file backed buffers are reloaded from their files on migration
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("Rejected source properties", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("source with set properties")
+    {
+        T object = al.sources.Spawn();
+        SourceCollection::SourceHandle const handle = *(object.GetSharedHandle());
+
+        std::array<float, 3> const position{{ 1.0f, 2.0f, 3.0f }};
+
+        REQUIRE(true == al.sources.SetSourceGain(handle, 0.5f));
+        REQUIRE(true == al.sources.SetSourcePitch(handle, 2.0f));
+        REQUIRE(true == al.sources.SetSourcePosition(handle, position));
+
+        WHEN("values rejected by OpenAL are set")
+        {
+            float const nan = std::numeric_limits<float>::quiet_NaN();
+
+            bool const isGainSet = al.sources.SetSourceGain(handle, -1.0f);
+            bool const isPitchSet = al.sources.SetSourcePitch(handle, nan);
+            bool const isPositionSet = al.sources.SetSourcePosition(handle, {{ 0.0f, nan, 0.0f }});
+
+            THEN("values are not stored")
+            {
+                REQUIRE(false == isGainSet);
+                REQUIRE(false == isPitchSet);
+                REQUIRE(false == isPositionSet);
+
+                REQUIRE(0.5f == al.sources.GetSourceGain(handle));
+                REQUIRE(2.0f == al.sources.GetSourcePitch(handle));
+                REQUIRE(position == al.sources.GetSourcePosition(handle));
+            }
+        }
+        WHEN("unchecked call leaves an error")
+        {
+            using Unchecked = tulpar::internal::HotPathPolicy<false>;
+
+            alSourcef(static_cast<ALuint>(handle), AL_GAIN, -1.0f);
+
+            THEN("unchecked error polling leaves it for the frame check")
+            {
+                REQUIRE(AL_NO_ERROR == Unchecked::GetError());
+                REQUIRE(false == Unchecked::CheckFrame());
+                REQUIRE(true == Unchecked::CheckFrame());
+            }
+            THEN("clearing error state reports it")
+            {
+                REQUIRE(AL_INVALID_VALUE == Unchecked::ClearError());
+                REQUIRE(true == Unchecked::CheckFrame());
+            }
+        }
+    }
+}
+
+TEST_CASE("Cached source properties", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("new source")
+    {
+        T object = al.sources.Spawn();
+        SourceCollection::SourceHandle const handle = *(object.GetSharedHandle());
+        ALuint const alSource = static_cast<ALuint>(handle);
+
+        auto getFloat = [alSource](ALenum param)
+        {
+            ALfloat value = -1.0f;
+            alGetSourcef(alSource, param, &value);
+
+            return value;
+        };
+
+        auto getInt = [alSource](ALenum param)
+        {
+            ALint value = -1;
+            alGetSourcei(alSource, param, &value);
+
+            return value;
+        };
+
+        THEN("cached values match OpenAL defaults")
+        {
+            REQUIRE(getFloat(AL_PITCH) == al.sources.GetSourcePitch(handle));
+            REQUIRE(getFloat(AL_GAIN) == al.sources.GetSourceGain(handle));
+            REQUIRE(getFloat(AL_REFERENCE_DISTANCE) == al.sources.GetSourceReferenceDistance(handle));
+            REQUIRE(getFloat(AL_MAX_DISTANCE) == al.sources.GetSourceMaxDistance(handle));
+            REQUIRE(getFloat(AL_ROLLOFF_FACTOR) == al.sources.GetSourceRolloffFactor(handle));
+            REQUIRE((AL_TRUE == getInt(AL_SOURCE_RELATIVE)) == al.sources.IsSourceRelative(handle));
+            REQUIRE((AL_TRUE == getInt(AL_LOOPING)) == al.sources.IsSourceLooping(handle));
+        }
+        WHEN("properties are set")
+        {
+            std::array<float, 3> const position{{ 1.0f, 2.0f, 3.0f }};
+            std::array<float, 3> const velocity{{ -1.0f, 0.5f, 0.0f }};
+
+            REQUIRE(true == al.sources.SetSourcePitch(handle, 1.5f));
+            REQUIRE(true == al.sources.SetSourceGain(handle, 0.25f));
+            REQUIRE(true == al.sources.SetSourcePosition(handle, position));
+            REQUIRE(true == al.sources.SetSourceVelocity(handle, velocity));
+            REQUIRE(true == al.sources.SetSourceReferenceDistance(handle, 2.0f));
+            REQUIRE(true == al.sources.SetSourceMaxDistance(handle, 50.0f));
+            REQUIRE(true == al.sources.SetSourceRolloffFactor(handle, 0.5f));
+            REQUIRE(true == al.sources.SetSourceRelative(handle, true));
+            REQUIRE(true == al.sources.SetSourceLooping(handle, true));
+
+            THEN("getters return them and OpenAL holds the same values")
+            {
+                std::array<float, 3> alPosition{{ 0.0f, 0.0f, 0.0f }};
+                alGetSourcefv(alSource, AL_POSITION, alPosition.data());
+
+                REQUIRE(1.5f == al.sources.GetSourcePitch(handle));
+                REQUIRE(0.25f == al.sources.GetSourceGain(handle));
+                REQUIRE(position == al.sources.GetSourcePosition(handle));
+                REQUIRE(velocity == al.sources.GetSourceVelocity(handle));
+                REQUIRE(2.0f == al.sources.GetSourceReferenceDistance(handle));
+                REQUIRE(50.0f == al.sources.GetSourceMaxDistance(handle));
+                REQUIRE(0.5f == al.sources.GetSourceRolloffFactor(handle));
+                REQUIRE(true == al.sources.IsSourceRelative(handle));
+                REQUIRE(true == al.sources.IsSourceLooping(handle));
+
+                REQUIRE(1.5f == getFloat(AL_PITCH));
+                REQUIRE(0.25f == getFloat(AL_GAIN));
+                REQUIRE(position == alPosition);
+                REQUIRE(AL_TRUE == getInt(AL_SOURCE_RELATIVE));
+                REQUIRE(AL_TRUE == getInt(AL_LOOPING));
+            }
+            THEN("reused handle keeps them like the OpenAL source does")
+            {
+                object.Reset();
+                object = al.sources.Spawn();
+
+                REQUIRE(handle == *(object.GetSharedHandle()));
+
+                REQUIRE(getFloat(AL_GAIN) == al.sources.GetSourceGain(handle));
+                REQUIRE(getFloat(AL_PITCH) == al.sources.GetSourcePitch(handle));
+                REQUIRE((AL_TRUE == getInt(AL_LOOPING)) == al.sources.IsSourceLooping(handle));
+            }
+        }
+    }
+    GIVEN("listener")
+    {
+        tulpar::internal::ListenerController listener;
+
+        tulpar::audio::Listener::Orientation const orientation{
+            {{ 1.0f, 0.0f, 0.0f }}
+            , {{ 0.0f, 0.0f, 1.0f }}
+        };
+
+        WHEN("properties are set")
+        {
+            REQUIRE(true == listener.SetListenerGain(0.5f));
+            REQUIRE(true == listener.SetListenerOrientation(orientation));
+
+            THEN("getters return them and OpenAL holds the same values")
+            {
+                ALfloat alGain = -1.0f;
+                alGetListenerf(AL_GAIN, &alGain);
+
+                std::array<float, 6> alOrientation{{ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }};
+                alGetListenerfv(AL_ORIENTATION, alOrientation.data());
+
+                REQUIRE(0.5f == listener.GetListenerGain());
+                REQUIRE(orientation.at == listener.GetListenerOrientation().at);
+                REQUIRE(orientation.up == listener.GetListenerOrientation().up);
+
+                REQUIRE(0.5f == alGain);
+                REQUIRE(1.0f == alOrientation[0]);
+                REQUIRE(1.0f == alOrientation[5]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Source batch transforms", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("collection with three sources")
+    {
+        T objects[3] = { al.sources.Spawn(), al.sources.Spawn(), al.sources.Spawn() };
+        SourceCollection::SourceHandle const handles[3] = {
+            *(objects[0].GetSharedHandle()), *(objects[1].GetSharedHandle()), *(objects[2].GetSharedHandle())
+        };
+
+        float const xs[3] = { 1.0f, 2.0f, 3.0f };
+        float const ys[3] = { 4.0f, 5.0f, 6.0f };
+        float zs[3] = { 7.0f, 8.0f, 9.0f };
+
+        WHEN("positions and velocities are set in batch")
+        {
+            bool const isPositionSet = al.sources.SetSourcesPosition(handles, 3, xs, ys, zs);
+            bool const isVelocitySet = al.sources.SetSourcesVelocity(handles, 3, zs, ys, xs);
+
+            THEN("each source gets its components")
+            {
+                REQUIRE(true == isPositionSet);
+                REQUIRE(true == isVelocitySet);
+
+                for (uint32_t i = 0; i < 3; ++i)
+                {
+                    REQUIRE((std::array<float, 3>{{ xs[i], ys[i], zs[i] }}) == objects[i].GetPosition());
+                    REQUIRE((std::array<float, 3>{{ zs[i], ys[i], xs[i] }}) == objects[i].GetVelocity());
+                }
+            }
+        }
+        WHEN("batch has non-finite component")
+        {
+            zs[2] = std::numeric_limits<float>::infinity();
+
+            bool const isPositionSet = al.sources.SetSourcesPosition(handles, 3, xs, ys, zs);
+
+            THEN("no source is changed")
+            {
+                REQUIRE(false == isPositionSet);
+
+                for (uint32_t i = 0; i < 3; ++i)
+                {
+                    REQUIRE((std::array<float, 3>{{ 0.0f, 0.0f, 0.0f }}) == objects[i].GetPosition());
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Source spatial queries", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("collection with three positioned sources")
+    {
+        al.sources.SetGridCellSize(8.0f);
+
+        T objects[3] = { al.sources.Spawn(), al.sources.Spawn(), al.sources.Spawn() };
+        SourceCollection::SourceHandle const handles[3] = {
+            *(objects[0].GetSharedHandle()), *(objects[1].GetSharedHandle()), *(objects[2].GetSharedHandle())
+        };
+
+        float const xs[3] = { 1.0f, 50.0f, -100.0f };
+        float const ys[3] = { 0.0f, 0.0f, 0.0f };
+        float const zs[3] = { 0.0f, 0.0f, 0.0f };
+
+        REQUIRE(true == al.sources.SetSourcesPosition(handles, 3, xs, ys, zs));
+
+        auto query = [&](float radius)
+        {
+            SourceCollection::Handles result;
+            al.sources.GetSourcesInRadius({{ 0.0f, 0.0f, 0.0f }}, radius, result);
+            std::sort(result.begin(), result.end());
+
+            return result;
+        };
+
+        WHEN("sources are queried")
+        {
+            THEN("only sources within radius are found")
+            {
+                REQUIRE((SourceCollection::Handles{ handles[0] }) == query(10.0f));
+                REQUIRE((SourceCollection::Handles{ handles[0], handles[1] }) == query(60.0f));
+                REQUIRE(3 == query(1000.0f).size());
+            }
+        }
+        WHEN("source is moved")
+        {
+            REQUIRE(true == al.sources.SetSourcePosition(handles[2], {{ 0.0f, 0.0f, -5.0f }}));
+
+            THEN("it is found at its new position")
+            {
+                REQUIRE((SourceCollection::Handles{ handles[0], handles[2] }) == query(10.0f));
+            }
+        }
+        WHEN("source becomes relative or is reset")
+        {
+            REQUIRE(true == al.sources.SetSourceRelative(handles[1], true));
+
+            objects[0].Reset();
+
+            THEN("it is no longer found")
+            {
+                REQUIRE((SourceCollection::Handles{ handles[2] }) == query(1000.0f));
+            }
+        }
+    }
+}
+
+TEST_CASE("Source audibility", "[source]")
+{
+    using T = tulpar::audio::Source;
+    using tulpar::audio::Listener;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("collection with attenuated sources")
+    {
+        T closeSource = al.sources.Spawn();
+        T distantSource = al.sources.Spawn();
+        T relativeSource = al.sources.Spawn();
+
+        REQUIRE(true == closeSource.SetPosition({{ 2.0f, 0.0f, 0.0f }}));
+        REQUIRE(true == distantSource.SetPosition({{ 10.0f, 0.0f, 0.0f }}));
+        REQUIRE(true == distantSource.SetGain(0.5f));
+        REQUIRE(true == distantSource.SetReferenceDistance(2.0f));
+        REQUIRE(true == distantSource.SetMaxDistance(12.0f));
+        REQUIRE(true == distantSource.SetRolloffFactor(0.5f));
+        REQUIRE(true == relativeSource.SetRelative(true));
+        REQUIRE(true == relativeSource.SetPosition({{ 0.0f, 4.0f, 0.0f }}));
+
+        std::array<float, 3> const listenerPosition{{ 0.0f, 0.0f, 0.0f }};
+        std::vector<float> audibility;
+
+        auto estimate = [&](T const& source)
+        {
+            return audibility[*(source.GetSharedHandle())];
+        };
+
+        THEN("attenuation properties are cached")
+        {
+            REQUIRE(2.0f == distantSource.GetReferenceDistance());
+            REQUIRE(12.0f == distantSource.GetMaxDistance());
+            REQUIRE(0.5f == distantSource.GetRolloffFactor());
+            REQUIRE(1.0f == closeSource.GetReferenceDistance());
+            REQUIRE(std::numeric_limits<float>::max() == closeSource.GetMaxDistance());
+        }
+        WHEN("inverse clamped model is evaluated")
+        {
+            al.sources.ComputeAudibility(listenerPosition, Listener::DistanceModel::InverseClamped, audibility);
+
+            THEN("gain follows OpenAL formula")
+            {
+                REQUIRE(Approx(0.5f) == estimate(closeSource));
+                REQUIRE(Approx(0.5f * 2.0f / (2.0f + 0.5f * 8.0f)) == estimate(distantSource));
+                REQUIRE(Approx(0.25f) == estimate(relativeSource));
+            }
+            THEN("relative sources follow the listener")
+            {
+                al.sources.ComputeAudibility({{ 100.0f, 0.0f, 0.0f }}, Listener::DistanceModel::InverseClamped, audibility);
+
+                REQUIRE(Approx(0.25f) == estimate(relativeSource));
+                REQUIRE(Approx(1.0f / 98.0f) == estimate(closeSource));
+            }
+        }
+        WHEN("linear clamped model is evaluated")
+        {
+            al.sources.ComputeAudibility(listenerPosition, Listener::DistanceModel::LinearClamped, audibility);
+
+            THEN("gain follows OpenAL formula")
+            {
+                REQUIRE(Approx(0.5f * (1.0f - 0.5f * 8.0f / 10.0f)) == estimate(distantSource));
+            }
+        }
+        WHEN("distance model is disabled")
+        {
+            al.sources.ComputeAudibility(listenerPosition, Listener::DistanceModel::None, audibility);
+
+            THEN("gain is not attenuated")
+            {
+                REQUIRE(1.0f == estimate(closeSource));
+                REQUIRE(0.5f == estimate(distantSource));
+            }
+        }
+        WHEN("audibility of given sources is evaluated")
+        {
+            al.sources.ComputeAudibility(listenerPosition, Listener::DistanceModel::InverseClamped, audibility);
+
+            std::array<tulpar::audio::SourceRef, 2> const references{{
+                al.sources.GetReference(*(relativeSource.GetSharedHandle()))
+                , al.sources.GetReference(*(distantSource.GetSharedHandle()))
+            }};
+            std::array<float, 2> result{{ 0.0f, 0.0f }};
+
+            al.sources.ComputeAudibility(listenerPosition
+                , Listener::DistanceModel::InverseClamped
+                , references.data()
+                , static_cast<uint32_t>(references.size())
+                , result.data()
+            );
+
+            THEN("estimates match the full pass")
+            {
+                REQUIRE(estimate(relativeSource) == result[0]);
+                REQUIRE(estimate(distantSource) == result[1]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Loopback rendering", "[loopback][source]")
+{
+    using tulpar::audio::Source;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("source playing 100 ms of constant mono data")
+    {
+        std::string const path("LoopbackRenderingTest.wav");
+
+        std::vector<uint8_t> data = tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 2205);
+        std::vector<int16_t> const samples(2205, int16_t(8192));
+        std::memcpy(data.data() + data.size() - 2 * 2205, samples.data(), 2 * 2205);
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(path, data));
+
+        tulpar::audio::Buffer buffer = al.buffers.Spawn();
+        Source source = al.sources.Spawn();
+        Source::Handle const handle = *(source.GetSharedHandle());
+
+        REQUIRE(true == al.buffers.SetBufferFile(*(buffer.GetSharedHandle()), path));
+        REQUIRE(true == al.sources.SetSourceStaticBuffer(handle, *(buffer.GetSharedHandle())));
+        REQUIRE(true == al.sources.SetSourceRelative(handle, true));
+        REQUIRE(true == al.sources.PlaySource(handle));
+
+        std::remove(path.c_str());
+
+        std::vector<int16_t> rendered(4410, 0);
+
+        WHEN("part of the data is rendered")
+        {
+            REQUIRE(true == al.context.GetDevice().RenderSamples(rendered.data(), 441));
+
+            THEN("samples are mixed and playback advances")
+            {
+                REQUIRE(rendered.end() != std::find_if(rendered.begin(), rendered.begin() + 441, [](int16_t sample) { return 0 != sample; }));
+                REQUIRE(Source::State::Playing == al.sources.GetSourceState(handle));
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) > std::chrono::nanoseconds(0));
+            }
+        }
+        WHEN("all of the data is rendered")
+        {
+            REQUIRE(true == al.context.GetDevice().RenderSamples(rendered.data(), 4410));
+            REQUIRE(true == al.context.GetDevice().RenderSamples(rendered.data(), 441));
+
+            THEN("source stops")
+            {
+                REQUIRE(Source::State::Stopped == al.sources.GetSourceState(handle));
+                REQUIRE(0 == rendered[440]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Batched source states", "[loopback][source]")
+{
+    using tulpar::audio::Source;
+    using tulpar::internal::SourceCollection;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("two sources with 100 ms of constant mono data")
+    {
+        std::string const path("BatchedSourceStatesTest.wav");
+
+        std::vector<uint8_t> data = tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 2205);
+        std::vector<int16_t> const samples(2205, int16_t(8192));
+        std::memcpy(data.data() + data.size() - 2 * 2205, samples.data(), 2 * 2205);
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(path, data));
+
+        tulpar::audio::Buffer buffer = al.buffers.Spawn();
+
+        REQUIRE(true == al.buffers.SetBufferFile(*(buffer.GetSharedHandle()), path));
+
+        std::remove(path.c_str());
+
+        Source sources[2] = { al.sources.Spawn(), al.sources.Spawn() };
+        SourceCollection::Handles const handles = { *(sources[0].GetSharedHandle()), *(sources[1].GetSharedHandle()) };
+
+        for (Source::Handle handle : handles)
+        {
+            REQUIRE(true == al.sources.SetSourceStaticBuffer(handle, *(buffer.GetSharedHandle())));
+            REQUIRE(true == al.sources.SetSourceRelative(handle, true));
+        }
+
+        std::vector<int16_t> rendered(441, 0);
+
+        auto isSilent = [&rendered]()
+        {
+            return rendered.end() == std::find_if(rendered.begin(), rendered.end(), [](int16_t sample) { return 0 != sample; });
+        };
+
+        WHEN("sources are played together")
+        {
+            REQUIRE(true == al.sources.PlaySources(handles));
+            REQUIRE(true == al.context.GetDevice().RenderSamples(rendered.data(), 441));
+
+            THEN("both of them are mixed from the same position")
+            {
+                REQUIRE(Source::State::Playing == al.sources.GetSourceState(handles[0]));
+                REQUIRE(Source::State::Playing == al.sources.GetSourceState(handles[1]));
+                REQUIRE(false == isSilent());
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handles[0]) > std::chrono::nanoseconds(0));
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handles[0]) == al.sources.GetSourcePlaybackPosition(handles[1]));
+            }
+            THEN("pausing them keeps their position and silences the mix")
+            {
+                std::chrono::nanoseconds const position = al.sources.GetSourcePlaybackPosition(handles[0]);
+
+                REQUIRE(true == al.sources.PauseSources(handles));
+                REQUIRE(true == al.context.GetDevice().RenderSamples(rendered.data(), 441));
+
+                REQUIRE(Source::State::Paused == al.sources.GetSourceState(handles[0]));
+                REQUIRE(Source::State::Paused == al.sources.GetSourceState(handles[1]));
+                REQUIRE(position == al.sources.GetSourcePlaybackPosition(handles[1]));
+                REQUIRE(true == isSilent());
+            }
+            THEN("rewinding them returns them to initial state")
+            {
+                REQUIRE(true == al.sources.RewindSources(handles));
+
+                REQUIRE(Source::State::Initial == al.sources.GetSourceState(handles[0]));
+                REQUIRE(Source::State::Initial == al.sources.GetSourceState(handles[1]));
+            }
+            THEN("stopping them silences the mix")
+            {
+                REQUIRE(true == al.sources.StopSources(handles));
+                REQUIRE(true == al.context.GetDevice().RenderSamples(rendered.data(), 441));
+
+                REQUIRE(Source::State::Stopped == al.sources.GetSourceState(handles[0]));
+                REQUIRE(Source::State::Stopped == al.sources.GetSourceState(handles[1]));
+                REQUIRE(true == isSilent());
+            }
+        }
+        WHEN("empty batch is played")
+        {
+            THEN("nothing changes")
+            {
+                REQUIRE(true == al.sources.PlaySources({}));
+                REQUIRE(Source::State::Initial == al.sources.GetSourceState(handles[0]));
+            }
+        }
+    }
+}
+
+TEST_CASE("Deferred update frames", "[loopback][frame]")
+{
+    using tulpar::audio::Source;
+
+    Setup();
+
+    GIVEN("library instance playing 100 ms of constant mono data")
+    {
+        std::string const path("DeferredUpdateFramesTest.wav");
+
+        std::vector<uint8_t> data = tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 2205);
+        std::vector<int16_t> const samples(2205, int16_t(8192));
+        std::memcpy(data.data() + data.size() - 2 * 2205, samples.data(), 2 * 2205);
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(path, data));
+
+        tulpar::TulparConfigurator config;
+        config.device = tulpar::TulparConfigurator::Device::Loopback(44100, 1);
+
+        tulpar::TulparAudio audio;
+
+        REQUIRE(true == audio.Initialize(config));
+
+        tulpar::audio::Buffer buffer = audio.SpawnBuffer();
+        Source source = audio.SpawnSource();
+
+        REQUIRE(true == buffer.BindFile(path));
+        REQUIRE(true == source.SetStaticBuffer(buffer));
+        REQUIRE(true == source.SetRelative(true));
+        REQUIRE(true == source.Play());
+
+        std::remove(path.c_str());
+
+        std::vector<int16_t> rendered(441, 0);
+
+        auto isSilent = [&]()
+        {
+            REQUIRE(true == audio.RenderSamples(rendered.data(), 441));
+
+            return rendered.end() == std::find_if(rendered.begin(), rendered.end(), [](int16_t sample) { return 0 != sample; });
+        };
+
+        WHEN("source is muted outside of a frame")
+        {
+            REQUIRE(true == source.SetGain(0.0f));
+
+            THEN("change is applied immediately")
+            {
+                REQUIRE(true == isSilent());
+            }
+        }
+        WHEN("source and listener are muted within a frame")
+        {
+            {
+                tulpar::TulparAudio::UpdateBatch batch(audio);
+
+                REQUIRE(true == source.SetGain(0.0f));
+                REQUIRE(true == audio.GetListener().SetGain(0.0f));
+
+                REQUIRE(0.0f == source.GetGain());
+                REQUIRE(0.0f == audio.GetListener().GetGain());
+                REQUIRE(false == isSilent());
+            }
+
+            THEN("changes are applied when the frame ends")
+            {
+                REQUIRE(true == isSilent());
+            }
+        }
+        WHEN("source is muted within nested frames")
+        {
+            audio.BeginFrame();
+            audio.BeginFrame();
+
+            REQUIRE(true == source.SetGain(0.0f));
+
+            audio.EndFrame();
+
+            THEN("change is applied when the outermost frame ends")
+            {
+                REQUIRE(false == isSilent());
+
+                audio.EndFrame();
+
+                REQUIRE(true == isSilent());
+            }
+        }
+    }
+}
+
+TEST_CASE("Source reference calls", "[loopback][source]")
+{
+    using tulpar::audio::Source;
+
+    Setup();
+
+    GIVEN("library instance with a source holding 100 ms of mono data")
+    {
+        std::string const path("SourceReferenceCallsTest.wav");
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(path, tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 2205)));
+
+        tulpar::TulparConfigurator config;
+        config.device = tulpar::TulparConfigurator::Device::Loopback(44100, 1);
+
+        tulpar::TulparAudio audio;
+
+        REQUIRE(true == audio.Initialize(config));
+
+        tulpar::audio::Buffer buffer = audio.SpawnBuffer();
+        Source source = audio.SpawnSource();
+
+        REQUIRE(true == buffer.BindFile(path));
+        REQUIRE(true == source.SetStaticBuffer(buffer));
+
+        std::remove(path.c_str());
+
+        tulpar::audio::SourceRef const reference = audio.GetSourceRef(source);
+
+        WHEN("source is changed through its reference")
+        {
+            REQUIRE(true == audio.SetSourceGain(reference, 0.5f));
+            REQUIRE(true == audio.SetSourcePosition(reference, {{ 1.0f, 2.0f, 3.0f }}));
+            REQUIRE(true == audio.PlaySource(reference));
+
+            THEN("changes are visible through the reference and the controller")
+            {
+                REQUIRE(0.5f == audio.GetSourceGain(reference));
+                REQUIRE(0.5f == source.GetGain());
+                REQUIRE((std::array<float, 3>{{ 1.0f, 2.0f, 3.0f }}) == audio.GetSourcePosition(reference));
+                REQUIRE(Source::State::Playing == audio.GetSourceState(reference));
+            }
+            AND_WHEN("source is stopped through its reference")
+            {
+                REQUIRE(true == audio.StopSource(reference));
+
+                THEN("source is stopped")
+                {
+                    REQUIRE(Source::State::Stopped == source.GetState());
+                }
+            }
+        }
+        WHEN("source is reset")
+        {
+            source.Reset();
+
+            THEN("calls through its reference are rejected")
+            {
+                REQUIRE(false == audio.PlaySource(reference));
+                REQUIRE(false == audio.StopSource(reference));
+                REQUIRE(false == audio.SetSourceGain(reference, 0.5f));
+                REQUIRE(false == audio.SetSourcePosition(reference, {{ 1.0f, 2.0f, 3.0f }}));
+            }
+        }
+    }
+}
+
+TEST_CASE("Source playback position", "[loopback][source]")
+{
+    using tulpar::audio::Buffer;
+    using tulpar::audio::Source;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("paused source with queued 100 ms and 200 ms buffers")
+    {
+        std::string const paths[2] = { "SourcePlaybackPositionTest0.wav", "SourcePlaybackPositionTest1.wav" };
+
+        REQUIRE(true == tulpar::tests::internal::WriteFile(paths[0], tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 2205)));
+        REQUIRE(true == tulpar::tests::internal::WriteFile(paths[1], tulpar::tests::internal::MakeWave(1, 1, 16, 2 * 4410)));
+
+        Buffer buffers[2] = { al.buffers.Spawn(), al.buffers.Spawn() };
+
+        REQUIRE(true == al.buffers.SetBufferFile(*(buffers[0].GetSharedHandle()), paths[0]));
+        REQUIRE(true == al.buffers.SetBufferFile(*(buffers[1].GetSharedHandle()), paths[1]));
+
+        Source source = al.sources.Spawn();
+        Source::Handle const handle = *(source.GetSharedHandle());
+
+        REQUIRE(true == al.sources.QueueSourceBuffers(handle, { buffers[0], buffers[1] }));
+        REQUIRE(true == al.sources.PlaySource(handle));
+        REQUIRE(true == al.sources.PauseSource(handle));
+
+        for (std::string const& path : paths)
+        {
+            std::remove(path.c_str());
+        }
+
+        auto getSampleOffset = [handle]()
+        {
+            ALint sampleOffset = -1;
+            alGetSourcei(static_cast<ALuint>(handle), AL_SAMPLE_OFFSET, &sampleOffset);
+
+            return sampleOffset;
+        };
+
+        THEN("duration spans the whole queue")
+        {
+            REQUIRE(std::chrono::milliseconds(300) == al.sources.GetSourcePlaybackDuration(handle));
+        }
+        WHEN("position within the first buffer is set")
+        {
+            REQUIRE(true == al.sources.SetSourcePlaybackPosition(handle, std::chrono::milliseconds(50)));
+
+            THEN("it maps to a frame of the first buffer")
+            {
+                REQUIRE(1102 == getSampleOffset());
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) > std::chrono::milliseconds(49));
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) <= std::chrono::milliseconds(50));
+            }
+        }
+        WHEN("position at the start of the second buffer is set")
+        {
+            REQUIRE(true == al.sources.SetSourcePlaybackPosition(handle, std::chrono::milliseconds(100)));
+
+            THEN("it maps to the first frame of the second buffer")
+            {
+                REQUIRE(2205 == getSampleOffset());
+                REQUIRE(std::chrono::milliseconds(100) == al.sources.GetSourcePlaybackPosition(handle));
+            }
+        }
+        WHEN("position within the second buffer is set")
+        {
+            REQUIRE(true == al.sources.SetSourcePlaybackPosition(handle, std::chrono::milliseconds(250)));
+
+            THEN("frames of the first buffer are skipped")
+            {
+                REQUIRE(2205 + 3307 == getSampleOffset());
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) > std::chrono::milliseconds(249));
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) <= std::chrono::milliseconds(250));
+            }
+        }
+        WHEN("another buffer is queued")
+        {
+            REQUIRE(true == al.sources.QueueSourceBuffers(handle, { buffers[0] }));
+            REQUIRE(true == al.sources.SetSourcePlaybackPosition(handle, std::chrono::milliseconds(350)));
+
+            THEN("position is mapped across all queued buffers")
+            {
+                REQUIRE(3 == al.sources.GetSourceQueuedBuffers(handle).size());
+                REQUIRE(std::chrono::milliseconds(400) == al.sources.GetSourcePlaybackDuration(handle));
+                REQUIRE(2205 + 4410 + 1102 == getSampleOffset());
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) > std::chrono::milliseconds(349));
+                REQUIRE(al.sources.GetSourcePlaybackPosition(handle) <= std::chrono::milliseconds(350));
+            }
+        }
+    }
+}
+
+TEST_CASE("Source buffer budget", "[budget][source]")
+{
+    using tulpar::audio::Buffer;
+    using tulpar::audio::Source;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("buffer evicted by budget of one buffer")
+    {
+        std::string const paths[2] = { "SourceBufferBudgetTest0.wav", "SourceBufferBudgetTest1.wav" };
+
+        for (std::string const& path : paths)
+        {
+            REQUIRE(true == tulpar::tests::internal::WriteFile(path, tulpar::tests::internal::MakeWave(1, 1, 16, 64)));
+        }
+
+        al.buffers.SetBudget(64);
+
+        Buffer buffers[2] = { al.buffers.Spawn(), al.buffers.Spawn() };
+        Buffer::Handle const bufferHandles[2] = { *(buffers[0].GetSharedHandle()), *(buffers[1].GetSharedHandle()) };
+
+        REQUIRE(true == al.buffers.SetBufferFile(bufferHandles[0], paths[0]));
+        REQUIRE(true == al.buffers.SetBufferFile(bufferHandles[1], paths[1]));
+        REQUIRE(0 == al.buffers.GetBufferResidentSize(bufferHandles[0]));
+
+        Source source = al.sources.Spawn();
+        Source::Handle const handle = *(source.GetSharedHandle());
+
+        WHEN("its data is still available")
+        {
+            THEN("it is reloaded when attached")
+            {
+                REQUIRE(true == al.sources.SetSourceStaticBuffer(handle, bufferHandles[0]));
+                REQUIRE(64 == al.buffers.GetBufferResidentSize(bufferHandles[0]));
+            }
+        }
+        WHEN("its data is gone")
+        {
+            std::remove(paths[0].c_str());
+
+            THEN("it can't be attached or queued")
+            {
+                REQUIRE(false == al.sources.SetSourceStaticBuffer(handle, bufferHandles[0]));
+                REQUIRE(false == al.sources.QueueSourceBuffers(handle, { buffers[1], buffers[0] }));
+                REQUIRE(true == al.sources.GetSourceQueuedBuffers(handle).empty());
+                REQUIRE(0 == al.buffers.GetBufferResidentSize(bufferHandles[0]));
+            }
+        }
+
+        for (std::string const& path : paths)
+        {
+            std::remove(path.c_str());
+        }
+    }
+}
+
+TEST_CASE("Deferred source commands", "[queue][source]")
+{
+    using tulpar::audio::Source;
+    using tulpar::internal::Command;
+    using tulpar::internal::CommandQueue;
+
+    Setup();
+
+    LoopbackCollections al;
+
+    REQUIRE(true == al.context.IsValid());
+
+    GIVEN("collection consumed by another thread")
+    {
+        CommandQueue queue(16);
+
+        Source source = al.sources.Spawn();
+        Source::Handle const handle = *(source.GetSharedHandle());
+
+        al.sources.SetCommandQueue(&queue);
+
+        WHEN("property is set")
+        {
+            REQUIRE(true == source.SetGain(0.5f));
+
+            Command command;
+
+            REQUIRE(true == queue.Pop(command));
+
+            THEN("command is stamped with handle generation")
+            {
+                REQUIRE(Command::Type::SourceGain == command.type);
+                REQUIRE(handle == command.handle);
+                REQUIRE(true == al.sources.IsValid(handle, command.generation));
+            }
+            THEN("command does not match reused handle")
+            {
+                al.sources.SetCommandQueue(nullptr);
+
+                source.Reset();
+                source = al.sources.Spawn();
+
+                REQUIRE(handle == *(source.GetSharedHandle()));
+                REQUIRE(false == al.sources.IsValid(handle, command.generation));
+            }
+        }
+        WHEN("callback is bound")
+        {
+            auto callback = [](void* pSamples, uint32_t frameCount) -> uint32_t
+            {
+                std::fill_n(static_cast<int16_t*>(pSamples), frameCount, int16_t(0));
+
+                return frameCount;
+            };
+
+            REQUIRE(true == source.BindCallback(callback, 1, 44100));
+
+            Command command;
+            Command extra;
+
+            REQUIRE(true == queue.Pop(command));
+            REQUIRE(false == queue.Pop(extra));
+
+            THEN("binding is deferred to a single command")
+            {
+                REQUIRE(Command::Type::SourceCallback == command.type);
+                REQUIRE(handle == command.handle);
+                REQUIRE(false == al.sources.IsSourceProcedural(handle));
+            }
+            THEN("applied binding survives on the consumer thread")
+            {
+                al.sources.SetCommandQueue(nullptr);
+
+                REQUIRE(true == al.sources.ApplySourceBind(handle, command.payload.handle));
+                REQUIRE(true == al.sources.IsSourceProcedural(handle));
+                REQUIRE(false == al.sources.ApplySourceBind(handle, command.payload.handle));
+            }
+            THEN("discarded binding is not applied")
+            {
+                al.sources.SetCommandQueue(nullptr);
+                al.sources.DiscardSourceBind(command.payload.handle);
+
+                REQUIRE(false == al.sources.ApplySourceBind(handle, command.payload.handle));
+                REQUIRE(false == al.sources.IsSourceProcedural(handle));
+            }
+        }
+        WHEN("stream is bound")
+        {
+            REQUIRE(true == source.BindStream(mule::asset::Storage::Instance().Get(s_streamFile)));
+
+            Command command;
+            Command extra;
+
+            REQUIRE(true == queue.Pop(command));
+            REQUIRE(false == queue.Pop(extra));
+
+            THEN("binding is applied on the consumer thread")
+            {
+                REQUIRE(Command::Type::SourceStream == command.type);
+                REQUIRE(false == al.sources.IsSourceStreamed(handle));
+
+                al.sources.SetCommandQueue(nullptr);
+
+                REQUIRE(true == al.sources.ApplySourceBind(handle, command.payload.handle));
+                REQUIRE(true == al.sources.IsSourceStreamed(handle));
+            }
+        }
+        WHEN("state of a source batch is changed")
+        {
+            std::string const path("DeferredBatchTest.wav");
+
+            REQUIRE(true == tulpar::tests::internal::WriteFile(path, tulpar::tests::internal::MakeWave(1, 1, 16, 4410)));
+
+            tulpar::audio::Buffer buffer = al.buffers.Spawn();
+
+            REQUIRE(true == al.buffers.SetBufferFile(*(buffer.GetSharedHandle()), path));
+
+            std::remove(path.c_str());
+
+            Source other = al.sources.Spawn();
+            Source::Handle const otherHandle = *(other.GetSharedHandle());
+
+            al.sources.SetCommandQueue(nullptr);
+
+            REQUIRE(true == al.sources.SetSourceStaticBuffer(handle, *(buffer.GetSharedHandle())));
+            REQUIRE(true == al.sources.SetSourceStaticBuffer(otherHandle, *(buffer.GetSharedHandle())));
+
+            al.sources.SetCommandQueue(&queue);
+
+            REQUIRE(true == al.sources.PlaySources({ handle, otherHandle }));
+
+            Command command;
+            Command extra;
+
+            REQUIRE(true == queue.Pop(command));
+            REQUIRE(false == queue.Pop(extra));
+
+            THEN("batch is deferred to a single command")
+            {
+                REQUIRE(Command::Type::SourcesPlay == command.type);
+                REQUIRE(tulpar::audio::Source::State::Initial == al.sources.GetSourceState(handle));
+
+                al.sources.SetCommandQueue(nullptr);
+
+                REQUIRE(true == al.sources.ApplySourceBatch(command.type, command.payload.handle));
+                REQUIRE(tulpar::audio::Source::State::Playing == al.sources.GetSourceState(handle));
+                REQUIRE(tulpar::audio::Source::State::Playing == al.sources.GetSourceState(otherHandle));
+                REQUIRE(false == al.sources.ApplySourceBatch(command.type, command.payload.handle));
+            }
+            THEN("sources reset before the batch is applied are skipped")
+            {
+                al.sources.SetCommandQueue(nullptr);
+
+                other.Reset();
+
+                REQUIRE(true == al.sources.ApplySourceBatch(command.type, command.payload.handle));
+                REQUIRE(tulpar::audio::Source::State::Playing == al.sources.GetSourceState(handle));
+            }
+            THEN("batch with invalid source is rejected before it is deferred")
+            {
+                REQUIRE(false == al.sources.StopSources({ handle, otherHandle + 1000 }));
+                REQUIRE(false == queue.Pop(extra));
+            }
+        }
+        WHEN("buffers are queued")
+        {
+            std::string const path("DeferredQueueTest.wav");
+
+            REQUIRE(true == tulpar::tests::internal::WriteFile(path, tulpar::tests::internal::MakeWave(1, 1, 16, 64)));
+
+            tulpar::audio::Buffer buffer = al.buffers.Spawn();
+
+            REQUIRE(true == al.buffers.SetBufferFile(*(buffer.GetSharedHandle()), path));
+
+            std::remove(path.c_str());
+
+            REQUIRE(true == source.QueueBuffers({ buffer, buffer }));
+
+            Command command;
+            Command extra;
+
+            REQUIRE(true == queue.Pop(command));
+            REQUIRE(false == queue.Pop(extra));
+
+            THEN("buffers are queued on the consumer thread")
+            {
+                REQUIRE(Command::Type::SourceQueueBuffers == command.type);
+                REQUIRE(handle == command.handle);
+
+                al.sources.SetCommandQueue(nullptr);
+
+                REQUIRE(true == al.sources.GetSourceQueuedBuffers(handle).empty());
+                REQUIRE(true == al.sources.ApplySourceBind(handle, command.payload.handle));
+                REQUIRE(2 == al.sources.GetSourceQueuedBuffers(handle).size());
+            }
+        }
+    }
+}